@@ -19,6 +19,7 @@ main (int argc, char *argv[])
     double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
     char * sendbuf = NULL, * recvbuf = NULL;
     int po_ret;
+    MPI_Comm comm;
     size_t bufsize;
 
     set_header(HEADER);
@@ -69,54 +70,73 @@ main (int argc, char *argv[])
 
     bufsize = options.max_message_size * numprocs;
 
-    if (allocate_buffer((void**)&sendbuf, bufsize, options.accel)) {
+    if (allocate_buffer((void**)&sendbuf, bufsize + buffer_pool_size(),
+                options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
 
-    set_buffer(sendbuf, options.accel, 1, bufsize);
+    set_buffer(sendbuf, options.accel, 1, bufsize + buffer_pool_size());
 
-    if (allocate_buffer((void**)&recvbuf, options.max_message_size * numprocs,
+    if (allocate_buffer((void**)&recvbuf, options.max_message_size * numprocs
+                + buffer_pool_size(),
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
 
-    set_buffer(recvbuf, options.accel, 0, bufsize);
+    set_buffer(recvbuf, options.accel, 0, bufsize + buffer_pool_size());
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
-        if (size > LARGE_MESSAGE_SIZE) {
-            options.skip = options.skip_large;
-            options.iterations = options.iterations_large;
-        }
+    while (next_algorithm(&comm)) {
+        for(size=first_size(options.min_message_size, options.max_message_size);
+                size <= options.max_message_size;
+                size = next_size(size, options.max_message_size)) {
+            if (size > LARGE_MESSAGE_SIZE) {
+                options.skip = options.skip_large;
+                options.iterations = options.iterations_large;
+            }
 
-        MPI_Barrier(MPI_COMM_WORLD);
-        timer=0.0;
+            MPI_Barrier(MPI_COMM_WORLD);
+            timer=0.0;
+            schedule_iterations();
+            pvars_begin();
+
+            for (i=0; i < options.iterations + options.skip ; i++) {
+                if(i == options.skip) counters_reset();
+                if(i >= options.skip) counters_start();
+                t_start = MPI_Wtime();
+                MPI_Alltoall(cycle_buffer(sendbuf, i, size * numprocs), size,
+                        MPI_CHAR, cycle_buffer(recvbuf, i, size * numprocs), size,
+                        MPI_CHAR, comm);
+                t_stop = MPI_Wtime();
+                counters_stop();
+
+                if (i >= options.skip) {
+                    timer+=t_stop-t_start;
+                }
+                finish_iteration(i >= options.skip, t_start, t_stop);
+            }
+            latency = (double)(timer * 1e6) / options.iterations;
 
-        for (i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-            MPI_Alltoall(sendbuf, size, MPI_CHAR, recvbuf, size, MPI_CHAR,
+            MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
                     MPI_COMM_WORLD);
-            t_stop = MPI_Wtime();
+            MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD);
+            avg_time = avg_time/numprocs;
 
-            if (i >= options.skip) {
-                timer+=t_stop-t_start;
+            if (options.global_sync) {
+                get_completion_stats(&avg_time, &min_time, &max_time);
             }
+
+            counters_reduce(options.iterations, MPI_COMM_WORLD);
+
+            pvars_end(MPI_COMM_WORLD);
+            print_stats(rank, size, avg_time, min_time, max_time);
             MPI_Barrier(MPI_COMM_WORLD);
         }
-        latency = (double)(timer * 1e6) / options.iterations;
-
-        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                MPI_COMM_WORLD);
-        avg_time = avg_time/numprocs;
-
-        print_stats(rank, size, avg_time, min_time, max_time);
-        MPI_Barrier(MPI_COMM_WORLD);
     }
 
     free_buffer(sendbuf, options.accel);
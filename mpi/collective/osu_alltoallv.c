@@ -19,6 +19,7 @@ int main(int argc, char *argv[])
     char *sendbuf=NULL, *recvbuf=NULL;
     int *rdispls=NULL, *recvcounts=NULL, *sdispls=NULL, *sendcounts=NULL;
     int po_ret;
+    MPI_Comm comm;
     size_t bufsize;
 
     set_header(HEADER);
@@ -67,95 +68,114 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit / numprocs;
     }
 
-    if (allocate_buffer((void**)&recvcounts, numprocs*sizeof(int), none)) {
+    if (NULL == (recvcounts = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    if (allocate_buffer((void**)&sendcounts, numprocs*sizeof(int), none)) {
+    if (NULL == (sendcounts = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
 
-    if (allocate_buffer((void**)&rdispls, numprocs*sizeof(int), none)) {
+    if (NULL == (rdispls = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    if (allocate_buffer((void**)&sdispls, numprocs*sizeof(int), none)) {
+    if (NULL == (sdispls = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
 
     bufsize = options.max_message_size * numprocs;
-    if (allocate_buffer((void**)&sendbuf, bufsize, options.accel)) {
+    if (allocate_buffer((void**)&sendbuf, bufsize + buffer_pool_size(),
+                options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    set_buffer(sendbuf, options.accel, 1, bufsize);
+    set_buffer(sendbuf, options.accel, 1, bufsize + buffer_pool_size());
 
-    if (allocate_buffer((void**)&recvbuf, bufsize,
+    if (allocate_buffer((void**)&recvbuf, bufsize + buffer_pool_size(),
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    set_buffer(recvbuf, options.accel, 0, bufsize);
+    set_buffer(recvbuf, options.accel, 0, bufsize + buffer_pool_size());
 
     print_preamble(rank);
 
-    MPI_Barrier(MPI_COMM_WORLD);
+    while (next_algorithm(&comm)) {
+        MPI_Barrier(MPI_COMM_WORLD);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
-        if(size > LARGE_MESSAGE_SIZE) {
-            options.skip = options.skip_large;
-            options.iterations = options.iterations_large;
-        }
+        for(size=first_size(options.min_message_size, options.max_message_size);
+                size <= options.max_message_size;
+                size = next_size(size, options.max_message_size)) {
+            if(size > LARGE_MESSAGE_SIZE) {
+                options.skip = options.skip_large;
+                options.iterations = options.iterations_large;
+            }
 
-        disp =0;
-        for ( i = 0; i < numprocs; i++) {
-            recvcounts[i] = size;
-            sendcounts[i] = size;
-            rdispls[i] = disp;
-            sdispls[i] = disp;
-            disp += size;
+            disp =0;
+            for ( i = 0; i < numprocs; i++) {
+                recvcounts[i] = size;
+                sendcounts[i] = size;
+                rdispls[i] = disp;
+                sdispls[i] = disp;
+                disp += size;
 
-        }
+            }
 
-        MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Barrier(MPI_COMM_WORLD);
 
-        timer=0.0;
-        for(i = 0; i < options.iterations + options.skip; i++) {
-            t_start = MPI_Wtime();
+            timer=0.0;
+            schedule_iterations();
+            pvars_begin();
+            for(i = 0; i < options.iterations + options.skip; i++) {
+                if(i == options.skip) counters_reset();
+                if(i >= options.skip) counters_start();
+                t_start = MPI_Wtime();
+
+                  MPI_Alltoallv(cycle_buffer(sendbuf, i, size * numprocs),
+                          sendcounts, sdispls, MPI_CHAR,
+                          cycle_buffer(recvbuf, i, size * numprocs), recvcounts,
+                          rdispls, MPI_CHAR, comm);
+
+                t_stop = MPI_Wtime();
+                counters_stop();
+
+                if(i>=options.skip)
+                {
+                    timer+=t_stop-t_start;
+                }
+                finish_iteration(i >= options.skip, t_start, t_stop);
+            }
 
-              MPI_Alltoallv(sendbuf, sendcounts, sdispls, MPI_CHAR, recvbuf, recvcounts, rdispls, MPI_CHAR,
-                      MPI_COMM_WORLD);
+            latency = (double)(timer * 1e6) / options.iterations;
 
-            t_stop = MPI_Wtime();
+            MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD);
+            avg_time = avg_time/numprocs;
 
-            if(i>=options.skip)
-            {
-                timer+=t_stop-t_start;
+            if (options.global_sync) {
+                get_completion_stats(&avg_time, &min_time, &max_time);
             }
-            MPI_Barrier(MPI_COMM_WORLD);
-        }
-
-        latency = (double)(timer * 1e6) / options.iterations;
 
-        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                MPI_COMM_WORLD);
-        avg_time = avg_time/numprocs;
+            counters_reduce(options.iterations, MPI_COMM_WORLD);
 
-        print_stats(rank, size, avg_time, min_time, max_time);
+            pvars_end(MPI_COMM_WORLD);
+            print_stats(rank, size, avg_time, min_time, max_time);
+    }
 
         MPI_Barrier(MPI_COMM_WORLD);
     }
 
-    free_buffer(rdispls, none);
-    free_buffer(sdispls, none);
-    free_buffer(recvcounts, none);
-    free_buffer(sendcounts, none);
+    free(rdispls);
+    free(sdispls);
+    free(recvcounts);
+    free(sendcounts);
     free_buffer(sendbuf, options.accel);
     free_buffer(recvbuf, options.accel);
 
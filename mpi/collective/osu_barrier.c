@@ -19,6 +19,7 @@ int main(int argc, char *argv[])
     double latency = 0.0, t_start = 0.0, t_stop = 0.0;
     double timer=0.0;
     int po_ret;
+    MPI_Comm comm;
 
     set_header(HEADER);
     set_benchmark_name("osu_barrier");
@@ -67,33 +68,51 @@ int main(int argc, char *argv[])
 
     print_preamble(rank);
 
-    options.skip = options.skip_large;
-    options.iterations = options.iterations_large;
-    timer = 0.0;
+    while (next_algorithm(&comm)) {
+        options.skip = options.skip_large;
+        options.iterations = options.iterations_large;
+        timer = 0.0;
+        schedule_iterations();
+        pvars_begin();
+
+        for(i=0; i < options.iterations + options.skip ; i++) {
+            if(i == options.skip) counters_reset();
+            if(i >= options.skip) counters_start();
+            t_start = MPI_Wtime();
+            MPI_Barrier(comm);
+            t_stop = MPI_Wtime();
+            counters_stop();
+
+            if(i>=options.skip){
+                timer+=t_stop-t_start;
+            }
+
+            if (options.global_sync || adaptive_enabled()) {
+                finish_iteration(i >= options.skip, t_start, t_stop);
+            }
+        }
 
-    for(i=0; i < options.iterations + options.skip ; i++) {
-        t_start = MPI_Wtime();
         MPI_Barrier(MPI_COMM_WORLD);
-        t_stop = MPI_Wtime();
 
-        if(i>=options.skip){
-            timer+=t_stop-t_start;
-        }
-    }
+        latency = (timer * 1e6) / options.iterations;
 
-    MPI_Barrier(MPI_COMM_WORLD);
+        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                    MPI_COMM_WORLD);
+        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD);
+        avg_time = avg_time/numprocs;
 
-    latency = (timer * 1e6) / options.iterations;
+        if (options.global_sync) {
+            get_completion_stats(&avg_time, &min_time, &max_time);
+        }
 
-    MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
-                MPI_COMM_WORLD);
-    MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
-                MPI_COMM_WORLD);
-    MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                MPI_COMM_WORLD);
-    avg_time = avg_time/numprocs;
+        counters_reduce(options.iterations, MPI_COMM_WORLD);
 
-    print_stats(rank, 0, avg_time, min_time, max_time);
+        pvars_end(MPI_COMM_WORLD);
+        print_stats(rank, 0, avg_time, min_time, max_time);
+    }
     MPI_Finalize();
 
     return EXIT_SUCCESS;
@@ -19,6 +19,7 @@ int main(int argc, char *argv[])
     double timer=0.0;
     char *buffer=NULL;
     int po_ret;
+    MPI_Comm comm;
 
     set_header(HEADER);
     set_benchmark_name("osu_bcast");
@@ -66,46 +67,64 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit;
     }
 
-    if (allocate_buffer((void**)&buffer, options.max_message_size, options.accel)) {
+    if (allocate_buffer((void**)&buffer, options.max_message_size + buffer_pool_size(),
+                options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    set_buffer(buffer, options.accel, 1, options.max_message_size);
+    set_buffer(buffer, options.accel, 1, options.max_message_size + buffer_pool_size());
 
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
-        if(size > LARGE_MESSAGE_SIZE) {
-            options.skip = options.skip_large; 
-            options.iterations = options.iterations_large;
-        }
+    while (next_algorithm(&comm)) {
+        for(size=first_size(options.min_message_size, options.max_message_size);
+                size <= options.max_message_size;
+                size = next_size(size, options.max_message_size)) {
+            if(size > LARGE_MESSAGE_SIZE) {
+                options.skip = options.skip_large; 
+                options.iterations = options.iterations_large;
+            }
 
-        timer=0.0;
-        for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
-            MPI_Bcast(buffer, size, MPI_CHAR, 0, MPI_COMM_WORLD);
-            t_stop = MPI_Wtime();
+            timer=0.0;
+            schedule_iterations();
+            pvars_begin();
+            for(i=0; i < options.iterations + options.skip ; i++) {
+                if(i == options.skip) counters_reset();
+                if(i >= options.skip) counters_start();
+                t_start = MPI_Wtime();
+                MPI_Bcast(cycle_buffer(buffer, i, size), size, MPI_CHAR, 0,
+                        comm);
+                t_stop = MPI_Wtime();
+                counters_stop();
+
+                if(i>=options.skip){
+                    timer+=t_stop-t_start;
+                }
+                finish_iteration(i >= options.skip, t_start, t_stop);
 
-            if(i>=options.skip){
-                timer+=t_stop-t_start;
             }
+
             MPI_Barrier(MPI_COMM_WORLD);
 
-        }
+            latency = (timer * 1e6) / options.iterations;
 
-        MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD);
+            avg_time = avg_time/numprocs;
 
-        latency = (timer * 1e6) / options.iterations;
+            if (options.global_sync) {
+                get_completion_stats(&avg_time, &min_time, &max_time);
+            }
 
-        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                MPI_COMM_WORLD);
-        avg_time = avg_time/numprocs;
+            counters_reduce(options.iterations, MPI_COMM_WORLD);
 
-        print_stats(rank, size, avg_time, min_time, max_time);
+            pvars_end(MPI_COMM_WORLD);
+            print_stats(rank, size, avg_time, min_time, max_time);
+        }
     }
 
     free_buffer(buffer, options.accel);
@@ -27,7 +27,12 @@ static CUcontext cuContext;
 static char const * benchmark_header = NULL;
 static char const * benchmark_name = NULL;
 static int accel_enabled = 0;
+static int neighbor_enabled = 0;
+static int nbc_enabled = 0;
+static int replay_enabled = 0;
 static int kernel_count = 0;
+static size_t first_iterations = 0;
+static size_t first_skip = 0;
 struct options_t options;
 
 /* A is the A in DAXPY for the Compute Kernel */
@@ -54,6 +59,12 @@ static struct {
     int opt;
 } bad_usage;
 
+/* neighbors of this rank for the hand-written neighborhood exchange */
+static int * sources = NULL, * destinations = NULL;
+static MPI_Request * exchange_requests = NULL;
+static double exchange_latency = 0.0;
+static char const * topology_names[] = {"cartesian", "graph"};
+
 static int
 set_min_message_size (int value)
 {
@@ -166,6 +177,36 @@ set_num_probes (int value)
     return 0;
 }
 
+static int
+set_topology (char const * val_str)
+{
+    if (0 == strncasecmp(val_str, "cartesian", 10)) {
+        options.topology = cartesian;
+    }
+
+    else if (0 == strncasecmp(val_str, "graph", 10)) {
+        options.topology = dist_graph;
+    }
+
+    else {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+set_degree (int value)
+{
+    if (1 > value) {
+        return -1;
+    }
+
+    options.degree = value;
+
+    return 0;
+}
+
 static int
 set_max_memlimit (int value)
 {
@@ -198,18 +239,48 @@ enable_accel_support (void)
     accel_enabled = (CUDA_ENABLED || OPENACC_ENABLED);
 }
 
+void
+enable_neighbor_support (void)
+{
+    neighbor_enabled = 1;
+}
+
+void
+enable_nbc_support (void)
+{
+    nbc_enabled = 1;
+}
+
+void
+enable_replay_support (void)
+{
+    replay_enabled = 1;
+}
+
 enum po_ret_type
 process_options (int argc, char *argv[])
 {
     extern char * optarg;
     extern int optind, optopt;
 
-    char const * optstring = "+:hvfm:i:x:M:t:s:";
+    char const * optstring = "+:hvfgm:S:i:x:M:t:s:c:a:C:o:P:T:A:";
+    char const * degree_arg = NULL;
     int c;
 
     if (accel_enabled) {
-        optstring = (CUDA_KERNEL_ENABLED) ? "+:d:hvfm:i:x:M:t:r:s:"
-            : "+:d:hvfm:i:x:M:t:s:";
+        optstring = (CUDA_KERNEL_ENABLED) ? "+:d:hvfgm:S:i:x:M:t:r:s:c:a:C:o:P:T:A:"
+            : "+:d:hvfgm:S:i:x:M:t:s:c:a:C:o:P:T:A:";
+    }
+
+    /* neighborhood collectives run on their own communicator */
+    if (neighbor_enabled) {
+        optstring = "+:hvfgm:S:i:x:M:t:s:c:a:C:o:P:T:N:k:";
+    }
+
+    /* a replay runs whole traces, so there are no sizes or dummy compute */
+    if (replay_enabled) {
+        optstring = (accel_enabled) ? "+:d:hvfgi:x:c:a:C:o:P:T:A:"
+            : "+:hvfgi:x:c:a:C:o:P:T:A:";
     }
 
     /*
@@ -218,6 +289,7 @@ process_options (int argc, char *argv[])
     options.accel = none;
     options.show_size = 1;
     options.show_full = 0;
+    options.global_sync = 0;
     options.num_probes = 0;
     options.device_array_size = 32; 
     options.target = cpu;
@@ -228,6 +300,10 @@ process_options (int argc, char *argv[])
     options.iterations_large = 100;
     options.skip = 200;
     options.skip_large = 10;
+    options.topology = cartesian;
+    options.degree = 4;
+
+    output_set_command(argc, argv);
 
     while ((c = getopt(argc, argv, optstring)) != -1) {
         bad_usage.opt = c;
@@ -247,6 +323,14 @@ process_options (int argc, char *argv[])
                     return po_bad_usage;
                 }
                 break;
+            case 'S':
+                if (set_sizes(optarg)) {
+                    bad_usage.message = "Invalid Message Sizes";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
             case 't':
                 if (set_num_probes(atoi(optarg))){
                     bad_usage.message = "Invalid Number of Probes";
@@ -282,6 +366,91 @@ process_options (int argc, char *argv[])
             case 'f':
                 options.show_full = 1;
                 break;
+            case 'g':
+                /* the overlap loop of the NBC tests has no scheduled start */
+                if (nbc_enabled) {
+                    bad_usage.message = "Global Synchronization Is Not "
+                        "Supported By Non-blocking Collectives";
+
+                    return po_bad_usage;
+                }
+
+                options.global_sync = 1;
+                break;
+            case 'c':
+                if (set_buffer_pool(optarg)) {
+                    bad_usage.message = "Invalid Buffer Pool";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'a':
+                if (set_allocator(optarg)) {
+                    bad_usage.message = "Invalid Allocator";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'C':
+                if (set_adaptive(optarg)) {
+                    bad_usage.message = "Invalid Confidence Interval Width";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'o':
+                if (set_output(optarg)) {
+                    bad_usage.message = "Invalid Output Format";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'P':
+                if (set_counters(optarg)) {
+                    bad_usage.message = "Invalid Counter Events";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'T':
+                if (set_pvars(optarg)) {
+                    bad_usage.message = "Invalid MPI_T Variables";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'A':
+                if (set_algorithms(optarg)) {
+                    bad_usage.message = "Invalid Algorithm Selection";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'N':
+                if (set_topology(optarg)) {
+                    bad_usage.message = "Invalid Topology";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'k':
+                if (set_degree(atoi(optarg))) {
+                    bad_usage.message = "Invalid Degree";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+
+                degree_arg = optarg;
+                break;
             case 'M': 
                 /*
                  * This function does not error but prints a warning message if
@@ -366,6 +535,27 @@ process_options (int argc, char *argv[])
         }
     }
 
+    /* every dimension of the grid adds two neighbors */
+    if (neighbor_enabled && cartesian == options.topology
+            && options.degree % 2) {
+        bad_usage.message = "Cartesian Topology Needs An Even Degree";
+        bad_usage.optarg = degree_arg;
+        bad_usage.opt = 'k';
+
+        return po_bad_usage;
+    }
+
+    /*
+     * a size list replaces the -m range; the tests that count elements round
+     * the sizes up to whole elements, so the largest one has to fit as well
+     */
+    if (sizes_enabled()) {
+        options.min_message_size = 0;
+        options.max_message_size = sizes_max(options.max_message_size);
+        options.max_message_size = (options.max_message_size
+                + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+    }
+
     return po_okay;
 }
 
@@ -407,17 +597,66 @@ print_help_message (int rank)
                "                -m 128      // min = default, max = 128\n"
                "                -m 2:128    // min = 2, max = 128\n"
                "                -m 2:       // min = 2, max = default\n");
+        printf(SIZES_HELP_STRING);
         printf("  -M SIZE       set per process maximum memory consumption to SIZE bytes\n");
         printf("                (default %d)\n", MAX_MEM_LIMIT); 
     }
 
-    printf("  -i ITER       set iterations per message size to ITER (default 1000 for small\n");
-    printf("                messages, 100 for large messages)\n");
-    printf("  -x ITER       set number of warmup iterations to skip before timing (default 200)\n");
+    if (replay_enabled) {
+        printf("  -i ITER       set the number of timed passes over the trace to ITER\n");
+        printf("                (default 100)\n");
+        printf("  -x ITER       set the number of warmup passes over the trace before timing\n");
+        printf("                (default 10)\n");
+    }
+
+    else {
+        printf("  -i ITER       set iterations per message size to ITER (default 1000 for small\n");
+        printf("                messages, 100 for large messages)\n");
+        printf("  -x ITER       set number of warmup iterations to skip before timing (default 200)\n");
+    }
 
     printf("  -f            print full format listing (MIN/MAX latency and ITERATIONS\n");
     printf("                displayed in addition to AVERAGE latency)\n");
+    printf(POOL_HELP_STRING);
+    printf(ALLOC_HELP_STRING);
+    printf(ADAPTIVE_HELP_STRING);
+    printf(OUTPUT_HELP_STRING);
+    printf(COUNTERS_HELP_STRING);
+    printf(PVARS_HELP_STRING);
+
+    if (neighbor_enabled) {
+        printf("  -N TOPOLOGY   run on a periodic `cartesian' grid (default) or on a `graph'\n");
+        printf("                created with MPI_Dist_graph_create_adjacent\n");
+        printf("  -k DEGREE     set the number of neighbors of every rank to DEGREE (default\n");
+        printf("                4), which has to be even for the grid and below the number\n");
+        printf("                of processes for the graph\n");
+    }
+
+    else if (replay_enabled) {
+        printf("  -A ALGS       replay the trace with each of the comma separated ALGS, or\n");
+        printf("                `all' algorithms the MPI library offers through MPI_T\n");
+        printf("                control variables, and report the time of each\n");
+    }
+
+    else {
+        printf(ALGORITHMS_HELP_STRING);
+    }
+
+    if (!nbc_enabled) {
+        printf("  -g            start every iteration at a globally synchronized time instead\n");
+        printf("                of after MPI_Barrier and report the completion time (last\n");
+        printf("                rank finish - first rank start) of each iteration\n");
+    }
     
+    if (replay_enabled) {
+        printf("  -h            print this help\n");
+        printf("  -v            print version info\n");
+        printf("\n");
+        fflush(stdout);
+
+        return;
+    }
+
     printf("  -t CALLS      set the number of MPI_Test() calls during the dummy computation, \n");
     printf("                set CALLS to 100, 1000, or any number > 0.\n");
 
@@ -460,10 +699,65 @@ print_version_message (int rank)
     fflush(stdout);
 }
 
+static void
+warn_skipped_sizes (int rank)
+{
+    int skipped = sizes_skipped(options.max_message_size);
+
+    if (0 == rank && skipped) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %lu "
+                "bytes\n", skipped, (unsigned long)options.max_message_size);
+    }
+}
+
+static void
+print_topology (void)
+{
+    int numprocs, i;
+
+    if (!neighbor_enabled) return;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+
+    if (cartesian == options.topology) {
+        fprintf(stdout, "# Topology: periodic cartesian grid, degree %d\n",
+                options.degree);
+    }
+
+    else {
+        fprintf(stdout, "# Topology: distributed graph, degree %d, offsets",
+                options.degree);
+
+        for (i = 1; i <= options.degree; i++) {
+            fprintf(stdout, " %d", i * numprocs / (options.degree + 1));
+        }
+
+        fprintf(stdout, "\n");
+    }
+
+    fprintf(stdout, "# Isend/Irecv = the same exchange with MPI_Isend and "
+            "MPI_Irecv\n");
+}
+
 void 
 print_preamble_nbc (int rank) 
 {
-    if (rank) return;
+    output_init(MPI_COMM_WORLD);
+    pvars_init(MPI_COMM_WORLD);
+
+    if (0 == rank && counters_enabled()) {
+        fprintf(stderr, "Counters are not supported for nonblocking "
+                "collectives\n");
+    }
+
+    if (0 == rank && algorithms_enabled()) {
+        fprintf(stderr, "Algorithm sweeps are not supported for nonblocking "
+                "collectives\n");
+    }
+
+    warn_skipped_sizes(rank);
+
+    if (rank || !output_text()) return;
     
     printf("\n");
     
@@ -482,7 +776,15 @@ print_preamble_nbc (int rank)
             break;
     }
 
-    fprintf(stdout, "# Overall = Coll. Init + Compute + MPI_Test + MPI_Wait\n\n");
+    fprintf(stdout, "# Overall = Coll. Init + Compute + MPI_Test + MPI_Wait\n");
+    print_topology();
+
+    if (pvars_count()) {
+        fprintf(stdout, "# MPI_T variables are combined over all ranks for "
+                "every message size\n");
+    }
+
+    fprintf(stdout, "\n");
 
     if (options.show_size) {
         fprintf(stdout, "%-*s", 10, "# Size");
@@ -498,15 +800,20 @@ print_preamble_nbc (int rank)
         fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Test(us)");
         fprintf(stdout, "%*s", FIELD_WIDTH, "MPI_Wait(us)");
         fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
-        fprintf(stdout, "%*s\n", FIELD_WIDTH, "Overlap(%)");
-
     }
     else {
         fprintf(stdout, "%*s", FIELD_WIDTH, "Compute(us)");
         fprintf(stdout, "%*s", FIELD_WIDTH, "Pure Comm.(us)");
-        fprintf(stdout, "%*s\n", FIELD_WIDTH, "Overlap(%)");
     }
 
+    if (neighbor_enabled) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Isend/Irecv(us)");
+    }
+
+    fprintf(stdout, "%*s", FIELD_WIDTH, "Overlap(%)");
+    pvars_print_labels(stdout);
+    fprintf(stdout, "\n");
+
     fflush(stdout);
 }
 
@@ -532,7 +839,18 @@ display_nbc_params()
 void
 print_preamble (int rank)
 {
-    if (rank) return;
+    int i;
+
+    output_init(MPI_COMM_WORLD);
+    counters_init(MPI_COMM_WORLD);
+    pvars_init(MPI_COMM_WORLD);
+    algorithms_init(strncmp(benchmark_name, "osu_", 4) ? benchmark_name
+            : benchmark_name + 4, MPI_COMM_WORLD);
+    first_iterations = options.iterations;
+    first_skip = options.skip;
+    warn_skipped_sizes(rank);
+
+    if (rank || !output_text()) return;
 
     printf("\n");
 
@@ -548,28 +866,234 @@ print_preamble (int rank)
             break;
     }
  
+    if (options.global_sync) {
+        fprintf(stdout, "# Completion = last rank finish - first rank start\n");
+    }
+
+    print_topology();
+
+    if (adaptive_enabled()) {
+        fprintf(stdout, "# Iterations chosen for a 95%% confidence interval\n");
+    }
+
+    if (allocator_selected()) {
+        fprintf(stdout, "# Allocator: %s\n", allocator_spec());
+    }
+
+    print_buffer_pool();
+
+    if (counters_count()) {
+        fprintf(stdout, "# Counters are per iteration averages over all "
+                "ranks\n");
+    }
+
+    if (pvars_count()) {
+        fprintf(stdout, "# MPI_T variables are combined over all ranks for "
+                "every message size\n");
+    }
+
     if (options.show_size) {
         fprintf(stdout, "%-*s", 10, "# Size");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Avg Latency(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, options.global_sync ?
+                "Completion(us)" : "Avg Latency(us)");
     }
 
     else {
-        fprintf(stdout, "# Avg Latency(us)");
+        fprintf(stdout, options.global_sync ? "# Completion(us)" :
+                "# Avg Latency(us)");
+    }
+
+    if (neighbor_enabled) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, "Isend/Irecv(us)");
     }
 
     if (options.show_full) {
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Min Latency(us)");
-        fprintf(stdout, "%*s", FIELD_WIDTH, "Max Latency(us)");
-        fprintf(stdout, "%*s\n", 12, "Iterations");
+        fprintf(stdout, "%*s", FIELD_WIDTH, options.global_sync ?
+                "Min Compl.(us)" : "Min Latency(us)");
+        fprintf(stdout, "%*s", FIELD_WIDTH, options.global_sync ?
+                "Max Compl.(us)" : "Max Latency(us)");
+        fprintf(stdout, "%*s", 12, "Iterations");
     }
 
-    else {
-        fprintf(stdout, "\n");
+    else if (adaptive_enabled()) {
+        fprintf(stdout, "%*s", 12, "Iterations");
+    }
+
+    if (adaptive_enabled()) {
+        fprintf(stdout, "%*s", 12, "Warmup");
     }
 
+    for (i = 0; i < counters_count(); i++) {
+        fprintf(stdout, "%*s", FIELD_WIDTH, counters_label(i));
+    }
+
+    pvars_print_labels(stdout);
+
+    fprintf(stdout, "\n");
     fflush(stdout);
 }
 
+/*
+ * Runs the message sizes once per selected algorithm, see osu_algorithms.h.
+ * The benchmarks switch to the large message iteration counts on the way, so
+ * every algorithm starts over with the initial ones.
+ */
+int
+next_algorithm (MPI_Comm * comm)
+{
+    options.iterations = first_iterations;
+    options.skip = first_skip;
+
+    return algorithms_next(comm);
+}
+
+/*
+ * Creates the communicator the neighborhood collectives run on.  The
+ * cartesian topology is a periodic grid of options.degree / 2 dimensions
+ * shaped by MPI_Dims_create.  In the graph every rank sends to the ranks at
+ * options.degree distinct offsets above it, spread evenly over the
+ * processes, and receives from the ranks as far below it, so that unlike on
+ * the grid most neighbors are far apart in rank order.
+ */
+int
+create_neighborhood (MPI_Comm * comm)
+{
+    int rank, numprocs, ndims = options.degree / 2, offset, i;
+    int * dims, * periods, * weights;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+
+    if (dist_graph == options.topology && options.degree >= numprocs) {
+        if (0 == rank) {
+            fprintf(stderr, "A graph of degree %d needs at least %d "
+                    "processes\n", options.degree, options.degree + 1);
+        }
+
+        return 1;
+    }
+
+    sources = malloc(options.degree * sizeof(int));
+    destinations = malloc(options.degree * sizeof(int));
+    exchange_requests = malloc(2 * options.degree * sizeof(MPI_Request));
+    weights = malloc(options.degree * sizeof(int));
+    dims = calloc(ndims + 1, sizeof(int));
+    periods = malloc((ndims + 1) * sizeof(int));
+
+    if (NULL == sources || NULL == destinations || NULL == exchange_requests
+            || NULL == weights || NULL == dims || NULL == periods) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    if (cartesian == options.topology) {
+        for (i = 0; i < ndims; i++) {
+            periods[i] = 1;
+        }
+
+        MPI_Dims_create(numprocs, ndims, dims);
+        MPI_Cart_create(MPI_COMM_WORLD, ndims, dims, periods, 0, comm);
+
+        /* the lower neighbor in each dimension comes first */
+        for (i = 0; i < ndims; i++) {
+            MPI_Cart_shift(*comm, i, 1, sources + 2 * i, sources + 2 * i + 1);
+            destinations[2 * i] = sources[2 * i];
+            destinations[2 * i + 1] = sources[2 * i + 1];
+        }
+    }
+
+    else {
+        for (i = 0; i < options.degree; i++) {
+            offset = (i + 1) * numprocs / (options.degree + 1);
+            destinations[i] = (rank + offset) % numprocs;
+            sources[i] = (rank - offset + numprocs) % numprocs;
+            weights[i] = 1;
+        }
+
+        /* MPI_UNWEIGHTED trips -Wstringop-overread with some MPI headers */
+        MPI_Dist_graph_create_adjacent(MPI_COMM_WORLD, options.degree, sources,
+                weights, options.degree, destinations, weights,
+                MPI_INFO_NULL, 0, comm);
+    }
+
+    free(weights);
+    free(dims);
+    free(periods);
+
+    return 0;
+}
+
+void
+free_neighborhood (MPI_Comm * comm)
+{
+    MPI_Comm_free(comm);
+    free(sources);
+    free(destinations);
+    free(exchange_requests);
+}
+
+/*
+ * The neighborhood exchange written out with MPI_Irecv and MPI_Isend: block j
+ * of recvbuf comes from source j and block j of sendbuf, sendstride bytes
+ * apart, goes to destination j.  A sendstride of 0 sends the same block to
+ * all destinations as the allgather does.  The tags tell the blocks apart
+ * when the grid has a dimension of one or two processes, in which a rank is
+ * both the lower and the upper neighbor.
+ */
+void
+neighbor_exchange (void * sendbuf, int sendstride, void * recvbuf, int size,
+        MPI_Comm comm)
+{
+    int i;
+
+    for (i = 0; i < options.degree; i++) {
+        MPI_Irecv((char *)recvbuf + (size_t)i * size, size, MPI_CHAR,
+                sources[i], cartesian == options.topology ? i ^ 1 : i, comm,
+                exchange_requests + i);
+    }
+
+    for (i = 0; i < options.degree; i++) {
+        MPI_Isend((char *)sendbuf + (size_t)i * sendstride, size, MPI_CHAR,
+                destinations[i], i, comm,
+                exchange_requests + options.degree + i);
+    }
+
+    MPI_Waitall(2 * options.degree, exchange_requests, MPI_STATUSES_IGNORE);
+}
+
+/*
+ * Times neighbor_exchange with the iteration counts of the current message
+ * size and keeps the average over all ranks for print_stats and
+ * print_stats_nbc.
+ */
+void
+measure_neighbor_exchange (void * sendbuf, int sendstride, void * recvbuf,
+        int size, MPI_Comm comm)
+{
+    double t_start, timer = 0.0, latency;
+    int numprocs, i;
+
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    for (i = 0; i < options.iterations + options.skip; i++) {
+        t_start = MPI_Wtime();
+        neighbor_exchange(sendbuf, sendstride, recvbuf, size, comm);
+
+        if (i >= options.skip) {
+            timer += MPI_Wtime() - t_start;
+        }
+
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+
+    latency = timer * 1e6 / options.iterations;
+
+    MPI_Reduce(&latency, &exchange_latency, 1, MPI_DOUBLE, MPI_SUM, 0,
+            MPI_COMM_WORLD);
+    exchange_latency /= numprocs;
+}
+
 void
 calculate_and_print_stats(int rank, int size, int numprocs,
                           double timer, double latency,
@@ -583,6 +1107,8 @@ calculate_and_print_stats(int rank, int size, int numprocs,
         double init_total   = (init_time * 1e6) / options.iterations;
         double comm_time   = latency;
 
+        pvars_end(MPI_COMM_WORLD);
+
         if(rank != 0) {
             MPI_Reduce(&test_total, &test_total, 1, MPI_DOUBLE, MPI_SUM, 0,
                 MPI_COMM_WORLD);
@@ -641,6 +1167,7 @@ print_stats_nbc (int rank, int size, double overall_time,
     if (rank) return;
 
     double overlap;
+    int i;
  
     /* Note : cpu_time received in this function includes time for
        *      dummy compute as well as test calls so we will subtract
@@ -649,6 +1176,32 @@ print_stats_nbc (int rank, int size, double overall_time,
        */
 
     overlap = max(0, 100 - (((overall_time - (cpu_time - test_time)) / comm_time) * 100)); 
+
+    output_begin(size);
+    output_double("overall_us", overall_time);
+    output_double("compute_us", cpu_time - test_time);
+    output_double("init_us", init_time);
+    output_double("test_us", test_time);
+    output_double("wait_us", wait_time);
+    output_double("pure_comm_us", comm_time);
+
+    if (neighbor_enabled) {
+        output_string("topology", topology_names[options.topology]);
+        output_int("degree", options.degree);
+        output_double("isend_irecv_us", exchange_latency);
+    }
+
+    output_double("overlap_pct", overlap);
+
+    for (i = 0; i < pvars_count(); i++) {
+        output_double(pvars_name(i), pvars_value(i));
+    }
+
+    output_int("iterations", options.iterations);
+    output_int("warmup", options.skip);
+    output_end();
+
+    if (!output_text()) return;
     
     if (options.show_size) {
         fprintf(stdout, "%-*d", 10, size);
@@ -659,20 +1212,27 @@ print_stats_nbc (int rank, int size, double overall_time,
     }
 
     if (options.show_full) {
-           fprintf(stdout, "%*.*f%*.*f%*.*f%*.*f%*.*f%*.*f\n",
+           fprintf(stdout, "%*.*f%*.*f%*.*f%*.*f%*.*f",
                 FIELD_WIDTH, FLOAT_PRECISION, (cpu_time - test_time),
                 FIELD_WIDTH, FLOAT_PRECISION, init_time,
                 FIELD_WIDTH, FLOAT_PRECISION, test_time, 
                 FIELD_WIDTH, FLOAT_PRECISION, wait_time,
-                FIELD_WIDTH, FLOAT_PRECISION, comm_time,
-                FIELD_WIDTH, FLOAT_PRECISION, overlap);
+                FIELD_WIDTH, FLOAT_PRECISION, comm_time);
     }    
     else {
         fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, (cpu_time - test_time));
         fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, comm_time);
-        fprintf(stdout, "%*.*f\n", FIELD_WIDTH, FLOAT_PRECISION, overlap);
     }
 
+    if (neighbor_enabled) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                exchange_latency);
+    }
+
+    fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, overlap);
+
+    pvars_print_values(stdout);
+    fprintf(stdout, "\n");
     fflush(stdout);
 }
 
@@ -680,8 +1240,43 @@ void
 print_stats (int rank, int size, double avg_time, double min_time, double
         max_time)
 {
+    int i;
+
     if (rank) return;
 
+    algorithms_record(size, avg_time);
+
+    output_begin(size);
+
+    if (algorithms_current()) {
+        output_string("algorithm", algorithms_current());
+    }
+
+    output_double(options.global_sync ? "completion_us" : "avg_latency_us",
+            avg_time);
+    output_double("min_us", min_time);
+    output_double("max_us", max_time);
+
+    if (neighbor_enabled) {
+        output_string("topology", topology_names[options.topology]);
+        output_int("degree", options.degree);
+        output_double("isend_irecv_us", exchange_latency);
+    }
+
+    for (i = 0; i < counters_count(); i++) {
+        output_double(counters_field(i), counters_value(i));
+    }
+
+    for (i = 0; i < pvars_count(); i++) {
+        output_double(pvars_name(i), pvars_value(i));
+    }
+
+    output_int("iterations", options.iterations);
+    output_int("warmup", options.skip);
+    output_end();
+
+    if (!output_text()) return;
+
     if (options.show_size) {
         fprintf(stdout, "%-*d", 10, size);
         fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, avg_time);
@@ -691,17 +1286,34 @@ print_stats (int rank, int size, double avg_time, double min_time, double
         fprintf(stdout, "%*.*f", 17, FLOAT_PRECISION, avg_time);
     }
 
+    if (neighbor_enabled) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                exchange_latency);
+    }
+
     if (options.show_full) {
-        fprintf(stdout, "%*.*f%*.*f%*lu\n", 
+        fprintf(stdout, "%*.*f%*.*f%*lu", 
                 FIELD_WIDTH, FLOAT_PRECISION, min_time,
                 FIELD_WIDTH, FLOAT_PRECISION, max_time,
                 12, options.iterations);
     }
 
-    else {
-        fprintf(stdout, "\n");
+    else if (adaptive_enabled()) {
+        fprintf(stdout, "%*lu", 12, options.iterations);
+    }
+
+    if (adaptive_enabled()) {
+        fprintf(stdout, "%*lu", 12, options.skip);
+    }
+
+    for (i = 0; i < counters_count(); i++) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                counters_value(i));
     }
 
+    pvars_print_values(stdout);
+
+    fprintf(stdout, "\n");
     fflush(stdout);
 }
 
@@ -737,14 +1349,14 @@ set_buffer (void * buffer, enum accel_type type, int data, size_t size)
 int
 allocate_buffer (void ** buffer, size_t size, enum accel_type type)
 {
-    size_t alignment = sysconf(_SC_PAGESIZE);
 #ifdef _ENABLE_CUDA_
     cudaError_t cuerr = cudaSuccess;
 #endif
 
     switch (type) {
         case none:
-            return posix_memalign(buffer, alignment, size);
+            *buffer = osu_malloc(size);
+            return NULL == *buffer;
 #ifdef _ENABLE_CUDA_
         case cuda:
             cuerr = cudaMalloc(buffer, size);
@@ -786,7 +1398,7 @@ free_buffer (void * buffer, enum accel_type type)
 {
     switch (type) {
         case none:
-            free(buffer);
+            osu_free(buffer);
             break;
         case managed:
         case cuda:
@@ -817,6 +1429,216 @@ free_buffer (void * buffer, enum accel_type type)
     is_alloc = 0;
 }
 
+/*
+ * Globally synchronized timing.  Every rank estimates the offset of its clock
+ * from the clock of rank 0 with ping-pong exchanges, keeping the exchange with
+ * the smallest round trip time.  The drift of the clock is estimated from the
+ * change in offset between two consecutive calls to sync_clocks().  Times are
+ * kept relative to the first call to avoid losing precision in doubles.
+ */
+static double wtime_base = 0.0;
+static double clock_anchor = 0.0;
+static double clock_offset = 0.0;
+static double clock_drift = 0.0;
+static double clock_error = 0.0;
+static int clock_synced = 0;
+
+static double sync_guard = 0.0;
+static double next_start = 0.0;
+static double completion_sum = 0.0;
+static double completion_min = 0.0;
+static double completion_max = 0.0;
+static int completion_count = 0;
+static int started_late = 0;
+
+static double
+local_wtime (void)
+{
+    return MPI_Wtime() - wtime_base;
+}
+
+double
+global_wtime (void)
+{
+    double t = local_wtime();
+
+    return t + clock_offset + clock_drift * (t - clock_anchor);
+}
+
+void
+sync_clocks (void)
+{
+    int rank, numprocs, peer, i;
+    double t_send, t_recv, t_root, rtt, best_rtt, mid = 0.0, offset = 0.0;
+    double error = 0.0;
+    MPI_Status status;
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+
+    if (!clock_synced) {
+        wtime_base = MPI_Wtime();
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    for (peer = 1; peer < numprocs; peer++) {
+        if (0 == rank) {
+            for (i = 0; i < SYNC_PINGPONGS; i++) {
+                MPI_Recv(NULL, 0, MPI_CHAR, peer, 0, MPI_COMM_WORLD, &status);
+                t_root = local_wtime();
+                MPI_Send(&t_root, 1, MPI_DOUBLE, peer, 0, MPI_COMM_WORLD);
+            }
+        }
+
+        else if (peer == rank) {
+            best_rtt = 1e300;
+
+            for (i = 0; i < SYNC_PINGPONGS; i++) {
+                t_send = local_wtime();
+                MPI_Send(NULL, 0, MPI_CHAR, 0, 0, MPI_COMM_WORLD);
+                MPI_Recv(&t_root, 1, MPI_DOUBLE, 0, 0, MPI_COMM_WORLD,
+                        &status);
+                t_recv = local_wtime();
+                rtt = t_recv - t_send;
+
+                if (rtt < best_rtt) {
+                    best_rtt = rtt;
+                    mid = (t_send + t_recv) / 2.0;
+                    offset = t_root - mid;
+                }
+            }
+
+            if (clock_synced && mid > clock_anchor) {
+                clock_drift = (offset - clock_offset) / (mid - clock_anchor);
+            }
+
+            clock_anchor = mid;
+            clock_offset = offset;
+            error = best_rtt / 2.0;
+        }
+    }
+
+    MPI_Allreduce(&error, &clock_error, 1, MPI_DOUBLE, MPI_MAX,
+            MPI_COMM_WORLD);
+    clock_synced = 1;
+}
+
+/*
+ * Called before the iterations of each message size.  With -C the warmup and
+ * iteration counts are handed over to the sampling engine.  Without -g
+ * nothing else is done, otherwise the clocks are resynchronized and the first
+ * iteration is scheduled.  The guard interval between the last rank finishing an iteration
+ * and the start of the next one has to cover the exit skew of the
+ * MPI_Allreduce used to agree on that finish time and the clock error.
+ */
+void
+schedule_iterations (void)
+{
+    double t_start, t_reduce = 0.0, t_max = 0.0, dummy = 0.0;
+    int i;
+
+    if (adaptive_enabled()) {
+        adaptive_reset();
+        options.skip = adaptive_loop_skip();
+        options.iterations = adaptive_loop_iterations();
+    }
+
+    if (!options.global_sync) {
+        return;
+    }
+
+    sync_clocks();
+
+    for (i = 0; i < 10; i++) {
+        t_start = MPI_Wtime();
+        MPI_Allreduce(MPI_IN_PLACE, &dummy, 1, MPI_DOUBLE, MPI_MAX,
+                MPI_COMM_WORLD);
+        t_reduce = max(t_reduce, MPI_Wtime() - t_start);
+    }
+
+    MPI_Allreduce(&t_reduce, &t_max, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+    sync_guard = 2.0 * (t_max + clock_error);
+
+    completion_sum = 0.0;
+    completion_min = 1e300;
+    completion_max = 0.0;
+    completion_count = 0;
+    started_late = 0;
+
+    next_start = global_wtime() + sync_guard;
+    MPI_Allreduce(MPI_IN_PLACE, &next_start, 1, MPI_DOUBLE, MPI_MAX,
+            MPI_COMM_WORLD);
+    next_start += sync_guard;
+
+    while (global_wtime() < next_start);
+}
+
+/*
+ * Called after every iteration in place of MPI_Barrier.  With -g the global
+ * start and finish times of all ranks are combined to get the completion time
+ * of the iteration and the next iteration is scheduled after the last rank
+ * finished.  If any rank only reached its wait after the scheduled time of
+ * the previous iteration, all ranks double the guard interval.
+ */
+void
+finish_iteration (int record, double t_start, double t_stop)
+{
+    double t[3];
+    double completion;
+
+    /* with -C the loop bounds follow the sampling engine */
+    if (adaptive_enabled()) {
+        adaptive_record(t_stop - t_start, MPI_COMM_WORLD);
+        options.skip = adaptive_loop_skip();
+        options.iterations = adaptive_loop_iterations();
+    }
+
+    if (!options.global_sync) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        return;
+    }
+
+    t_start -= wtime_base;
+    t_stop -= wtime_base;
+
+    t[0] = -(t_start + clock_offset + clock_drift * (t_start - clock_anchor));
+    t[1] = t_stop + clock_offset + clock_drift * (t_stop - clock_anchor);
+    t[2] = started_late;
+
+    MPI_Allreduce(MPI_IN_PLACE, t, 3, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+
+    if (t[2] > 0.0) {
+        sync_guard *= 2.0;
+    }
+
+    if (record) {
+        completion = t[1] + t[0];
+        completion_sum += completion;
+        completion_min = min(completion_min, completion);
+        completion_max = max(completion_max, completion);
+        completion_count++;
+    }
+
+    next_start = t[1] + sync_guard;
+    started_late = global_wtime() > next_start;
+
+    while (global_wtime() < next_start);
+}
+
+void
+get_completion_stats (double * avg_time, double * min_time, double * max_time)
+{
+    if (0 == completion_count) {
+        *avg_time = *min_time = *max_time = 0.0;
+        return;
+    }
+
+    *avg_time = completion_sum * 1e6 / completion_count;
+    *min_time = completion_min * 1e6;
+    *max_time = completion_max * 1e6;
+}
+
 int
 init_accel (void)
 {
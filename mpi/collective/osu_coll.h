@@ -18,6 +18,14 @@
 #include <string.h>
 #include <stdint.h>
 
+#include "osu_adaptive.h"
+#include "osu_alloc.h"
+#include "osu_output.h"
+#include "osu_counters.h"
+#include "osu_pvars.h"
+#include "osu_algorithms.h"
+#include "osu_sizes.h"
+
 #ifdef _ENABLE_CUDA_
 
 #include "cuda.h"
@@ -41,6 +49,7 @@
 #define MAX_ALIGNMENT 16384
 #define MAX_MEM_LIMIT (512*1024*1024)
 #define MAX_MEM_LOWER_LIMIT (1*1024*1024)
+#define SYNC_PINGPONGS 50
 
 #ifdef _ENABLE_OPENACC_
 #   define OPENACC_ENABLED 1
@@ -294,6 +303,11 @@ enum target_type {
     both
 };
 
+enum topology_type {
+    cartesian,
+    dist_graph
+};
+
 struct options_t {
     enum accel_type accel;
     enum target_type target;
@@ -308,6 +322,9 @@ struct options_t {
     size_t skip_large;
     int num_probes;
     int device_array_size;
+    int global_sync;
+    enum topology_type topology;
+    int degree;
 };
 
 extern struct options_t options;
@@ -326,6 +343,31 @@ void free_host_arrays();
 void free_device_arrays();
 #endif
 
+/*
+ * Globally Synchronized Timing
+ */
+void sync_clocks (void);
+double global_wtime (void);
+void schedule_iterations (void);
+void finish_iteration (int record, double t_start, double t_stop);
+void get_completion_stats (double * avg_time, double * min_time,
+        double * max_time);
+
+/*
+ * Neighborhood Collectives
+ */
+int create_neighborhood (MPI_Comm * comm);
+void free_neighborhood (MPI_Comm * comm);
+void neighbor_exchange (void * sendbuf, int sendstride, void * recvbuf,
+        int size, MPI_Comm comm);
+void measure_neighbor_exchange (void * sendbuf, int sendstride, void * recvbuf,
+        int size, MPI_Comm comm);
+
+/*
+ * Algorithm Selection
+ */
+int next_algorithm (MPI_Comm * comm);
+
 /*
  * Option Processing
  */
@@ -361,5 +403,8 @@ int cleanup_accel (void);
 void set_header (const char * header);
 void set_benchmark_name (const char * name);
 void enable_accel_support (void);
+void enable_neighbor_support (void);
+void enable_nbc_support (void);
+void enable_replay_support (void);
 
 #endif
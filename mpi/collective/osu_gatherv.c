@@ -17,8 +17,9 @@ int main(int argc, char *argv[])
     double timer=0.0;
     double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
     char *sendbuf, *recvbuf;
-    int *rdispls, *recvcounts;
+    int *rdispls=NULL, *recvcounts=NULL;
     int po_ret;
+    MPI_Comm comm;
     size_t bufsize;
 
     set_header(HEADER);
@@ -68,86 +69,106 @@ int main(int argc, char *argv[])
     }
 
     if (0 == rank) {
-        if (allocate_buffer((void**)&recvcounts, numprocs*sizeof(int), none)) {
+        if (NULL == (recvcounts = malloc(numprocs*sizeof(int)))) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
-        if (allocate_buffer((void**)&rdispls, numprocs*sizeof(int), none)) {
+        if (NULL == (rdispls = malloc(numprocs*sizeof(int)))) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
 
         bufsize = options.max_message_size * numprocs;
-        if (allocate_buffer((void**)&recvbuf, bufsize, options.accel)) {
+        if (allocate_buffer((void**)&recvbuf, bufsize + buffer_pool_size(),
+                    options.accel)) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
-        set_buffer(recvbuf, options.accel, 1, bufsize);
+        set_buffer(recvbuf, options.accel, 1, bufsize + buffer_pool_size());
     }
 
-    if (allocate_buffer((void**)&sendbuf, options.max_message_size,
+    if (allocate_buffer((void**)&sendbuf, options.max_message_size
+                + buffer_pool_size(),
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    set_buffer(sendbuf, options.accel, 0, options.max_message_size);
+    set_buffer(sendbuf, options.accel, 0, options.max_message_size + buffer_pool_size());
 
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    while (next_algorithm(&comm)) {
+        for(size=first_size(options.min_message_size, options.max_message_size);
+                size <= options.max_message_size;
+                size = next_size(size, options.max_message_size)) {
 
-        if(size > LARGE_MESSAGE_SIZE) {
-            options.skip = options.skip_large;
-            options.iterations = options.iterations_large;
-        }
+            if(size > LARGE_MESSAGE_SIZE) {
+                options.skip = options.skip_large;
+                options.iterations = options.iterations_large;
+            }
 
-        MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Barrier(MPI_COMM_WORLD);
 
-        if (0 == rank) {
-            disp =0;
-            for ( i = 0; i < numprocs; i++) {
-                recvcounts[i] = size;
-                rdispls[i] = disp;
-                disp += size;
+            if (0 == rank) {
+                disp =0;
+                for ( i = 0; i < numprocs; i++) {
+                    recvcounts[i] = size;
+                    rdispls[i] = disp;
+                    disp += size;
+                }
             }
-        }
 
-        MPI_Barrier(MPI_COMM_WORLD);
-        timer=0.0;
-        for(i=0; i < options.iterations + options.skip ; i++) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            timer=0.0;
+            schedule_iterations();
+            pvars_begin();
+            for(i=0; i < options.iterations + options.skip ; i++) {
+
+                if(i == options.skip) counters_reset();
+                if(i >= options.skip) counters_start();
+                t_start = MPI_Wtime();
 
-            t_start = MPI_Wtime();
+                MPI_Gatherv(cycle_buffer(sendbuf, i, size), size, MPI_CHAR,
+                        cycle_buffer(recvbuf, i, size * numprocs), recvcounts,
+                        rdispls, MPI_CHAR, 0, comm);
 
-            MPI_Gatherv(sendbuf, size, MPI_CHAR, recvbuf, recvcounts, rdispls, MPI_CHAR, 0, MPI_COMM_WORLD);
+                t_stop = MPI_Wtime();
+                counters_stop();
 
-            t_stop = MPI_Wtime();
+                if(i >= options.skip) {
+                    timer+= t_stop-t_start;
+                }
+                finish_iteration(i >= options.skip, t_start, t_stop);
 
-            if(i >= options.skip) {
-                timer+= t_stop-t_start;
             }
+
             MPI_Barrier(MPI_COMM_WORLD);
 
-        }
+            latency = (double)(timer * 1e6) / options.iterations;
 
-        MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD);
+            avg_time = avg_time/numprocs;
 
-        latency = (double)(timer * 1e6) / options.iterations;
+            if (options.global_sync) {
+                get_completion_stats(&avg_time, &min_time, &max_time);
+            }
 
-        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                MPI_COMM_WORLD);
-        avg_time = avg_time/numprocs;
+            counters_reduce(options.iterations, MPI_COMM_WORLD);
 
-        print_stats(rank, size, avg_time, min_time, max_time);
-        MPI_Barrier(MPI_COMM_WORLD);
+            pvars_end(MPI_COMM_WORLD);
+            print_stats(rank, size, avg_time, min_time, max_time);
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
     }
 
     if (0 == rank) {
-        free_buffer(rdispls, none);
-        free_buffer(recvcounts, none);
+        free(rdispls);
+        free(recvcounts);
         free_buffer(recvbuf, options.accel);
     }
     free_buffer(sendbuf, options.accel);
@@ -30,6 +30,7 @@ int main(int argc, char *argv[])
     set_header(HEADER);
     set_benchmark_name("osu_iallgatherv");
     enable_accel_support();
+    enable_nbc_support();
     po_ret = process_options(argc, argv);
 
     if (po_okay == po_ret && none != options.accel) {
@@ -75,11 +76,11 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit / numprocs;
     }
 
-    if (allocate_buffer((void**)&recvcounts, numprocs*sizeof(int), none)) {
+    if (NULL == (recvcounts = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    if (allocate_buffer((void**)&rdispls, numprocs*sizeof(int), none)) {
+    if (NULL == (rdispls = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
@@ -100,7 +101,9 @@ int main(int argc, char *argv[])
 
     print_preamble_nbc(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=first_size(options.min_message_size, options.max_message_size);
+            size <= options.max_message_size;
+            size = next_size(size, options.max_message_size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = SKIP_LARGE;
             options.iterations = options.iterations_large;
@@ -119,6 +122,7 @@ int main(int argc, char *argv[])
         }
 
         MPI_Barrier(MPI_COMM_WORLD);       
+        pvars_begin();
         timer=0.0;
         for(i=0; i < options.iterations + options.skip ; i++) {
 
@@ -195,8 +199,8 @@ int main(int argc, char *argv[])
 
     }
    
-    free_buffer(rdispls, none);
-    free_buffer(recvcounts, none);
+    free(rdispls);
+    free(recvcounts);
     free_buffer(sendbuf, options.accel);
     free_buffer(recvbuf, options.accel); 
 
@@ -32,6 +32,7 @@ int main(int argc, char *argv[])
     set_header(HEADER);
     set_benchmark_name("osu_ialltoallv");
     enable_accel_support();
+    enable_nbc_support();
     po_ret = process_options(argc, argv);
 
     if (po_okay == po_ret && none != options.accel) {
@@ -77,20 +78,20 @@ int main(int argc, char *argv[])
         options.max_message_size = options.max_mem_limit / numprocs;
     }
      
-    if (allocate_buffer((void**)&recvcounts, numprocs*sizeof(int), none)) {
+    if (NULL == (recvcounts = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    if (allocate_buffer((void**)&sendcounts, numprocs*sizeof(int), none)) {
+    if (NULL == (sendcounts = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
 
-    if (allocate_buffer((void**)&rdispls, numprocs*sizeof(int), none)) {
+    if (NULL == (rdispls = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    if (allocate_buffer((void**)&sdispls, numprocs*sizeof(int), none)) {
+    if (NULL == (sdispls = malloc(numprocs*sizeof(int)))) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
@@ -111,7 +112,9 @@ int main(int argc, char *argv[])
 
     print_preamble_nbc(rank);
 
-    for(size=options.min_message_size; size <=options.max_message_size; size *= 2) {
+    for(size=first_size(options.min_message_size, options.max_message_size);
+            size <= options.max_message_size;
+            size = next_size(size, options.max_message_size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = SKIP_LARGE;
             options.iterations = options.iterations_large;
@@ -131,6 +134,8 @@ int main(int argc, char *argv[])
         }
         MPI_Barrier(MPI_COMM_WORLD);
  
+        pvars_begin();
+ 
         timer = 0.0;     
           
         for(i=0; i < options.iterations + options.skip ; i++) {
@@ -209,10 +214,10 @@ int main(int argc, char *argv[])
                                   wait_total, init_total);
     }  
 
-    free_buffer(rdispls, none);
-    free_buffer(sdispls, none);
-    free_buffer(recvcounts, none);
-    free_buffer(sendcounts, none);
+    free(rdispls);
+    free(sdispls);
+    free(recvcounts);
+    free(sendcounts);
     free_buffer(sendbuf, options.accel);
     free_buffer(recvbuf, options.accel);
 
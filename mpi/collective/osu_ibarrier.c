@@ -26,6 +26,7 @@ int main(int argc, char *argv[])
     set_header(HEADER);
     set_benchmark_name("osu_ibarrier");
     enable_accel_support();
+    enable_nbc_support();
     po_ret = process_options(argc, argv);
 
     if (po_okay == po_ret && none != options.accel) {
@@ -74,6 +75,7 @@ int main(int argc, char *argv[])
 
     options.skip = options.skip_large;
     options.iterations = iterations_large;
+    pvars_begin();
     timer = 0.0;
 
     for(i=0; i < options.iterations + options.skip ; i++) {
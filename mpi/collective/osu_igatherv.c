@@ -24,13 +24,14 @@ int main(int argc, char *argv[])
     double init_total = 0.0, wait_total = 0.0;
     char *sendbuf=NULL;
     char *recvbuf=NULL;
-    int *rdispls, *recvcounts;
+    int *rdispls=NULL, *recvcounts=NULL;
     int po_ret;
     size_t bufsize;
 
     set_header(HEADER);
     set_benchmark_name("osu_igatherv");
     enable_accel_support();
+    enable_nbc_support();
     po_ret = process_options(argc, argv);
 
     if (po_okay == po_ret && none != options.accel) {
@@ -77,11 +78,11 @@ int main(int argc, char *argv[])
     }
 
     if (0 == rank) {
-        if (allocate_buffer((void**)&recvcounts, numprocs*sizeof(int), none)) {
+        if (NULL == (recvcounts = malloc(numprocs*sizeof(int)))) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
-        if (allocate_buffer((void**)&rdispls, numprocs*sizeof(int), none)) {
+        if (NULL == (rdispls = malloc(numprocs*sizeof(int)))) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
@@ -103,7 +104,9 @@ int main(int argc, char *argv[])
 
     print_preamble_nbc(rank);
 
-    for(size=options.min_message_size; size <=options.max_message_size; size *= 2) {
+    for(size=first_size(options.min_message_size, options.max_message_size);
+            size <= options.max_message_size;
+            size = next_size(size, options.max_message_size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = SKIP_LARGE;
             options.iterations = options.iterations_large;
@@ -123,6 +126,7 @@ int main(int argc, char *argv[])
         }
 
         MPI_Barrier(MPI_COMM_WORLD);
+        pvars_begin();
         timer = 0.0;     
           
         for(i=0; i < options.iterations + options.skip ; i++) {
@@ -201,8 +205,8 @@ int main(int argc, char *argv[])
                                   wait_total, init_total);
     }  
     if (0 == rank) {
-        free_buffer(rdispls, none);
-        free_buffer(recvcounts, none);
+        free(rdispls);
+        free(recvcounts);
         free_buffer(recvbuf, options.accel);
     }
     free_buffer(sendbuf, options.accel);
@@ -30,6 +30,7 @@ int main(int argc, char *argv[])
     set_header(HEADER);
     set_benchmark_name("osu_iscatter");
     enable_accel_support();
+    enable_nbc_support();
     po_ret = process_options(argc, argv);
 
     if (po_okay == po_ret && none != options.accel) {
@@ -93,12 +94,16 @@ int main(int argc, char *argv[])
 
     print_preamble_nbc(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    for(size=first_size(options.min_message_size, options.max_message_size);
+            size <= options.max_message_size;
+            size = next_size(size, options.max_message_size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = options.skip_large;
             options.iterations = options.iterations_large;
         }
 
+        pvars_begin();
+
         timer = 0.0;
         for(i=0; i < options.iterations + options.skip ; i++) {
             t_start = MPI_Wtime();
@@ -31,6 +31,7 @@ int main(int argc, char *argv[])
     set_header(HEADER);
     set_benchmark_name("osu_iscatterv");
     enable_accel_support();
+    enable_nbc_support();
     po_ret = process_options(argc, argv);
 
     if (po_okay == po_ret && none != options.accel) {
@@ -77,11 +78,11 @@ int main(int argc, char *argv[])
     }
     
     if (0 == rank) {
-        if (allocate_buffer((void**)&sendcounts, numprocs*sizeof(int), none)) {
+        if (NULL == (sendcounts = malloc(numprocs*sizeof(int)))) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
-        if (allocate_buffer((void**)&sdispls, numprocs*sizeof(int), none)) {
+        if (NULL == (sdispls = malloc(numprocs*sizeof(int)))) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
@@ -103,7 +104,9 @@ int main(int argc, char *argv[])
 
     print_preamble_nbc(rank);
 
-    for(size=options.min_message_size; size <=options.max_message_size; size *= 2) {
+    for(size=first_size(options.min_message_size, options.max_message_size);
+            size <= options.max_message_size;
+            size = next_size(size, options.max_message_size)) {
         if(size > LARGE_MESSAGE_SIZE) {
             options.skip = SKIP_LARGE;
             options.iterations = options.iterations_large;
@@ -122,6 +125,8 @@ int main(int argc, char *argv[])
 	
         MPI_Barrier(MPI_COMM_WORLD);
         
+        pvars_begin();
+        
         timer = 0.0;     
         
         for(i=0; i < options.iterations + options.skip ; i++) {
@@ -199,8 +204,8 @@ int main(int argc, char *argv[])
     }  
     
     if (0 == rank) {
-        free_buffer(sendcounts, none);
-        free_buffer(sdispls, none);
+        free(sendcounts);
+        free(sdispls);
         free_buffer(sendbuf, options.accel);
     }
     free_buffer(recvbuf, options.accel);
@@ -0,0 +1,167 @@
+#define BENCHMARK "OSU MPI%s Neighborhood All-to-Allv Latency Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include "osu_coll.h"
+
+int
+main (int argc, char *argv[])
+{
+    int i, numprocs, rank, size;
+    double latency = 0.0, t_start = 0.0, t_stop = 0.0;
+    double timer=0.0;
+    double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
+    char * sendbuf = NULL, * recvbuf = NULL;
+    int po_ret;
+    MPI_Comm comm;
+    int * counts = NULL, * displs = NULL;
+    size_t bufsize;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_neighbor_alltoallv");
+    enable_neighbor_support();
+    po_ret = process_options(argc, argv);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+
+    switch (po_ret) {
+        case po_bad_usage:
+            print_bad_usage_message(rank);
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            print_help_message(rank);
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_version_message:
+            print_version_message(rank);
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if(numprocs < 2) {
+        if (rank == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    if (create_neighborhood(&comm)) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    if ((options.max_message_size * options.degree) > options.max_mem_limit) {
+        options.max_message_size = options.max_mem_limit / options.degree;
+    }
+
+    if (NULL == (counts = malloc(options.degree * sizeof(int)))) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    if (NULL == (displs = malloc(options.degree * sizeof(int)))) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    bufsize = options.max_message_size * options.degree;
+
+    if (allocate_buffer((void**)&sendbuf, bufsize + buffer_pool_size(),
+                options.accel)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    set_buffer(sendbuf, options.accel, 1, bufsize + buffer_pool_size());
+
+    if (allocate_buffer((void**)&recvbuf, bufsize + buffer_pool_size(),
+                options.accel)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    set_buffer(recvbuf, options.accel, 0, bufsize + buffer_pool_size());
+    print_preamble(rank);
+
+    for(size=first_size(options.min_message_size, options.max_message_size);
+            size <= options.max_message_size;
+            size = next_size(size, options.max_message_size)) {
+        if (size > LARGE_MESSAGE_SIZE) {
+            options.skip = options.skip_large;
+            options.iterations = options.iterations_large;
+        }
+
+        for (i = 0; i < options.degree; i++) {
+            counts[i] = size;
+            displs[i] = i * size;
+        }
+
+        measure_neighbor_exchange(sendbuf, size, recvbuf, size, comm);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+        timer=0.0;
+        schedule_iterations();
+        pvars_begin();
+
+        for (i=0; i < options.iterations + options.skip ; i++) {
+            if(i == options.skip) counters_reset();
+            if(i >= options.skip) counters_start();
+            t_start = MPI_Wtime();
+            MPI_Neighbor_alltoallv(cycle_buffer(sendbuf, i, size
+                        * options.degree), counts, displs, MPI_CHAR,
+                    cycle_buffer(recvbuf, i, size * options.degree), counts,
+                    displs, MPI_CHAR, comm);
+            t_stop = MPI_Wtime();
+            counters_stop();
+
+            if (i >= options.skip) {
+                timer+=t_stop-t_start;
+            }
+            finish_iteration(i >= options.skip, t_start, t_stop);
+        }
+        latency = (double)(timer * 1e6) / options.iterations;
+
+        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                MPI_COMM_WORLD);
+        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                MPI_COMM_WORLD);
+        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD);
+        avg_time = avg_time/numprocs;
+
+        if (options.global_sync) {
+            get_completion_stats(&avg_time, &min_time, &max_time);
+        }
+
+        counters_reduce(options.iterations, MPI_COMM_WORLD);
+
+        pvars_end(MPI_COMM_WORLD);
+        print_stats(rank, size, avg_time, min_time, max_time);
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+
+    free(counts);
+    free(displs);
+    free_buffer(sendbuf, options.accel);
+    free_buffer(recvbuf, options.accel);
+    free_neighborhood(&comm);
+
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -18,6 +18,7 @@ int main(int argc, char *argv[])
     double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
     float *sendbuf, *recvbuf;
     int po_ret;
+    MPI_Comm comm;
     size_t bufsize;
 
     set_header(HEADER);
@@ -72,56 +73,76 @@ int main(int argc, char *argv[])
     }
 
     bufsize = sizeof(float)*(options.max_message_size/sizeof(float));
-    if (allocate_buffer((void**)&recvbuf, bufsize,
+    if (allocate_buffer((void**)&recvbuf, bufsize + buffer_pool_size(),
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    set_buffer(recvbuf, options.accel, 1, bufsize);
+    set_buffer(recvbuf, options.accel, 1, bufsize + buffer_pool_size());
 
     bufsize = sizeof(float)*(options.max_message_size/sizeof(float));
-    if (allocate_buffer((void**)&sendbuf, bufsize,
+    if (allocate_buffer((void**)&sendbuf, bufsize + buffer_pool_size(),
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    set_buffer(sendbuf, options.accel, 0, bufsize);
+    set_buffer(sendbuf, options.accel, 0, bufsize + buffer_pool_size());
 
     print_preamble(rank);
 
-    for(size=options.min_message_size; size*sizeof(float) <= options.max_message_size; size *= 2) {
+    while (next_algorithm(&comm)) {
+        for(size=first_count(options.min_message_size,
+                    options.max_message_size, sizeof(float));
+                size*sizeof(float) <= options.max_message_size;
+                size = next_count(size, options.max_message_size,
+                    sizeof(float))) {
 
-        if(size > LARGE_MESSAGE_SIZE) {
-            options.skip = options.skip_large;
-            options.iterations = options.iterations_large;
-        }
+            if(size > LARGE_MESSAGE_SIZE) {
+                options.skip = options.skip_large;
+                options.iterations = options.iterations_large;
+            }
 
-        MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Barrier(MPI_COMM_WORLD);
 
-        timer=0.0;
-        for(i=0; i < options.iterations + options.skip ; i++) {
-            t_start = MPI_Wtime();
+            timer=0.0;
+            schedule_iterations();
+            pvars_begin();
+            for(i=0; i < options.iterations + options.skip ; i++) {
+                if(i == options.skip) counters_reset();
+                if(i >= options.skip) counters_start();
+                t_start = MPI_Wtime();
+
+                MPI_Reduce(cycle_buffer(sendbuf, i, size * sizeof(float)),
+                        cycle_buffer(recvbuf, i, size * sizeof(float)), size,
+                        MPI_FLOAT, MPI_SUM, 0, comm);
+                t_stop=MPI_Wtime();
+                counters_stop();
+                if(i>=options.skip){
+
+                timer+=t_stop-t_start;
+                }
+                finish_iteration(i >= options.skip, t_start, t_stop);
+            }
+            latency = (double)(timer * 1e6) / options.iterations;
+
+            MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD);
+            avg_time = avg_time/numprocs;
+
+            if (options.global_sync) {
+                get_completion_stats(&avg_time, &min_time, &max_time);
+            }
 
-            MPI_Reduce(sendbuf, recvbuf, size, MPI_FLOAT, MPI_SUM, 0, MPI_COMM_WORLD );
-            t_stop=MPI_Wtime();
-            if(i>=options.skip){
+            counters_reduce(options.iterations, MPI_COMM_WORLD);
 
-            timer+=t_stop-t_start;
-            }
+            pvars_end(MPI_COMM_WORLD);
+            print_stats(rank, size * sizeof(float), avg_time, min_time, max_time);
             MPI_Barrier(MPI_COMM_WORLD);
         }
-        latency = (double)(timer * 1e6) / options.iterations;
-
-        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                MPI_COMM_WORLD);
-        avg_time = avg_time/numprocs;
-
-        print_stats(rank, size * sizeof(float), avg_time, min_time, max_time);
-        MPI_Barrier(MPI_COMM_WORLD);
     }
 
     free_buffer(recvbuf, options.accel);
@@ -19,6 +19,7 @@ int main(int argc, char *argv[])
     char *sendbuf, *recvbuf;
     int *sdispls=NULL, *sendcounts=NULL;
     int po_ret;
+    MPI_Comm comm;
     size_t bufsize;
 
     set_header(HEADER);
@@ -68,83 +69,102 @@ int main(int argc, char *argv[])
     }
 
     if (0 == rank) {
-        if (allocate_buffer((void**)&sendcounts, numprocs*sizeof(int), none)) {
+        if (NULL == (sendcounts = malloc(numprocs*sizeof(int)))) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
-        if (allocate_buffer((void**)&sdispls, numprocs*sizeof(int), none)) {
+        if (NULL == (sdispls = malloc(numprocs*sizeof(int)))) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
 
         bufsize = options.max_message_size * numprocs;
-        if (allocate_buffer((void**)&sendbuf, bufsize, options.accel)) {
+        if (allocate_buffer((void**)&sendbuf, bufsize + buffer_pool_size(),
+                    options.accel)) {
             fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
             MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
         }
-        set_buffer(sendbuf, options.accel, 1, bufsize);
+        set_buffer(sendbuf, options.accel, 1, bufsize + buffer_pool_size());
     }
 
-    if (allocate_buffer((void**)&recvbuf, options.max_message_size,
+    if (allocate_buffer((void**)&recvbuf, options.max_message_size
+                + buffer_pool_size(),
                 options.accel)) {
         fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
         MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
     }
-    set_buffer(recvbuf, options.accel, 0, options.max_message_size);
+    set_buffer(recvbuf, options.accel, 0, options.max_message_size + buffer_pool_size());
 
     print_preamble(rank);
 
-    for(size=options.min_message_size; size <= options.max_message_size; size *= 2) {
+    while (next_algorithm(&comm)) {
+        for(size=first_size(options.min_message_size, options.max_message_size);
+                size <= options.max_message_size;
+                size = next_size(size, options.max_message_size)) {
 
-        if(size > LARGE_MESSAGE_SIZE) {
-            options.skip = options.skip_large;
-            options.iterations = options.iterations_large;
-        }
+            if(size > LARGE_MESSAGE_SIZE) {
+                options.skip = options.skip_large;
+                options.iterations = options.iterations_large;
+            }
 
-        MPI_Barrier(MPI_COMM_WORLD);
+            MPI_Barrier(MPI_COMM_WORLD);
 
-        if (0 == rank) {
-            disp =0;
-            for ( i = 0; i < numprocs; i++) {
-                sendcounts[i] = size;
-                sdispls[i] = disp;
-                disp += size;
+            if (0 == rank) {
+                disp =0;
+                for ( i = 0; i < numprocs; i++) {
+                    sendcounts[i] = size;
+                    sdispls[i] = disp;
+                    disp += size;
+                }
             }
-        }
-
-        MPI_Barrier(MPI_COMM_WORLD);
 
-        timer=0.0;
+            MPI_Barrier(MPI_COMM_WORLD);
 
-        for(i=0; i < options.iterations + options.skip ; i++) {
+            timer=0.0;
+            schedule_iterations();
+            pvars_begin();
+
+            for(i=0; i < options.iterations + options.skip ; i++) {
+
+                if(i == options.skip) counters_reset();
+                if(i >= options.skip) counters_start();
+                t_start = MPI_Wtime();
+                MPI_Scatterv(cycle_buffer(sendbuf, i, size * numprocs), sendcounts,
+                        sdispls, MPI_CHAR, cycle_buffer(recvbuf, i, size), size,
+                        MPI_CHAR, 0, comm);
+
+                t_stop = MPI_Wtime();
+                counters_stop();
+                if(i >= options.skip) {
+                    timer+=t_stop-t_start;
+                }
+                finish_iteration(i >= options.skip, t_start, t_stop);
+            }
+            latency = (double)(timer * 1e6) / options.iterations;
+
+            MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD);
+            avg_time = avg_time/numprocs;
+
+            if (options.global_sync) {
+                get_completion_stats(&avg_time, &min_time, &max_time);
+            }
 
-            t_start = MPI_Wtime();
-            MPI_Scatterv(sendbuf, sendcounts, sdispls, MPI_CHAR, recvbuf,
-                      size, MPI_CHAR, 0, MPI_COMM_WORLD);
+            counters_reduce(options.iterations, MPI_COMM_WORLD);
 
-            t_stop = MPI_Wtime();
-            if(i >= options.skip) {
-                timer+=t_stop-t_start;
-            }
+            pvars_end(MPI_COMM_WORLD);
+            print_stats(rank, size, avg_time, min_time, max_time);
             MPI_Barrier(MPI_COMM_WORLD);
         }
-        latency = (double)(timer * 1e6) / options.iterations;
-
-        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
-                MPI_COMM_WORLD);
-        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
-                MPI_COMM_WORLD);
-        avg_time = avg_time/numprocs;
-
-        print_stats(rank, size, avg_time, min_time, max_time);
-        MPI_Barrier(MPI_COMM_WORLD);
     }
 
     if (0 == rank) {
-        free_buffer(sendcounts, none);
-        free_buffer(sdispls, none);
+        free(sendcounts);
+        free(sdispls);
         free_buffer(sendbuf, options.accel);
     }
     free_buffer(recvbuf, options.accel);
@@ -39,9 +39,20 @@ MPI_Aint disp_local;
 int mem_on_dev; 
 struct options_t options;
 
+static struct {
+    char const * message;
+    char const * optarg;
+    int opt;
+} bad_usage;
+
 void 
 usage (int options_type, char const * name) 
 {
+    if (bad_usage.message) {
+        fprintf(stderr, "%s [-%c %s]\n\n", bad_usage.message,
+                (char)bad_usage.opt, bad_usage.optarg);
+    }
+
     if (CUDA_ENABLED || OPENACC_ENABLED) {
         printf("Usage: %s [options] [RANK0 RANK1] \n", name);
         printf("RANK0 and RANK1 may be `D' or `H' which specifies whether\n"
@@ -86,12 +97,24 @@ usage (int options_type, char const * name)
     printf("  -x ITER       number of warmup iterations to skip before timing"
             "(default 100)\n");
     printf("  -i ITER       number of iterations for timing (default 10000)\n");
+    printf(SIZES_HELP_STRING);
+    printf(ALLOC_HELP_STRING);
+    printf(PVARS_HELP_STRING);
 
     printf("  -h            print this help message\n");
 
     fflush(stdout);
 }
 
+void
+warn_skipped_sizes (int rank, size_t max)
+{
+    if (0 == rank && sizes_skipped(max)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %lu "
+                "bytes\n", sizes_skipped(max), (unsigned long)max);
+    }
+}
+
 int
 init_accel (void)
 {
@@ -209,9 +232,9 @@ process_options(int argc, char *argv[], WINDOW *win, SYNC *sync, int options_typ
     }
 
 #if MPI_VERSION >= 3
-    char const * optstring = (CUDA_ENABLED || OPENACC_ENABLED) ? "+d:w:s:h:x:i:" : "+w:s:h:x:i:";
+    char const * optstring = (CUDA_ENABLED || OPENACC_ENABLED) ? "+d:w:s:h:x:i:S:a:T:" : "+w:s:h:x:i:S:a:T:";
 #else
-    char const * optstring = (CUDA_ENABLED || OPENACC_ENABLED) ? "+d:s:h:x:i:" : "+s:h:x:i:";
+    char const * optstring = (CUDA_ENABLED || OPENACC_ENABLED) ? "+d:s:h:x:i:S:a:T:" : "+s:h:x:i:S:a:T:";
 #endif
 
     while((c = getopt(argc, argv, optstring)) != -1) {
@@ -222,6 +245,33 @@ process_options(int argc, char *argv[], WINDOW *win, SYNC *sync, int options_typ
             case 'i':                                
                 options.loop = atoi(optarg);
                 break;
+            case 'S':
+                if (set_sizes(optarg)) {
+                    bad_usage.message = "Invalid Message Sizes";
+                    bad_usage.optarg = optarg;
+                    bad_usage.opt = c;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'a':
+                if (set_allocator(optarg)) {
+                    bad_usage.message = "Invalid Allocator";
+                    bad_usage.optarg = optarg;
+                    bad_usage.opt = c;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'T':
+                if (set_pvars(optarg)) {
+                    bad_usage.message = "Invalid MPI_T Variables";
+                    bad_usage.optarg = optarg;
+                    bad_usage.opt = c;
+
+                    return po_bad_usage;
+                }
+                break;
             case 'd':
                 /* optarg should contain cuda or openacc */
                 if (0 == strncasecmp(optarg, "cuda", 10)) {
@@ -327,6 +377,16 @@ process_options(int argc, char *argv[], WINDOW *win, SYNC *sync, int options_typ
 #endif
     }
 
+#if MPI_VERSION >= 3
+    /*
+     * MPI_Win_allocate hands out its own memory, so expose the buffers from
+     * the selected allocator with MPI_Win_create instead.
+     */
+    if (allocator_selected() && *win == WIN_ALLOCATE) {
+        *win = WIN_CREATE;
+    }
+#endif
+
     return po_okay;
 }
 
@@ -387,6 +447,19 @@ free_device_buffer (void * buf)
     return 0;
 }
 
+int
+allocate_host_buffer (char ** buffer, int size)
+{
+    *buffer = osu_malloc(size);
+
+    if (NULL == *buffer) {
+        fprintf(stderr, "Could not allocate host memory\n");
+        return 1;
+    }
+
+    return 0;
+}
+
 void *
 align_buffer (void * ptr, unsigned long align_size)
 {
@@ -442,6 +515,12 @@ allocate_memory(int rank, char *sbuf_orig, char *rbuf_orig, char **sbuf, char **
          CHECK(allocate_device_buffer(rbuf, size));
          set_device_memory(*rbuf, 'b', size);
     }
+    else if (allocator_selected()) {
+         CHECK(allocate_host_buffer(sbuf, size));
+         memset(*sbuf, 'a', size);
+         CHECK(allocate_host_buffer(rbuf, size));
+         memset(*rbuf, 'b', size);
+    }
     else {
          *sbuf = (char *)align_buffer((void *)sbuf_orig, page_size);
          memset(*sbuf, 'a', size);
@@ -480,6 +559,8 @@ allocate_memory(int rank, char *sbuf_orig, char *rbuf_orig, char **sbuf, char **
 #else
     MPI_CHECK(MPI_Win_create(*win_base, size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, win));
 #endif
+
+    pvars_begin();
 }
 
 void 
@@ -510,6 +591,18 @@ allocate_atomic_memory(int rank, char *sbuf_orig, char *rbuf_orig, char *tbuf_or
              set_device_memory(*cbuf, 'a', size);
          }
     }
+    else if (allocator_selected()) {
+         CHECK(allocate_host_buffer(sbuf, size));
+         memset(*sbuf, 'a', size);
+         CHECK(allocate_host_buffer(rbuf, size));
+         memset(*rbuf, 'b', size);
+         CHECK(allocate_host_buffer(tbuf, size));
+         memset(*tbuf, 'c', size);
+         if (cbuf != NULL) {
+             CHECK(allocate_host_buffer(cbuf, size));
+             memset(*cbuf, 'a', size);
+         }
+    }
     else {
          *sbuf = (char *)align_buffer((void *)sbuf_orig, page_size);
          memset(*sbuf, 'a', size);
@@ -554,6 +647,8 @@ allocate_atomic_memory(int rank, char *sbuf_orig, char *rbuf_orig, char *tbuf_or
 #else
     MPI_CHECK(MPI_Win_create(*win_base, size, 1, MPI_INFO_NULL, MPI_COMM_WORLD, win));
 #endif
+
+    pvars_begin();
 }
 
 void 
@@ -570,6 +665,12 @@ free_atomic_memory (void *sbuf, void *rbuf, void *tbuf, void *cbuf, MPI_Win win,
                 if (cbuf != NULL)
                     free_device_buffer(cbuf);
             }
+            else if (allocator_selected()) {
+                osu_free(sbuf);
+                osu_free(rbuf);
+                osu_free(tbuf);
+                osu_free(cbuf);
+            }
             break;
         case 1:
             if ('D' == options.rank1) {
@@ -579,6 +680,12 @@ free_atomic_memory (void *sbuf, void *rbuf, void *tbuf, void *cbuf, MPI_Win win,
                 if (cbuf != NULL)
                     free_device_buffer(cbuf);
             }
+            else if (allocator_selected()) {
+                osu_free(sbuf);
+                osu_free(rbuf);
+                osu_free(tbuf);
+                osu_free(cbuf);
+            }
             break;
     }
 }
@@ -594,12 +701,20 @@ free_memory (void *sbuf, void *rbuf, MPI_Win win, int rank)
                 free_device_buffer(sbuf);
                 free_device_buffer(rbuf);
             }
+            else if (allocator_selected()) {
+                osu_free(sbuf);
+                osu_free(rbuf);
+            }
             break;
         case 1:
             if ('D' == options.rank1) {
                 free_device_buffer(sbuf);
                 free_device_buffer(rbuf);
             }
+            else if (allocator_selected()) {
+                osu_free(sbuf);
+                osu_free(rbuf);
+            }
             break;
     }
 }
@@ -16,6 +16,10 @@
 #include <assert.h>
 #include <getopt.h>
 
+#include "osu_alloc.h"
+#include "osu_pvars.h"
+#include "osu_sizes.h"
+
 #ifdef _ENABLE_OPENACC_
 #include <openacc.h>
 #endif
@@ -135,6 +139,7 @@ extern MPI_Aint disp_local;
 
 /*function declarations*/
 void usage (int, char const *);
+void warn_skipped_sizes (int, size_t);
 int  process_options (int, char **, WINDOW*, SYNC*, int);
 void allocate_memory(int, char *, char *, char **, char **,
             char **win_base, int, WINDOW, MPI_Win *);
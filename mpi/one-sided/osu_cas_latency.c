@@ -132,6 +132,8 @@ int main (int argc, char *argv[])
 
 void print_header (int rank, WINDOW win, SYNC sync)
 {
+    pvars_init(MPI_COMM_WORLD);
+
     if(rank == 0) {
         switch (options.accel) {
             case cuda:
@@ -150,6 +152,11 @@ void print_header (int rank, WINDOW win, SYNC sync)
         fprintf(stdout, "# Synchronization: %s\n",
                 sync_info[sync]);
 
+        if (pvars_count()) {
+            fprintf(stdout, "# MPI_T variables are combined over both ranks "
+                    "for every message size\n");
+        }
+
         switch (options.accel) {
             case cuda:
             case openacc:
@@ -157,7 +164,9 @@ void print_header (int rank, WINDOW win, SYNC sync)
                         'D' == options.rank0 ? "DEVICE (D)" : "HOST (H)",
                         'D' == options.rank1 ? "DEVICE (D)" : "HOST (H)");
             default:
-                fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+                fprintf(stdout, "%-*s%*s", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+                pvars_print_labels(stdout);
+                fprintf(stdout, "\n");
                 fflush(stdout);
         }
     }
@@ -165,9 +174,13 @@ void print_header (int rank, WINDOW win, SYNC sync)
 
 void print_latency(int rank, int size)
 {
+    pvars_end(MPI_COMM_WORLD);
+
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
+        fprintf(stdout, "%-*d%*.*f", 10, size, FIELD_WIDTH,
                 FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.loop);
+        pvars_print_values(stdout);
+        fprintf(stdout, "\n");
         fflush(stdout);
     }
 }
@@ -357,9 +370,13 @@ void run_cas_with_fence(int rank, WINDOW type)
 
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
+    pvars_end(MPI_COMM_WORLD);
+
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, 8, FIELD_WIDTH,
+        fprintf(stdout, "%-*d%*.*f", 10, 8, FIELD_WIDTH,
                 FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.loop / 2);
+        pvars_print_values(stdout);
+        fprintf(stdout, "\n");
         fflush(stdout);
     }
 
@@ -423,9 +440,13 @@ void run_cas_with_pscw(int rank, WINDOW type)
 
     MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
+    pvars_end(MPI_COMM_WORLD);
+
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, 8, FIELD_WIDTH,
+        fprintf(stdout, "%-*d%*.*f", 10, 8, FIELD_WIDTH,
                 FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.loop / 2);
+        pvars_print_values(stdout);
+        fprintf(stdout, "\n");
         fflush(stdout);
     }
 
@@ -17,6 +17,8 @@
 #include <assert.h>
 #include <getopt.h>
 
+#include "osu_sizes.h"
+
 #define MAX_ALIGNMENT 65536
 #define MAX_SIZE (1<<22)
 #define MYBUFSIZE (MAX_SIZE + MAX_ALIGNMENT)
@@ -199,6 +201,7 @@ void print_help_message (int rank)
     printf("  -x ITER       number of warmup iterations to skip before timing"
             "(default 100)\n");
     printf("  -i ITER       number of iterations for timing (default 10000)\n");
+    printf(SIZES_HELP_STRING);
     printf("\n");
     printf("win_option:\n");
     printf("  create            use MPI_Win_create to create an MPI Window object\n");
@@ -225,7 +228,7 @@ int process_options(int argc, char *argv[], WINDOW *win, SYNC *sync, int rank)
     extern int opterr;
     int c;
 
-    char const * optstring = "+w:s:h:x:i:";
+    char const * optstring = "+w:s:h:x:i:S:";
 
     if (rank) {
         opterr = 0;
@@ -239,6 +242,11 @@ int process_options(int argc, char *argv[], WINDOW *win, SYNC *sync, int rank)
             case 'i':
                 loop = atoi(optarg);
                 break;
+            case 'S':
+                if (set_sizes(optarg)) {
+                    return po_bad_usage;
+                }
+                break;
             case 'w':
                 if (0 == strcasecmp(optarg, "create")) {
                     *win = WIN_CREATE;
@@ -314,6 +322,11 @@ void allocate_memory(int rank, char *rbuf, int size, WINDOW type, MPI_Win *win)
 
 void print_header (int rank, WINDOW win, SYNC sync)
 {
+    if(rank == 0 && sizes_skipped(MAX_SIZE)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped(MAX_SIZE), MAX_SIZE);
+    }
+
     if(rank == 0) {
         fprintf(stdout, HEADER);
         fprintf(stdout, "# Window creation: %s\n",
@@ -341,7 +354,8 @@ void run_get_acc_with_flush(int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : size + 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -382,7 +396,8 @@ void run_get_acc_with_flush_local(int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : size + 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -423,7 +438,8 @@ void run_get_acc_with_lock_all(int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : size + 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -463,7 +479,8 @@ void run_get_acc_with_lock(int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : size + 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -503,7 +520,8 @@ void run_get_acc_with_fence(int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : size + 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -561,7 +579,8 @@ void run_get_acc_with_pscw(int rank, WINDOW type)
     MPI_Group       comm_group, group;
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -147,6 +147,9 @@ int main (int argc, char *argv[])
 
 void print_header (int rank, WINDOW win, SYNC sync)
 {
+    pvars_init(MPI_COMM_WORLD);
+    warn_skipped_sizes(rank, MAX_SIZE);
+
     if(rank == 0) {
         switch (options.accel) {
             case cuda:
@@ -165,6 +168,11 @@ void print_header (int rank, WINDOW win, SYNC sync)
         fprintf(stdout, "# Synchronization: %s\n",
                 sync_info[sync]);
 
+        if (pvars_count()) {
+            fprintf(stdout, "# MPI_T variables are combined over both ranks "
+                    "for every message size\n");
+        }
+
         switch (options.accel) {
             case cuda:
             case openacc:
@@ -172,7 +180,9 @@ void print_header (int rank, WINDOW win, SYNC sync)
                         'D' == options.rank0 ? "DEVICE (D)" : "HOST (H)",
                         'D' == options.rank1 ? "DEVICE (D)" : "HOST (H)");
             default:
-                fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Bandwidth (MB/s)");
+                fprintf(stdout, "%-*s%*s", 10, "# Size", FIELD_WIDTH, "Bandwidth (MB/s)");
+                pvars_print_labels(stdout);
+                fprintf(stdout, "\n");
                 fflush(stdout);
         }
     }
@@ -180,11 +190,15 @@ void print_header (int rank, WINDOW win, SYNC sync)
 
 void print_bw(int rank, int size, double t)
 {
+    pvars_end(MPI_COMM_WORLD);
+
     if (rank == 0) {
         double tmp = size / 1e6 * options.loop * WINDOW_SIZE_LARGE;
 
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
+        fprintf(stdout, "%-*d%*.*f", 10, size, FIELD_WIDTH,
                 FLOAT_PRECISION, tmp / t);
+        pvars_print_values(stdout);
+        fprintf(stdout, "\n");
         fflush(stdout);
     }
 }
@@ -199,7 +213,8 @@ void run_get_with_flush_local (int rank, WINDOW type)
     MPI_Win     win;
 
     int window_size = WINDOW_SIZE_LARGE;
-    for (size = 1; size <= MAX_SIZE; size = size * 2) {
+    for (size = first_size(1, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &sbuf, size*window_size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -231,7 +246,7 @@ void run_get_with_flush_local (int rank, WINDOW type)
 
         print_bw(rank, size, t);
 
-        MPI_Win_free(&win);
+        free_memory (sbuf, rbuf, win, rank);
     }
 }
 
@@ -244,7 +259,8 @@ void run_get_with_flush (int rank, WINDOW type)
     MPI_Win     win;
 
     int window_size = WINDOW_SIZE_LARGE;
-    for (size = 1; size <= MAX_SIZE; size = size * 2) {
+    for (size = first_size(1, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &sbuf, size*window_size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -277,7 +293,7 @@ void run_get_with_flush (int rank, WINDOW type)
 
         print_bw(rank, size, t);
 
-        MPI_Win_free(&win);
+        free_memory (sbuf, rbuf, win, rank);
     }
 }
 
@@ -290,7 +306,8 @@ void run_get_with_lock_all (int rank, WINDOW type)
     MPI_Win     win;
 
     int window_size = WINDOW_SIZE_LARGE;
-    for (size = 1; size <= MAX_SIZE; size = size * 2) {
+    for (size = first_size(1, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &sbuf, size*window_size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -321,7 +338,7 @@ void run_get_with_lock_all (int rank, WINDOW type)
 
         print_bw(rank, size, t);
 
-        MPI_Win_free(&win);
+        free_memory (sbuf, rbuf, win, rank);
     }
 }
 #endif
@@ -335,7 +352,8 @@ void run_get_with_lock(int rank, WINDOW type)
     MPI_Win     win;
 
     int window_size = WINDOW_SIZE_LARGE;
-    for (size = 1; size <= MAX_SIZE; size = size * 2) {
+    for (size = first_size(1, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &sbuf, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -368,7 +386,7 @@ void run_get_with_lock(int rank, WINDOW type)
 
         print_bw(rank, size, t);
 
-        MPI_Win_free(&win);
+        free_memory (sbuf, rbuf, win, rank);
     }
 }
 
@@ -381,7 +399,8 @@ void run_get_with_fence(int rank, WINDOW type)
     MPI_Win     win;
 
     int window_size = WINDOW_SIZE_LARGE;
-    for (size = 1; size <= MAX_SIZE; size = size * 2) {
+    for (size = first_size(1, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &sbuf, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -422,7 +441,7 @@ void run_get_with_fence(int rank, WINDOW type)
 
         print_bw(rank, size, t);
 
-        MPI_Win_free(&win);
+        free_memory (sbuf, rbuf, win, rank);
     }
 }
 
@@ -437,7 +456,8 @@ void run_get_with_pscw(int rank, WINDOW type)
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
     int window_size = WINDOW_SIZE_LARGE;
-    for (size = 1; size <= MAX_SIZE; size = (size ? size * 2 : 1)) {
+    for (size = first_size(1, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &sbuf, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -486,7 +506,7 @@ void run_get_with_pscw(int rank, WINDOW type)
 
         MPI_CHECK(MPI_Group_free(&group));
 
-        MPI_Win_free(&win);
+        free_memory (sbuf, rbuf, win, rank);
     }
     MPI_CHECK(MPI_Group_free(&comm_group));
 }
@@ -125,6 +125,9 @@ int main (int argc, char *argv[])
 
 void print_header (int rank, WINDOW win, SYNC sync)
 {
+    pvars_init(MPI_COMM_WORLD);
+    warn_skipped_sizes(rank, MAX_SIZE);
+
     if(rank == 0) {
         switch (options.accel) {
             case cuda:
@@ -143,6 +146,11 @@ void print_header (int rank, WINDOW win, SYNC sync)
         fprintf(stdout, "# Synchronization: %s\n",
                 sync_info[sync]);
 
+        if (pvars_count()) {
+            fprintf(stdout, "# MPI_T variables are combined over both ranks "
+                    "for every message size\n");
+        }
+
         switch (options.accel) {
             case cuda:
             case openacc:
@@ -150,7 +158,9 @@ void print_header (int rank, WINDOW win, SYNC sync)
                         'D' == options.rank0 ? "DEVICE (D)" : "HOST (H)",
                         'D' == options.rank1 ? "DEVICE (D)" : "HOST (H)");
             default:
-                fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Bandwidth (MB/s)");
+                fprintf(stdout, "%-*s%*s", 10, "# Size", FIELD_WIDTH, "Bandwidth (MB/s)");
+                pvars_print_labels(stdout);
+                fprintf(stdout, "\n");
                 fflush(stdout);
         }
     }
@@ -158,11 +168,15 @@ void print_header (int rank, WINDOW win, SYNC sync)
 
 void print_bibw(int rank, int size, double t)
 {
+    pvars_end(MPI_COMM_WORLD);
+
     if (rank == 0) {
         double tmp = size / 1e6 * options.loop * WINDOW_SIZE_LARGE;
 
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
+        fprintf(stdout, "%-*d%*.*f", 10, size, FIELD_WIDTH,
                 FLOAT_PRECISION, (tmp / t) * 2);
+        pvars_print_values(stdout);
+        fprintf(stdout, "\n");
         fflush(stdout);
     }
 }
@@ -176,7 +190,8 @@ void run_put_with_fence(int rank, WINDOW type)
     MPI_Win     win;
 
     int window_size = WINDOW_SIZE_LARGE;
-    for (size = 1; size <= MAX_SIZE; size = size * 2) {
+    for (size = first_size(1, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &rbuf, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -237,7 +252,8 @@ void run_put_with_pscw(int rank, WINDOW type)
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
     int window_size = WINDOW_SIZE_LARGE;
-    for (size = 1; size <= MAX_SIZE; size = size * 2) {
+    for (size = first_size(1, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &rbuf, size*window_size, type, &win);
 
 #if MPI_VERSION >= 3
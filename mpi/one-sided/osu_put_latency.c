@@ -144,6 +144,9 @@ int main (int argc, char *argv[])
 
 void print_header (int rank, WINDOW win, SYNC sync)
 {
+    pvars_init(MPI_COMM_WORLD);
+    warn_skipped_sizes(rank, MAX_SIZE);
+
     if(rank == 0) {
         switch (options.accel) {
             case cuda:
@@ -162,6 +165,11 @@ void print_header (int rank, WINDOW win, SYNC sync)
         fprintf(stdout, "# Synchronization: %s\n",
                sync_info[sync]);
 
+        if (pvars_count()) {
+            fprintf(stdout, "# MPI_T variables are combined over both ranks "
+                    "for every message size\n");
+        }
+
         switch (options.accel) {
             case cuda:
             case openacc:
@@ -169,7 +177,9 @@ void print_header (int rank, WINDOW win, SYNC sync)
                         'D' == options.rank0 ? "DEVICE (D)" : "HOST (H)",
                         'D' == options.rank1 ? "DEVICE (D)" : "HOST (H)");
             default:
-                printf("%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+                printf("%-*s%*s", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+                pvars_print_labels(stdout);
+                printf("\n");
                 fflush(stdout);
         }
     }
@@ -177,9 +187,13 @@ void print_header (int rank, WINDOW win, SYNC sync)
 
 void print_latency(int rank, int size)
 {
+    pvars_end(MPI_COMM_WORLD);
+
     if (rank == 0) {
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
+        fprintf(stdout, "%-*d%*.*f", 10, size, FIELD_WIDTH,
                 FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.loop);
+        pvars_print_values(stdout);
+        fprintf(stdout, "\n");
         fflush(stdout);
     }
 }
@@ -192,7 +206,8 @@ void run_put_with_flush_local (int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -232,7 +247,8 @@ void run_put_with_flush (int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -272,7 +288,8 @@ void run_put_with_lock_all (int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &rbuf, size, type, &win);
 
         if (type == WIN_DYNAMIC) {
@@ -312,7 +329,8 @@ void run_put_with_lock(int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &rbuf, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -353,7 +371,8 @@ void run_put_with_fence(int rank, WINDOW type)
     MPI_Aint disp = 0;
     MPI_Win     win;
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &rbuf, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -391,9 +410,13 @@ void run_put_with_fence(int rank, WINDOW type)
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
+        pvars_end(MPI_COMM_WORLD);
+
         if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
+            fprintf(stdout, "%-*d%*.*f", 10, size, FIELD_WIDTH,
                     FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.loop / 2);
+            pvars_print_values(stdout);
+            fprintf(stdout, "\n");
             fflush(stdout);
         }
 
@@ -411,7 +434,8 @@ void run_put_with_pscw(int rank, WINDOW type)
 
     MPI_CHECK(MPI_Comm_group(MPI_COMM_WORLD, &comm_group));
 
-    for (size = 0; size <= MAX_SIZE; size = (size ? size * 2 : 1)) {
+    for (size = first_size(0, MAX_SIZE); size <= MAX_SIZE;
+            size = next_size(size, MAX_SIZE)) {
         allocate_memory(rank, sbuf_original, rbuf_original, &sbuf, &rbuf, &rbuf, size, type, &win);
 
 #if MPI_VERSION >= 3
@@ -461,9 +485,13 @@ void run_put_with_pscw(int rank, WINDOW type)
 
         MPI_CHECK(MPI_Barrier(MPI_COMM_WORLD));
 
+        pvars_end(MPI_COMM_WORLD);
+
         if (rank == 0) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
+            fprintf(stdout, "%-*d%*.*f", 10, size, FIELD_WIDTH,
                     FLOAT_PRECISION, (t_end - t_start) * 1.0e6 / options.loop / 2);
+            pvars_print_values(stdout);
+            fprintf(stdout, "\n");
             fflush(stdout);
         }
 
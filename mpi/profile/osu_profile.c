@@ -0,0 +1,1578 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+/*
+ * Message profile through the MPI profiling interface.
+ *
+ * Preloading libosu_profile.so into an application counts the calls of the
+ * C point-to-point, collective and one-sided operations per call site,
+ * message size, communicator size and peer.  Every thread counts into a
+ * table of its own, so the wrappers take no locks.  MPI_Finalize combines
+ * the tables of all threads and merges those of all ranks along a binomial
+ * tree, and rank 0 writes them to
+ * $OSU_PROFILE_FILE (default osu_profile.txt), one line per combination,
+ * most frequent first:
+ *
+ *   size calls function comm_size peer site
+ *
+ * peer is the distance to the destination, source or target rank (+K),
+ * `any' for wildcard receives, `null' for MPI_PROC_NULL and `-' for
+ * collectives.  site is the object file and offset of the call, which
+ * addr2line turns into a source line.  The benchmarks read the first two
+ * columns as message sizes and their weights.
+ *
+ * Persistent requests are counted once per MPI_Start under the site of the
+ * call that created them.
+ */
+#define _GNU_SOURCE
+#include <mpi.h>
+#include <dlfcn.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef PACKAGE_VERSION
+#   define HEADER "# OSU MPI Message Profile v" PACKAGE_VERSION "\n"
+#else
+#   define HEADER "# OSU MPI Message Profile\n"
+#endif
+
+#define DEFAULT_PROFILE_FILE    "osu_profile.txt"
+#define TABLE_SIZE              4096
+#define MAX_PROBES              64
+#define MAX_SITE_LEN            96
+#define REQUEST_BUCKETS         256
+
+#define PEER_NONE   (-1)
+#define PEER_ANY    (-2)
+#define PEER_NULL   (-3)
+
+enum function {
+    f_send, f_bsend, f_ssend, f_rsend, f_isend, f_ibsend, f_issend, f_irsend,
+    f_recv, f_irecv, f_sendrecv,
+    f_barrier, f_bcast, f_reduce, f_allreduce, f_scan, f_exscan,
+    f_gather, f_gatherv, f_scatter, f_scatterv, f_allgather, f_allgatherv,
+    f_alltoall, f_alltoallv, f_reduce_scatter, f_reduce_scatter_block,
+    f_ibarrier, f_ibcast, f_ireduce, f_iallreduce, f_igather, f_iscatter,
+    f_iallgather, f_ialltoall, f_igatherv, f_iscatterv, f_iallgatherv,
+    f_ialltoallv, f_ireduce_scatter, f_ireduce_scatter_block,
+    f_send_init, f_bsend_init, f_ssend_init, f_rsend_init, f_recv_init,
+    f_neighbor_allgather, f_neighbor_allgatherv, f_neighbor_alltoall,
+    f_neighbor_alltoallv, f_neighbor_alltoallw, f_ineighbor_allgather,
+    f_ineighbor_allgatherv, f_ineighbor_alltoall, f_ineighbor_alltoallv,
+    f_ineighbor_alltoallw,
+    f_put, f_get, f_accumulate, f_get_accumulate, f_fetch_and_op,
+    f_compare_and_swap, f_rput, f_rget,
+    num_functions
+};
+
+static char const * const function_names[num_functions] = {
+    "MPI_Send", "MPI_Bsend", "MPI_Ssend", "MPI_Rsend", "MPI_Isend",
+    "MPI_Ibsend", "MPI_Issend", "MPI_Irsend",
+    "MPI_Recv", "MPI_Irecv", "MPI_Sendrecv",
+    "MPI_Barrier", "MPI_Bcast", "MPI_Reduce", "MPI_Allreduce", "MPI_Scan",
+    "MPI_Exscan",
+    "MPI_Gather", "MPI_Gatherv", "MPI_Scatter", "MPI_Scatterv",
+    "MPI_Allgather", "MPI_Allgatherv",
+    "MPI_Alltoall", "MPI_Alltoallv", "MPI_Reduce_scatter",
+    "MPI_Reduce_scatter_block",
+    "MPI_Ibarrier", "MPI_Ibcast", "MPI_Ireduce", "MPI_Iallreduce",
+    "MPI_Igather", "MPI_Iscatter", "MPI_Iallgather", "MPI_Ialltoall",
+    "MPI_Igatherv", "MPI_Iscatterv", "MPI_Iallgatherv", "MPI_Ialltoallv",
+    "MPI_Ireduce_scatter", "MPI_Ireduce_scatter_block",
+    "MPI_Send_init", "MPI_Bsend_init", "MPI_Ssend_init", "MPI_Rsend_init",
+    "MPI_Recv_init",
+    "MPI_Neighbor_allgather", "MPI_Neighbor_allgatherv",
+    "MPI_Neighbor_alltoall", "MPI_Neighbor_alltoallv",
+    "MPI_Neighbor_alltoallw", "MPI_Ineighbor_allgather",
+    "MPI_Ineighbor_allgatherv", "MPI_Ineighbor_alltoall",
+    "MPI_Ineighbor_alltoallv", "MPI_Ineighbor_alltoallw",
+    "MPI_Put", "MPI_Get", "MPI_Accumulate", "MPI_Get_accumulate",
+    "MPI_Fetch_and_op", "MPI_Compare_and_swap", "MPI_Rput", "MPI_Rget",
+};
+
+struct entry {
+    void * site;
+    long long size;
+    int function;
+    int comm_size;
+    int peer;
+    unsigned long calls;
+};
+
+/* a persistent request and what its starts are recorded as */
+struct persistent {
+    MPI_Request request;
+    void * site;
+    long long size;
+    int function;
+    int comm_size;
+    int peer;
+    struct persistent * next;
+};
+
+struct table {
+    struct entry entries[TABLE_SIZE];
+    struct persistent * requests[REQUEST_BUCKETS];
+    struct table * next;
+};
+
+/* a record as exchanged between the ranks */
+struct record {
+    char site[MAX_SITE_LEN];
+    long long size;
+    int function;
+    int comm_size;
+    int peer;
+    double calls;
+};
+
+static __thread struct table * thread_table = NULL;
+static struct table * tables = NULL;
+static unsigned long dropped = 0;
+static int win_keyval = MPI_KEYVAL_INVALID;
+
+/*
+ * Allocates the table of the calling thread and pushes it onto the list of
+ * all tables.
+ */
+static struct table *
+new_table (void)
+{
+    struct table * table = calloc(1, sizeof(struct table));
+
+    if (NULL == table) {
+        return NULL;
+    }
+
+    do {
+        table->next = tables;
+    } while (!__sync_bool_compare_and_swap(&tables, table->next, table));
+
+    return thread_table = table;
+}
+
+static void
+record (enum function function, void * site, long long size, int comm_size,
+        int peer)
+{
+    struct table * table = thread_table ? thread_table : new_table();
+    uintptr_t hash;
+    int i;
+
+    if (NULL == table) {
+        __sync_fetch_and_add(&dropped, 1);
+        return;
+    }
+
+    hash = (uintptr_t)site * 31 + size * 17 + function * 7 + comm_size * 3
+        + peer;
+    hash ^= hash >> 16;
+
+    for (i = 0; i < MAX_PROBES; i++) {
+        struct entry * entry = &table->entries[(hash + i) % TABLE_SIZE];
+
+        if (0 == entry->calls) {
+            entry->site = site;
+            entry->size = size;
+            entry->function = function;
+            entry->comm_size = comm_size;
+            entry->peer = peer;
+            entry->calls = 1;
+            return;
+        }
+
+        if (entry->site == site && entry->size == size
+                && entry->function == (int)function
+                && entry->comm_size == comm_size && entry->peer == peer) {
+            entry->calls++;
+            return;
+        }
+    }
+
+    __sync_fetch_and_add(&dropped, 1);
+}
+
+static long long
+bytes (int count, MPI_Datatype datatype)
+{
+    int size;
+
+    PMPI_Type_size(datatype, &size);
+
+    return (long long)count * size;
+}
+
+static int
+comm_size (MPI_Comm comm)
+{
+    int size;
+
+    PMPI_Comm_size(comm, &size);
+
+    return size;
+}
+
+/*
+ * Returns the distance from the own rank to peer in comm.
+ */
+static int
+distance (MPI_Comm comm, int peer)
+{
+    int rank, size;
+
+    if (MPI_ANY_SOURCE == peer) {
+        return PEER_ANY;
+    }
+
+    if (MPI_PROC_NULL == peer) {
+        return PEER_NULL;
+    }
+
+    PMPI_Comm_rank(comm, &rank);
+    PMPI_Comm_size(comm, &size);
+
+    return ((peer - rank) % size + size) % size;
+}
+
+static void
+record_pt2pt (enum function function, void * site, int count,
+        MPI_Datatype datatype, int peer, MPI_Comm comm)
+{
+    record(function, site, bytes(count, datatype), comm_size(comm),
+            distance(comm, peer));
+}
+
+static void
+record_coll (enum function function, void * site, long long size,
+        MPI_Comm comm)
+{
+    record(function, site, size, comm_size(comm), PEER_NONE);
+}
+
+/*
+ * The number of neighbors a rank sends to in a neighborhood collective.
+ */
+static int
+out_degree (MPI_Comm comm)
+{
+    int topology, rank, indegree, outdegree, weighted;
+
+    PMPI_Topo_test(comm, &topology);
+
+    switch (topology) {
+        case MPI_CART:
+            PMPI_Cartdim_get(comm, &outdegree);
+            return 2 * outdegree;
+        case MPI_GRAPH:
+            PMPI_Comm_rank(comm, &rank);
+            PMPI_Graph_neighbors_count(comm, rank, &outdegree);
+            return outdegree;
+        case MPI_DIST_GRAPH:
+            PMPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree,
+                    &weighted);
+            return outdegree;
+        default:
+            return 0;
+    }
+}
+
+/*
+ * Returns the average of counts[0..n) elements of datatype in bytes.
+ */
+static long long
+average_bytes (int const * counts, int n, MPI_Datatype datatype)
+{
+    long long total = 0;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        total += counts[i];
+    }
+
+    return n ? bytes(1, datatype) * total / n : 0;
+}
+
+/* the same for a datatype per element count */
+static long long
+average_bytes_w (int const * counts, int n, MPI_Datatype const * datatypes)
+{
+    long long total = 0;
+    int i;
+
+    for (i = 0; i < n; i++) {
+        total += bytes(counts[i], datatypes[i]);
+    }
+
+    return n ? total / n : 0;
+}
+
+/*
+ * Persistent requests are kept in the table of the thread that created
+ * them, so that their starts are recorded without locks.  Starts from
+ * another thread are counted as not recorded.
+ */
+static unsigned
+request_bucket (MPI_Request request)
+{
+    uintptr_t key = 0;
+
+    memcpy(&key, &request, sizeof(request) < sizeof(key) ? sizeof(request)
+            : sizeof(key));
+
+    return (key ^ key >> 8 ^ key >> 16) % REQUEST_BUCKETS;
+}
+
+static struct persistent **
+find_persistent (MPI_Request request)
+{
+    struct persistent ** p;
+
+    if (NULL == thread_table) {
+        return NULL;
+    }
+
+    for (p = &thread_table->requests[request_bucket(request)]; *p;
+            p = &(*p)->next) {
+        if (0 == memcmp(&(*p)->request, &request, sizeof(request))) {
+            return p;
+        }
+    }
+
+    return NULL;
+}
+
+static void
+record_persistent (enum function function, void * site, int count,
+        MPI_Datatype datatype, int peer, MPI_Comm comm, MPI_Request request)
+{
+    struct table * table = thread_table ? thread_table : new_table();
+    struct persistent * p;
+    unsigned bucket;
+
+    if (NULL == table || NULL == (p = malloc(sizeof(struct persistent)))) {
+        return;
+    }
+
+    bucket = request_bucket(request);
+    p->request = request;
+    p->site = site;
+    p->size = bytes(count, datatype);
+    p->function = function;
+    p->comm_size = comm_size(comm);
+    p->peer = distance(comm, peer);
+    p->next = table->requests[bucket];
+    table->requests[bucket] = p;
+}
+
+static void
+record_start (MPI_Request request)
+{
+    struct persistent ** p = find_persistent(request);
+
+    if (NULL == p) {
+        __sync_fetch_and_add(&dropped, 1);
+        return;
+    }
+
+    record((*p)->function, (*p)->site, (*p)->size, (*p)->comm_size,
+            (*p)->peer);
+}
+
+static void
+forget_persistent (MPI_Request request)
+{
+    struct persistent ** p = find_persistent(request), * next;
+
+    if (p) {
+        next = (*p)->next;
+        free(*p);
+        *p = next;
+    }
+}
+
+/*
+ * The rank and size of a window are kept in an attribute set when the
+ * window is created.
+ */
+static int
+delete_window_info (MPI_Win win, int keyval, void * value, void * state)
+{
+    free(value);
+
+    return MPI_SUCCESS;
+}
+
+static void
+attach_window_info (MPI_Win win)
+{
+    MPI_Group group;
+    int * info;
+
+    if (MPI_KEYVAL_INVALID == win_keyval
+            || NULL == (info = malloc(2 * sizeof(int)))) {
+        return;
+    }
+
+    PMPI_Win_get_group(win, &group);
+    PMPI_Group_rank(group, &info[0]);
+    PMPI_Group_size(group, &info[1]);
+    PMPI_Group_free(&group);
+    PMPI_Win_set_attr(win, win_keyval, info);
+}
+
+static void
+record_rma (enum function function, void * site, int count,
+        MPI_Datatype datatype, int target, MPI_Win win)
+{
+    int * info, flag = 0, size = 0, peer = PEER_NONE;
+
+    if (MPI_KEYVAL_INVALID != win_keyval) {
+        PMPI_Win_get_attr(win, win_keyval, &info, &flag);
+    }
+
+    if (flag) {
+        size = info[1];
+        peer = MPI_PROC_NULL == target ? PEER_NULL
+            : ((target - info[0]) % size + size) % size;
+    }
+
+    record(function, site, bytes(count, datatype), size, peer);
+}
+
+/*
+ * Writes "object+offset" of the code address site to buffer.
+ */
+static void
+resolve_site (void * site, char * buffer)
+{
+    Dl_info info;
+    char const * name;
+
+    if (dladdr(site, &info) && info.dli_fname) {
+        name = strrchr(info.dli_fname, '/');
+        snprintf(buffer, MAX_SITE_LEN, "%s+0x%lx",
+                name ? name + 1 : info.dli_fname,
+                (unsigned long)((char *)site - (char *)info.dli_fbase));
+    }
+
+    else {
+        snprintf(buffer, MAX_SITE_LEN, "%p", site);
+    }
+}
+
+static int
+compare_keys (void const * a, void const * b)
+{
+    struct record const * x = a, * y = b;
+    int result = strcmp(x->site, y->site);
+
+    if (result) return result;
+    if (x->function != y->function) return x->function - y->function;
+    if (x->comm_size != y->comm_size) return x->comm_size - y->comm_size;
+    if (x->peer != y->peer) return x->peer - y->peer;
+
+    return (x->size > y->size) - (x->size < y->size);
+}
+
+static int
+compare_calls (void const * a, void const * b)
+{
+    struct record const * x = a, * y = b;
+
+    if (x->calls != y->calls) {
+        return x->calls < y->calls ? 1 : -1;
+    }
+
+    return compare_keys(a, b);
+}
+
+/*
+ * Sorts the records and adds up the calls of equal ones.  Returns the number
+ * of records left.
+ */
+static int
+merge_records (struct record * records, int n)
+{
+    int i, j = 0;
+
+    qsort(records, n, sizeof(struct record), compare_keys);
+
+    for (i = 1; i < n; i++) {
+        if (0 == compare_keys(&records[j], &records[i])) {
+            records[j].calls += records[i].calls;
+        }
+
+        else {
+            records[++j] = records[i];
+        }
+    }
+
+    return n ? j + 1 : 0;
+}
+
+/*
+ * Collects the records of all threads of this rank.
+ */
+static struct record *
+local_records (int * count)
+{
+    struct record * records;
+    struct table * table;
+    int n = 0, i;
+
+    for (table = tables; table; table = table->next) {
+        for (i = 0; i < TABLE_SIZE; i++) {
+            n += 0 != table->entries[i].calls;
+        }
+    }
+
+    if (NULL == (records = calloc(n ? n : 1, sizeof(struct record)))) {
+        *count = 0;
+        return NULL;
+    }
+
+    n = 0;
+
+    for (table = tables; table; table = table->next) {
+        for (i = 0; i < TABLE_SIZE; i++) {
+            struct entry const * entry = &table->entries[i];
+
+            if (entry->calls) {
+                resolve_site(entry->site, records[n].site);
+                records[n].size = entry->size;
+                records[n].function = entry->function;
+                records[n].comm_size = entry->comm_size;
+                records[n].peer = entry->peer;
+                records[n].calls = entry->calls;
+                n++;
+            }
+        }
+    }
+
+    *count = merge_records(records, n);
+
+    return records;
+}
+
+static void
+write_profile (struct record * records, int n, int numprocs,
+        double total_dropped)
+{
+    char const * filename = getenv("OSU_PROFILE_FILE");
+    char peer[16];
+    FILE * file;
+    int i;
+
+    if (NULL == filename || '\0' == filename[0]) {
+        filename = DEFAULT_PROFILE_FILE;
+    }
+
+    if (NULL == (file = fopen(filename, "w"))) {
+        fprintf(stderr, "Could not write message profile to `%s'\n",
+                filename);
+        return;
+    }
+
+    qsort(records, n, sizeof(struct record), compare_calls);
+
+    fprintf(file, HEADER);
+    fprintf(file, "# %d ranks", numprocs);
+
+    if (total_dropped > 0.0) {
+        fprintf(file, ", %.0f calls not recorded", total_dropped);
+    }
+
+    fprintf(file, "\n# size calls function comm_size peer site\n");
+
+    for (i = 0; i < n; i++) {
+        struct record const * r = &records[i];
+
+        if (PEER_NONE == r->peer) {
+            snprintf(peer, sizeof(peer), "-");
+        }
+
+        else if (PEER_ANY == r->peer) {
+            snprintf(peer, sizeof(peer), "any");
+        }
+
+        else if (PEER_NULL == r->peer) {
+            snprintf(peer, sizeof(peer), "null");
+        }
+
+        else {
+            snprintf(peer, sizeof(peer), "+%d", r->peer);
+        }
+
+        fprintf(file, "%lld %.0f %s %d %s %s\n", r->size, r->calls,
+                function_names[r->function], r->comm_size, peer, r->site);
+    }
+
+    fclose(file);
+}
+
+/*
+ * Merges the records of all ranks along a binomial tree, so that no rank
+ * holds more than the distinct records of its subtree, and writes the
+ * profile on rank 0.  Counts are in records rather than bytes.
+ */
+static void
+dump_profile (void)
+{
+    struct record * records, * merged;
+    MPI_Datatype record_type;
+    MPI_Status status;
+    MPI_Comm comm;
+    int rank, numprocs, n, m, step;
+    double lost = dropped, total_dropped = 0.0;
+
+    PMPI_Comm_dup(MPI_COMM_WORLD, &comm);
+    PMPI_Comm_rank(comm, &rank);
+    PMPI_Comm_size(comm, &numprocs);
+    PMPI_Type_contiguous(sizeof(struct record), MPI_BYTE, &record_type);
+    PMPI_Type_commit(&record_type);
+
+    records = local_records(&n);
+
+    for (step = 1; step < numprocs; step *= 2) {
+        if (rank & step) {
+            PMPI_Send(records, n, record_type, rank - step, 0, comm);
+            break;
+        }
+
+        if (rank + step >= numprocs) {
+            continue;
+        }
+
+        PMPI_Probe(rank + step, 0, comm, &status);
+        PMPI_Get_count(&status, record_type, &m);
+
+        merged = m > INT_MAX - n ? NULL : realloc(records,
+                ((size_t)n + m) * sizeof(struct record));
+
+        if (NULL == merged) {
+            fprintf(stderr, "Could not merge the message profile of %d "
+                    "records\n", m);
+            PMPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+
+        records = merged;
+        PMPI_Recv(records + n, m, record_type, rank + step, 0, comm,
+                MPI_STATUS_IGNORE);
+        n = merge_records(records, n + m);
+    }
+
+    PMPI_Reduce(&lost, &total_dropped, 1, MPI_DOUBLE, MPI_SUM, 0, comm);
+
+    if (0 == rank) {
+        write_profile(records, n, numprocs, total_dropped);
+    }
+
+    PMPI_Type_free(&record_type);
+    PMPI_Comm_free(&comm);
+    free(records);
+}
+
+/*
+ * Initialization and finalization
+ */
+static void
+init_profile (void)
+{
+    PMPI_Win_create_keyval(MPI_WIN_NULL_COPY_FN, delete_window_info,
+            &win_keyval, NULL);
+}
+
+int
+MPI_Init (int * argc, char *** argv)
+{
+    int result = PMPI_Init(argc, argv);
+
+    init_profile();
+
+    return result;
+}
+
+int
+MPI_Init_thread (int * argc, char *** argv, int required, int * provided)
+{
+    int result = PMPI_Init_thread(argc, argv, required, provided);
+
+    init_profile();
+
+    return result;
+}
+
+int
+MPI_Finalize (void)
+{
+    dump_profile();
+
+    if (MPI_KEYVAL_INVALID != win_keyval) {
+        PMPI_Win_free_keyval(&win_keyval);
+    }
+
+    return PMPI_Finalize();
+}
+
+/*
+ * Point-to-point operations
+ */
+#define SITE __builtin_return_address(0)
+
+int
+MPI_Send (const void * buf, int count, MPI_Datatype datatype, int dest,
+        int tag, MPI_Comm comm)
+{
+    record_pt2pt(f_send, SITE, count, datatype, dest, comm);
+
+    return PMPI_Send(buf, count, datatype, dest, tag, comm);
+}
+
+int
+MPI_Bsend (const void * buf, int count, MPI_Datatype datatype, int dest,
+        int tag, MPI_Comm comm)
+{
+    record_pt2pt(f_bsend, SITE, count, datatype, dest, comm);
+
+    return PMPI_Bsend(buf, count, datatype, dest, tag, comm);
+}
+
+int
+MPI_Ssend (const void * buf, int count, MPI_Datatype datatype, int dest,
+        int tag, MPI_Comm comm)
+{
+    record_pt2pt(f_ssend, SITE, count, datatype, dest, comm);
+
+    return PMPI_Ssend(buf, count, datatype, dest, tag, comm);
+}
+
+int
+MPI_Rsend (const void * buf, int count, MPI_Datatype datatype, int dest,
+        int tag, MPI_Comm comm)
+{
+    record_pt2pt(f_rsend, SITE, count, datatype, dest, comm);
+
+    return PMPI_Rsend(buf, count, datatype, dest, tag, comm);
+}
+
+int
+MPI_Isend (const void * buf, int count, MPI_Datatype datatype, int dest,
+        int tag, MPI_Comm comm, MPI_Request * request)
+{
+    record_pt2pt(f_isend, SITE, count, datatype, dest, comm);
+
+    return PMPI_Isend(buf, count, datatype, dest, tag, comm, request);
+}
+
+int
+MPI_Ibsend (const void * buf, int count, MPI_Datatype datatype, int dest,
+        int tag, MPI_Comm comm, MPI_Request * request)
+{
+    record_pt2pt(f_ibsend, SITE, count, datatype, dest, comm);
+
+    return PMPI_Ibsend(buf, count, datatype, dest, tag, comm, request);
+}
+
+int
+MPI_Issend (const void * buf, int count, MPI_Datatype datatype, int dest,
+        int tag, MPI_Comm comm, MPI_Request * request)
+{
+    record_pt2pt(f_issend, SITE, count, datatype, dest, comm);
+
+    return PMPI_Issend(buf, count, datatype, dest, tag, comm, request);
+}
+
+int
+MPI_Irsend (const void * buf, int count, MPI_Datatype datatype, int dest,
+        int tag, MPI_Comm comm, MPI_Request * request)
+{
+    record_pt2pt(f_irsend, SITE, count, datatype, dest, comm);
+
+    return PMPI_Irsend(buf, count, datatype, dest, tag, comm, request);
+}
+
+int
+MPI_Recv (void * buf, int count, MPI_Datatype datatype, int source, int tag,
+        MPI_Comm comm, MPI_Status * status)
+{
+    record_pt2pt(f_recv, SITE, count, datatype, source, comm);
+
+    return PMPI_Recv(buf, count, datatype, source, tag, comm, status);
+}
+
+int
+MPI_Irecv (void * buf, int count, MPI_Datatype datatype, int source, int tag,
+        MPI_Comm comm, MPI_Request * request)
+{
+    record_pt2pt(f_irecv, SITE, count, datatype, source, comm);
+
+    return PMPI_Irecv(buf, count, datatype, source, tag, comm, request);
+}
+
+int
+MPI_Sendrecv (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        int dest, int sendtag, void * recvbuf, int recvcount,
+        MPI_Datatype recvtype, int source, int recvtag, MPI_Comm comm,
+        MPI_Status * status)
+{
+    record_pt2pt(f_sendrecv, SITE, sendcount, sendtype, dest, comm);
+
+    return PMPI_Sendrecv(sendbuf, sendcount, sendtype, dest, sendtag, recvbuf,
+            recvcount, recvtype, source, recvtag, comm, status);
+}
+
+/*
+ * Persistent requests are recorded when they are started.
+ */
+int
+MPI_Send_init (const void * buf, int count, MPI_Datatype datatype, int dest,
+        int tag, MPI_Comm comm, MPI_Request * request)
+{
+    int result = PMPI_Send_init(buf, count, datatype, dest, tag, comm,
+            request);
+
+    if (MPI_SUCCESS == result) {
+        record_persistent(f_send_init, SITE, count, datatype, dest, comm,
+                *request);
+    }
+
+    return result;
+}
+
+int
+MPI_Bsend_init (const void * buf, int count, MPI_Datatype datatype,
+        int dest, int tag, MPI_Comm comm, MPI_Request * request)
+{
+    int result = PMPI_Bsend_init(buf, count, datatype, dest, tag, comm,
+            request);
+
+    if (MPI_SUCCESS == result) {
+        record_persistent(f_bsend_init, SITE, count, datatype, dest, comm,
+                *request);
+    }
+
+    return result;
+}
+
+int
+MPI_Ssend_init (const void * buf, int count, MPI_Datatype datatype,
+        int dest, int tag, MPI_Comm comm, MPI_Request * request)
+{
+    int result = PMPI_Ssend_init(buf, count, datatype, dest, tag, comm,
+            request);
+
+    if (MPI_SUCCESS == result) {
+        record_persistent(f_ssend_init, SITE, count, datatype, dest, comm,
+                *request);
+    }
+
+    return result;
+}
+
+int
+MPI_Rsend_init (const void * buf, int count, MPI_Datatype datatype,
+        int dest, int tag, MPI_Comm comm, MPI_Request * request)
+{
+    int result = PMPI_Rsend_init(buf, count, datatype, dest, tag, comm,
+            request);
+
+    if (MPI_SUCCESS == result) {
+        record_persistent(f_rsend_init, SITE, count, datatype, dest, comm,
+                *request);
+    }
+
+    return result;
+}
+
+int
+MPI_Recv_init (void * buf, int count, MPI_Datatype datatype, int source,
+        int tag, MPI_Comm comm, MPI_Request * request)
+{
+    int result = PMPI_Recv_init(buf, count, datatype, source, tag, comm,
+            request);
+
+    if (MPI_SUCCESS == result) {
+        record_persistent(f_recv_init, SITE, count, datatype, source, comm,
+                *request);
+    }
+
+    return result;
+}
+
+int
+MPI_Start (MPI_Request * request)
+{
+    record_start(*request);
+
+    return PMPI_Start(request);
+}
+
+int
+MPI_Startall (int count, MPI_Request * requests)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        record_start(requests[i]);
+    }
+
+    return PMPI_Startall(count, requests);
+}
+
+int
+MPI_Request_free (MPI_Request * request)
+{
+    forget_persistent(*request);
+
+    return PMPI_Request_free(request);
+}
+
+/*
+ * Collective operations record the message size the collective benchmarks
+ * use: the data contributed by one rank, or sent to one rank for alltoall.
+ */
+int
+MPI_Barrier (MPI_Comm comm)
+{
+    record_coll(f_barrier, SITE, 0, comm);
+
+    return PMPI_Barrier(comm);
+}
+
+int
+MPI_Bcast (void * buffer, int count, MPI_Datatype datatype, int root,
+        MPI_Comm comm)
+{
+    record_coll(f_bcast, SITE, bytes(count, datatype), comm);
+
+    return PMPI_Bcast(buffer, count, datatype, root, comm);
+}
+
+int
+MPI_Reduce (const void * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm)
+{
+    record_coll(f_reduce, SITE, bytes(count, datatype), comm);
+
+    return PMPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+}
+
+int
+MPI_Allreduce (const void * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    record_coll(f_allreduce, SITE, bytes(count, datatype), comm);
+
+    return PMPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+int
+MPI_Scan (const void * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    record_coll(f_scan, SITE, bytes(count, datatype), comm);
+
+    return PMPI_Scan(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+int
+MPI_Exscan (const void * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    record_coll(f_exscan, SITE, bytes(count, datatype), comm);
+
+    return PMPI_Exscan(sendbuf, recvbuf, count, datatype, op, comm);
+}
+
+int
+MPI_Gather (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+        MPI_Comm comm)
+{
+    record_coll(f_gather, SITE, MPI_IN_PLACE == sendbuf ? bytes(recvcount,
+                recvtype) : bytes(sendcount, sendtype), comm);
+
+    return PMPI_Gather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+            recvtype, root, comm);
+}
+
+int
+MPI_Gatherv (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, const int * recvcounts, const int * displs,
+        MPI_Datatype recvtype, int root, MPI_Comm comm)
+{
+    record_coll(f_gatherv, SITE, MPI_IN_PLACE == sendbuf ? 0
+            : bytes(sendcount, sendtype), comm);
+
+    return PMPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts,
+            displs, recvtype, root, comm);
+}
+
+int
+MPI_Scatter (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+        MPI_Comm comm)
+{
+    record_coll(f_scatter, SITE, MPI_IN_PLACE == recvbuf ? bytes(sendcount,
+                sendtype) : bytes(recvcount, recvtype), comm);
+
+    return PMPI_Scatter(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+            recvtype, root, comm);
+}
+
+int
+MPI_Scatterv (const void * sendbuf, const int * sendcounts,
+        const int * displs, MPI_Datatype sendtype, void * recvbuf,
+        int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm)
+{
+    record_coll(f_scatterv, SITE, MPI_IN_PLACE == recvbuf ? 0
+            : bytes(recvcount, recvtype), comm);
+
+    return PMPI_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf,
+            recvcount, recvtype, root, comm);
+}
+
+int
+MPI_Allgather (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm)
+{
+    record_coll(f_allgather, SITE, MPI_IN_PLACE == sendbuf ? bytes(recvcount,
+                recvtype) : bytes(sendcount, sendtype), comm);
+
+    return PMPI_Allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+            recvtype, comm);
+}
+
+int
+MPI_Allgatherv (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, const int * recvcounts, const int * displs,
+        MPI_Datatype recvtype, MPI_Comm comm)
+{
+    int rank;
+
+    PMPI_Comm_rank(comm, &rank);
+    record_coll(f_allgatherv, SITE, MPI_IN_PLACE == sendbuf
+            ? bytes(recvcounts[rank], recvtype) : bytes(sendcount, sendtype),
+            comm);
+
+    return PMPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts,
+            displs, recvtype, comm);
+}
+
+int
+MPI_Alltoall (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm)
+{
+    record_coll(f_alltoall, SITE, MPI_IN_PLACE == sendbuf ? bytes(recvcount,
+                recvtype) : bytes(sendcount, sendtype), comm);
+
+    return PMPI_Alltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+            recvtype, comm);
+}
+
+int
+MPI_Alltoallv (const void * sendbuf, const int * sendcounts,
+        const int * sdispls, MPI_Datatype sendtype, void * recvbuf,
+        const int * recvcounts, const int * rdispls, MPI_Datatype recvtype,
+        MPI_Comm comm)
+{
+    int const * counts = MPI_IN_PLACE == sendbuf ? recvcounts : sendcounts;
+    MPI_Datatype datatype = MPI_IN_PLACE == sendbuf ? recvtype : sendtype;
+    int size = comm_size(comm), i;
+    long long total = 0;
+
+    /* the average message per destination */
+    for (i = 0; i < size; i++) {
+        total += counts[i];
+    }
+
+    record_coll(f_alltoallv, SITE, bytes(1, datatype) * total / size, comm);
+
+    return PMPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf,
+            recvcounts, rdispls, recvtype, comm);
+}
+
+int
+MPI_Reduce_scatter (const void * sendbuf, void * recvbuf,
+        const int * recvcounts, MPI_Datatype datatype, MPI_Op op,
+        MPI_Comm comm)
+{
+    int rank;
+
+    PMPI_Comm_rank(comm, &rank);
+    record_coll(f_reduce_scatter, SITE, bytes(recvcounts[rank], datatype),
+            comm);
+
+    return PMPI_Reduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op,
+            comm);
+}
+
+int
+MPI_Reduce_scatter_block (const void * sendbuf, void * recvbuf,
+        int recvcount, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm)
+{
+    record_coll(f_reduce_scatter_block, SITE, bytes(recvcount, datatype),
+            comm);
+
+    return PMPI_Reduce_scatter_block(sendbuf, recvbuf, recvcount, datatype,
+            op, comm);
+}
+
+int
+MPI_Ibarrier (MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_ibarrier, SITE, 0, comm);
+
+    return PMPI_Ibarrier(comm, request);
+}
+
+int
+MPI_Ibcast (void * buffer, int count, MPI_Datatype datatype, int root,
+        MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_ibcast, SITE, bytes(count, datatype), comm);
+
+    return PMPI_Ibcast(buffer, count, datatype, root, comm, request);
+}
+
+int
+MPI_Ireduce (const void * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm,
+        MPI_Request * request)
+{
+    record_coll(f_ireduce, SITE, bytes(count, datatype), comm);
+
+    return PMPI_Ireduce(sendbuf, recvbuf, count, datatype, op, root, comm,
+            request);
+}
+
+int
+MPI_Iallreduce (const void * sendbuf, void * recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+        MPI_Request * request)
+{
+    record_coll(f_iallreduce, SITE, bytes(count, datatype), comm);
+
+    return PMPI_Iallreduce(sendbuf, recvbuf, count, datatype, op, comm,
+            request);
+}
+
+int
+MPI_Igather (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+        MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_igather, SITE, MPI_IN_PLACE == sendbuf ? bytes(recvcount,
+                recvtype) : bytes(sendcount, sendtype), comm);
+
+    return PMPI_Igather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+            recvtype, root, comm, request);
+}
+
+int
+MPI_Iscatter (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, int recvcount, MPI_Datatype recvtype, int root,
+        MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_iscatter, SITE, MPI_IN_PLACE == recvbuf ? bytes(sendcount,
+                sendtype) : bytes(recvcount, recvtype), comm);
+
+    return PMPI_Iscatter(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+            recvtype, root, comm, request);
+}
+
+int
+MPI_Iallgather (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm,
+        MPI_Request * request)
+{
+    record_coll(f_iallgather, SITE, MPI_IN_PLACE == sendbuf
+            ? bytes(recvcount, recvtype) : bytes(sendcount, sendtype), comm);
+
+    return PMPI_Iallgather(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+            recvtype, comm, request);
+}
+
+int
+MPI_Ialltoall (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm,
+        MPI_Request * request)
+{
+    record_coll(f_ialltoall, SITE, MPI_IN_PLACE == sendbuf
+            ? bytes(recvcount, recvtype) : bytes(sendcount, sendtype), comm);
+
+    return PMPI_Ialltoall(sendbuf, sendcount, sendtype, recvbuf, recvcount,
+            recvtype, comm, request);
+}
+
+int
+MPI_Igatherv (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, const int * recvcounts, const int * displs,
+        MPI_Datatype recvtype, int root, MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_igatherv, SITE, MPI_IN_PLACE == sendbuf ? 0
+            : bytes(sendcount, sendtype), comm);
+
+    return PMPI_Igatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts,
+            displs, recvtype, root, comm, request);
+}
+
+int
+MPI_Iscatterv (const void * sendbuf, const int * sendcounts,
+        const int * displs, MPI_Datatype sendtype, void * recvbuf,
+        int recvcount, MPI_Datatype recvtype, int root, MPI_Comm comm,
+        MPI_Request * request)
+{
+    record_coll(f_iscatterv, SITE, MPI_IN_PLACE == recvbuf ? 0
+            : bytes(recvcount, recvtype), comm);
+
+    return PMPI_Iscatterv(sendbuf, sendcounts, displs, sendtype, recvbuf,
+            recvcount, recvtype, root, comm, request);
+}
+
+int
+MPI_Iallgatherv (const void * sendbuf, int sendcount, MPI_Datatype sendtype,
+        void * recvbuf, const int * recvcounts, const int * displs,
+        MPI_Datatype recvtype, MPI_Comm comm, MPI_Request * request)
+{
+    int rank;
+
+    PMPI_Comm_rank(comm, &rank);
+    record_coll(f_iallgatherv, SITE, MPI_IN_PLACE == sendbuf
+            ? bytes(recvcounts[rank], recvtype) : bytes(sendcount, sendtype),
+            comm);
+
+    return PMPI_Iallgatherv(sendbuf, sendcount, sendtype, recvbuf,
+            recvcounts, displs, recvtype, comm, request);
+}
+
+int
+MPI_Ialltoallv (const void * sendbuf, const int * sendcounts,
+        const int * sdispls, MPI_Datatype sendtype, void * recvbuf,
+        const int * recvcounts, const int * rdispls, MPI_Datatype recvtype,
+        MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_ialltoallv, SITE, MPI_IN_PLACE == sendbuf
+            ? average_bytes(recvcounts, comm_size(comm), recvtype)
+            : average_bytes(sendcounts, comm_size(comm), sendtype), comm);
+
+    return PMPI_Ialltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf,
+            recvcounts, rdispls, recvtype, comm, request);
+}
+
+int
+MPI_Ireduce_scatter (const void * sendbuf, void * recvbuf,
+        const int * recvcounts, MPI_Datatype datatype, MPI_Op op,
+        MPI_Comm comm, MPI_Request * request)
+{
+    int rank;
+
+    PMPI_Comm_rank(comm, &rank);
+    record_coll(f_ireduce_scatter, SITE, bytes(recvcounts[rank], datatype),
+            comm);
+
+    return PMPI_Ireduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op,
+            comm, request);
+}
+
+int
+MPI_Ireduce_scatter_block (const void * sendbuf, void * recvbuf,
+        int recvcount, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+        MPI_Request * request)
+{
+    record_coll(f_ireduce_scatter_block, SITE, bytes(recvcount, datatype),
+            comm);
+
+    return PMPI_Ireduce_scatter_block(sendbuf, recvbuf, recvcount, datatype,
+            op, comm, request);
+}
+
+/*
+ * Neighborhood collectives record the data sent to one neighbor, averaged
+ * over the neighbors for the v and w variants.
+ */
+int
+MPI_Neighbor_allgather (const void * sendbuf, int sendcount,
+        MPI_Datatype sendtype, void * recvbuf, int recvcount,
+        MPI_Datatype recvtype, MPI_Comm comm)
+{
+    record_coll(f_neighbor_allgather, SITE, bytes(sendcount, sendtype),
+            comm);
+
+    return PMPI_Neighbor_allgather(sendbuf, sendcount, sendtype, recvbuf,
+            recvcount, recvtype, comm);
+}
+
+int
+MPI_Neighbor_allgatherv (const void * sendbuf, int sendcount,
+        MPI_Datatype sendtype, void * recvbuf, const int * recvcounts,
+        const int * displs, MPI_Datatype recvtype, MPI_Comm comm)
+{
+    record_coll(f_neighbor_allgatherv, SITE, bytes(sendcount, sendtype),
+            comm);
+
+    return PMPI_Neighbor_allgatherv(sendbuf, sendcount, sendtype, recvbuf,
+            recvcounts, displs, recvtype, comm);
+}
+
+int
+MPI_Neighbor_alltoall (const void * sendbuf, int sendcount,
+        MPI_Datatype sendtype, void * recvbuf, int recvcount,
+        MPI_Datatype recvtype, MPI_Comm comm)
+{
+    record_coll(f_neighbor_alltoall, SITE, bytes(sendcount, sendtype), comm);
+
+    return PMPI_Neighbor_alltoall(sendbuf, sendcount, sendtype, recvbuf,
+            recvcount, recvtype, comm);
+}
+
+int
+MPI_Neighbor_alltoallv (const void * sendbuf, const int * sendcounts,
+        const int * sdispls, MPI_Datatype sendtype, void * recvbuf,
+        const int * recvcounts, const int * rdispls, MPI_Datatype recvtype,
+        MPI_Comm comm)
+{
+    record_coll(f_neighbor_alltoallv, SITE, average_bytes(sendcounts,
+                out_degree(comm), sendtype), comm);
+
+    return PMPI_Neighbor_alltoallv(sendbuf, sendcounts, sdispls, sendtype,
+            recvbuf, recvcounts, rdispls, recvtype, comm);
+}
+
+int
+MPI_Neighbor_alltoallw (const void * sendbuf, const int * sendcounts,
+        const MPI_Aint * sdispls, const MPI_Datatype * sendtypes,
+        void * recvbuf, const int * recvcounts, const MPI_Aint * rdispls,
+        const MPI_Datatype * recvtypes, MPI_Comm comm)
+{
+    record_coll(f_neighbor_alltoallw, SITE, average_bytes_w(sendcounts,
+                out_degree(comm), sendtypes), comm);
+
+    return PMPI_Neighbor_alltoallw(sendbuf, sendcounts, sdispls, sendtypes,
+            recvbuf, recvcounts, rdispls, recvtypes, comm);
+}
+
+int
+MPI_Ineighbor_allgather (const void * sendbuf, int sendcount,
+        MPI_Datatype sendtype, void * recvbuf, int recvcount,
+        MPI_Datatype recvtype, MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_ineighbor_allgather, SITE, bytes(sendcount, sendtype),
+            comm);
+
+    return PMPI_Ineighbor_allgather(sendbuf, sendcount, sendtype, recvbuf,
+            recvcount, recvtype, comm, request);
+}
+
+int
+MPI_Ineighbor_allgatherv (const void * sendbuf, int sendcount,
+        MPI_Datatype sendtype, void * recvbuf, const int * recvcounts,
+        const int * displs, MPI_Datatype recvtype, MPI_Comm comm,
+        MPI_Request * request)
+{
+    record_coll(f_ineighbor_allgatherv, SITE, bytes(sendcount, sendtype),
+            comm);
+
+    return PMPI_Ineighbor_allgatherv(sendbuf, sendcount, sendtype, recvbuf,
+            recvcounts, displs, recvtype, comm, request);
+}
+
+int
+MPI_Ineighbor_alltoall (const void * sendbuf, int sendcount,
+        MPI_Datatype sendtype, void * recvbuf, int recvcount,
+        MPI_Datatype recvtype, MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_ineighbor_alltoall, SITE, bytes(sendcount, sendtype),
+            comm);
+
+    return PMPI_Ineighbor_alltoall(sendbuf, sendcount, sendtype, recvbuf,
+            recvcount, recvtype, comm, request);
+}
+
+int
+MPI_Ineighbor_alltoallv (const void * sendbuf, const int * sendcounts,
+        const int * sdispls, MPI_Datatype sendtype, void * recvbuf,
+        const int * recvcounts, const int * rdispls, MPI_Datatype recvtype,
+        MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_ineighbor_alltoallv, SITE, average_bytes(sendcounts,
+                out_degree(comm), sendtype), comm);
+
+    return PMPI_Ineighbor_alltoallv(sendbuf, sendcounts, sdispls, sendtype,
+            recvbuf, recvcounts, rdispls, recvtype, comm, request);
+}
+
+int
+MPI_Ineighbor_alltoallw (const void * sendbuf, const int * sendcounts,
+        const MPI_Aint * sdispls, const MPI_Datatype * sendtypes,
+        void * recvbuf, const int * recvcounts, const MPI_Aint * rdispls,
+        const MPI_Datatype * recvtypes, MPI_Comm comm, MPI_Request * request)
+{
+    record_coll(f_ineighbor_alltoallw, SITE, average_bytes_w(sendcounts,
+                out_degree(comm), sendtypes), comm);
+
+    return PMPI_Ineighbor_alltoallw(sendbuf, sendcounts, sdispls, sendtypes,
+            recvbuf, recvcounts, rdispls, recvtypes, comm, request);
+}
+
+/*
+ * One-sided operations
+ */
+int
+MPI_Win_create (void * base, MPI_Aint size, int disp_unit, MPI_Info info,
+        MPI_Comm comm, MPI_Win * win)
+{
+    int result = PMPI_Win_create(base, size, disp_unit, info, comm, win);
+
+    if (MPI_SUCCESS == result) {
+        attach_window_info(*win);
+    }
+
+    return result;
+}
+
+int
+MPI_Win_allocate (MPI_Aint size, int disp_unit, MPI_Info info, MPI_Comm comm,
+        void * baseptr, MPI_Win * win)
+{
+    int result = PMPI_Win_allocate(size, disp_unit, info, comm, baseptr, win);
+
+    if (MPI_SUCCESS == result) {
+        attach_window_info(*win);
+    }
+
+    return result;
+}
+
+int
+MPI_Win_allocate_shared (MPI_Aint size, int disp_unit, MPI_Info info,
+        MPI_Comm comm, void * baseptr, MPI_Win * win)
+{
+    int result = PMPI_Win_allocate_shared(size, disp_unit, info, comm,
+            baseptr, win);
+
+    if (MPI_SUCCESS == result) {
+        attach_window_info(*win);
+    }
+
+    return result;
+}
+
+int
+MPI_Win_create_dynamic (MPI_Info info, MPI_Comm comm, MPI_Win * win)
+{
+    int result = PMPI_Win_create_dynamic(info, comm, win);
+
+    if (MPI_SUCCESS == result) {
+        attach_window_info(*win);
+    }
+
+    return result;
+}
+
+int
+MPI_Put (const void * origin_addr, int origin_count,
+        MPI_Datatype origin_datatype, int target_rank, MPI_Aint target_disp,
+        int target_count, MPI_Datatype target_datatype, MPI_Win win)
+{
+    record_rma(f_put, SITE, origin_count, origin_datatype, target_rank, win);
+
+    return PMPI_Put(origin_addr, origin_count, origin_datatype, target_rank,
+            target_disp, target_count, target_datatype, win);
+}
+
+int
+MPI_Get (void * origin_addr, int origin_count, MPI_Datatype origin_datatype,
+        int target_rank, MPI_Aint target_disp, int target_count,
+        MPI_Datatype target_datatype, MPI_Win win)
+{
+    record_rma(f_get, SITE, origin_count, origin_datatype, target_rank, win);
+
+    return PMPI_Get(origin_addr, origin_count, origin_datatype, target_rank,
+            target_disp, target_count, target_datatype, win);
+}
+
+int
+MPI_Accumulate (const void * origin_addr, int origin_count,
+        MPI_Datatype origin_datatype, int target_rank, MPI_Aint target_disp,
+        int target_count, MPI_Datatype target_datatype, MPI_Op op,
+        MPI_Win win)
+{
+    record_rma(f_accumulate, SITE, origin_count, origin_datatype,
+            target_rank, win);
+
+    return PMPI_Accumulate(origin_addr, origin_count, origin_datatype,
+            target_rank, target_disp, target_count, target_datatype, op, win);
+}
+
+int
+MPI_Get_accumulate (const void * origin_addr, int origin_count,
+        MPI_Datatype origin_datatype, void * result_addr, int result_count,
+        MPI_Datatype result_datatype, int target_rank, MPI_Aint target_disp,
+        int target_count, MPI_Datatype target_datatype, MPI_Op op,
+        MPI_Win win)
+{
+    record_rma(f_get_accumulate, SITE, result_count, result_datatype,
+            target_rank, win);
+
+    return PMPI_Get_accumulate(origin_addr, origin_count, origin_datatype,
+            result_addr, result_count, result_datatype, target_rank,
+            target_disp, target_count, target_datatype, op, win);
+}
+
+int
+MPI_Fetch_and_op (const void * origin_addr, void * result_addr,
+        MPI_Datatype datatype, int target_rank, MPI_Aint target_disp,
+        MPI_Op op, MPI_Win win)
+{
+    record_rma(f_fetch_and_op, SITE, 1, datatype, target_rank, win);
+
+    return PMPI_Fetch_and_op(origin_addr, result_addr, datatype, target_rank,
+            target_disp, op, win);
+}
+
+int
+MPI_Compare_and_swap (const void * origin_addr, const void * compare_addr,
+        void * result_addr, MPI_Datatype datatype, int target_rank,
+        MPI_Aint target_disp, MPI_Win win)
+{
+    record_rma(f_compare_and_swap, SITE, 1, datatype, target_rank, win);
+
+    return PMPI_Compare_and_swap(origin_addr, compare_addr, result_addr,
+            datatype, target_rank, target_disp, win);
+}
+
+int
+MPI_Rput (const void * origin_addr, int origin_count,
+        MPI_Datatype origin_datatype, int target_rank, MPI_Aint target_disp,
+        int target_count, MPI_Datatype target_datatype, MPI_Win win,
+        MPI_Request * request)
+{
+    record_rma(f_rput, SITE, origin_count, origin_datatype, target_rank, win);
+
+    return PMPI_Rput(origin_addr, origin_count, origin_datatype, target_rank,
+            target_disp, target_count, target_datatype, win, request);
+}
+
+int
+MPI_Rget (void * origin_addr, int origin_count, MPI_Datatype origin_datatype,
+        int target_rank, MPI_Aint target_disp, int target_count,
+        MPI_Datatype target_datatype, MPI_Win win, MPI_Request * request)
+{
+    record_rma(f_rget, SITE, origin_count, origin_datatype, target_rank, win);
+
+    return PMPI_Rget(origin_addr, origin_count, origin_datatype, target_rank,
+            target_disp, target_count, target_datatype, win, request);
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
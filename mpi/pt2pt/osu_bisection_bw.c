@@ -0,0 +1,287 @@
+#define BENCHMARK "OSU MPI Random Bisection Bandwidth Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include <osu_pt2pt.h>
+
+#define WINDOW_SIZE WINDOW_SIZE_LARGE
+
+static char * s_buf, * r_buf;
+static int * ranks;
+static unsigned long long state;
+
+/*
+ * splitmix64, so that every rank draws the same matchings from the seed
+ * whatever its C library.
+ */
+static unsigned long long
+next_random (void)
+{
+    unsigned long long z = (state += 0x9E3779B97F4A7C15ULL);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+
+    return z ^ (z >> 31);
+}
+
+/*
+ * Shuffles the ranks and returns the partner of rank in the matching of the
+ * shuffled ranks 0 and 1, 2 and 3 and so on, or -1 for the rank left over
+ * from an odd number of processes.  The first rank of a pair sends.
+ */
+static int
+draw_matching (int rank, int n, int * sender)
+{
+    int i, j, tmp;
+
+    for (i = n - 1; i > 0; i--) {
+        j = next_random() % (i + 1);
+        tmp = ranks[i];
+        ranks[i] = ranks[j];
+        ranks[j] = tmp;
+    }
+
+    for (i = 0; ranks[i] != rank; i++);
+
+    if (i == n - 1 && n % 2) {
+        return -1;
+    }
+
+    *sender = i % 2 == 0;
+
+    return ranks[i ^ 1];
+}
+
+static int
+compare_doubles (void const * a, void const * b)
+{
+    double x = *(double const *)a, y = *(double const *)b;
+
+    return (x > y) - (x < y);
+}
+
+/*
+ * Streams windows from sender to receiver as osu_mbw_mr does and returns the
+ * time the sender took, 0 on the receiver and on a rank without partner.
+ * All ranks start timing together after the warmup.
+ */
+static double
+run_round (int peer, int sender, int size)
+{
+    double t_start = 0.0;
+    int i, j;
+
+    if(peer < 0) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        return 0.0;
+    }
+
+    for(i = 0; i < options.loop + options.skip; i++) {
+        if(i == options.skip) {
+            MPI_Barrier(MPI_COMM_WORLD);
+            t_start = MPI_Wtime();
+        }
+
+        if(sender) {
+            for(j = 0; j < WINDOW_SIZE; j++) {
+                MPI_Isend(s_buf, size, MPI_CHAR, peer, 100, MPI_COMM_WORLD,
+                        request + j);
+            }
+
+            MPI_Waitall(WINDOW_SIZE, request, reqstat);
+            MPI_Recv(r_buf, 4, MPI_CHAR, peer, 101, MPI_COMM_WORLD,
+                    &reqstat[0]);
+        }
+
+        else {
+            for(j = 0; j < WINDOW_SIZE; j++) {
+                MPI_Irecv(r_buf, size, MPI_CHAR, peer, 100, MPI_COMM_WORLD,
+                        request + j);
+            }
+
+            MPI_Waitall(WINDOW_SIZE, request, reqstat);
+            MPI_Send(s_buf, 4, MPI_CHAR, peer, 101, MPI_COMM_WORLD);
+        }
+    }
+
+    return sender ? MPI_Wtime() - t_start : 0.0;
+}
+
+int
+main (int argc, char *argv[])
+{
+    int myid, numprocs, pairs, size, round, peer, sender, count, i;
+    double elapsed, slowest, bytes, * aggregate = NULL;
+    struct stats_t stats;
+    int po_ret = process_options(argc, argv, BISECT);
+
+    set_header(HEADER);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case po_cuda_not_avail:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case po_openacc_not_avail:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case po_bad_usage:
+            case po_help_message:
+                usage("osu_bisection_bw");
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case po_cuda_not_avail:
+        case po_openacc_not_avail:
+        case po_bad_usage:
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if(numprocs < 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    pairs = numprocs / 2;
+    ranks = malloc(numprocs * sizeof(int));
+    aggregate = malloc(options.rounds * sizeof(double));
+    samples = malloc(options.rounds * sizeof(double));
+    s_buf = osu_malloc(MAX_MSG_SIZE);
+    r_buf = osu_malloc(MAX_MSG_SIZE);
+
+    if (NULL == ranks || NULL == aggregate || NULL == samples
+            || NULL == s_buf || NULL == r_buf) {
+        fprintf(stderr, "Error allocating host memory\n");
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    memset(s_buf, 'a', MAX_MSG_SIZE);
+    memset(r_buf, 'b', MAX_MSG_SIZE);
+
+    output_init(MPI_COMM_WORLD);
+
+    if (0 == myid && sizes_skipped(MAX_MSG_SIZE)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped(MAX_MSG_SIZE), MAX_MSG_SIZE);
+    }
+
+    if (0 == myid && output_text()) {
+        printf(HEADER);
+        printf("# Pairs: %d, rounds: %d, seed: %u, window size: %d\n", pairs,
+                options.rounds, options.seed, WINDOW_SIZE);
+        printf("# Aggregate: median, min and max over the rounds, pair: min, "
+                "1st percentile\n# and median over the pairs of all rounds\n");
+
+        if (allocator_selected()) {
+            printf("# Allocator: %s\n", allocator_spec());
+        }
+
+        printf("%-*s%*s%*s%*s%*s%*s%*s\n", 10, "# Size", FIELD_WIDTH,
+                "Aggregate (MB/s)", 12, "Min", 12, "Max", 12, "Pair min",
+                12, "Pair P1", 12, "Pair P50");
+        fflush(stdout);
+    }
+
+    for(size = first_size(1, MAX_MSG_SIZE); size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
+        if(size > LARGE_MESSAGE_SIZE) {
+            options.loop = options.loop_large;
+            options.skip = options.skip_large;
+        }
+
+        /* every message size sees the same sequence of matchings */
+        state = options.seed;
+
+        for (i = 0; i < numprocs; i++) {
+            ranks[i] = i;
+        }
+
+        bytes = size / 1e6 * WINDOW_SIZE * options.loop;
+        count = 0;
+
+        for(round = 0; round < options.rounds; round++) {
+            peer = draw_matching(myid, numprocs, &sender);
+            elapsed = run_round(peer, sender, size);
+
+            if(elapsed > 0.0) samples[count++] = elapsed;
+
+            /* the round takes as long as its slowest pair */
+            MPI_Reduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+
+            if(myid == 0) aggregate[round] = bytes * pairs / slowest;
+        }
+
+        calculate_stats(&stats, count, 1.0, MPI_COMM_WORLD);
+
+        if(myid != 0) {
+            continue;
+        }
+
+        qsort(aggregate, options.rounds, sizeof(double), compare_doubles);
+
+        /* the slowest times give the lowest pair bandwidths */
+        output_begin(size);
+        output_int("pairs", pairs);
+        output_int("rounds", options.rounds);
+        output_int("seed", options.seed);
+        output_double("bandwidth_mbps", aggregate[options.rounds / 2]);
+        output_double("min_mbps", aggregate[0]);
+        output_double("max_mbps", aggregate[options.rounds - 1]);
+        output_double("pair_min_mbps", bytes / stats.max);
+        output_double("pair_p1_mbps", bytes / stats.p99);
+        output_double("pair_p10_mbps", bytes / stats.p90);
+        output_double("pair_p50_mbps", bytes / stats.p50);
+        output_double("pair_max_mbps", bytes / stats.min);
+        output_int("iterations", options.loop);
+        output_int("warmup", options.skip);
+        output_end();
+
+        if (output_text()) {
+            fprintf(stdout, "%-*d%*.*f%*.*f%*.*f%*.*f%*.*f%*.*f\n", 10, size,
+                    FIELD_WIDTH, FLOAT_PRECISION, aggregate[options.rounds / 2],
+                    12, FLOAT_PRECISION, aggregate[0], 12, FLOAT_PRECISION,
+                    aggregate[options.rounds - 1], 12, FLOAT_PRECISION, bytes
+                    / stats.max, 12, FLOAT_PRECISION, bytes / stats.p99, 12,
+                    FLOAT_PRECISION, bytes / stats.p50);
+            fflush(stdout);
+        }
+    }
+
+    free_samples();
+    free(aggregate);
+    free(ranks);
+    osu_free(s_buf);
+    osu_free(r_buf);
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -11,13 +11,128 @@
 
 #include <osu_pt2pt.h>
 
+/*
+ * Runs the warmup and timed iterations of one message size and window size
+ * and returns the time taken by the timed ones on rank 0.  With persistent
+ * the sends and receives of the window are set up once and restarted every
+ * iteration.
+ */
+static double
+run_windows (char * s_buf, char * r_buf, int myid, int size, int window_size,
+        int persistent)
+{
+    double t_start = 0.0, t_end = 0.0, t = 0.0, t_iter = 0.0;
+    int i, j;
+
+    adaptive_schedule_pt2pt();
+
+    if(persistent) {
+        for(j = 0; j < window_size; j++) {
+            if(myid == 0) {
+                MPI_Send_init(cycle_buffer(s_buf, j, size), size, MPI_CHAR, 1,
+                        100, MPI_COMM_WORLD, request + j);
+            }
+
+            else if(myid == 1) {
+                MPI_Recv_init(cycle_buffer(r_buf, j, size), size, MPI_CHAR, 0,
+                        100, MPI_COMM_WORLD, request + j);
+            }
+        }
+    }
+
+    if(myid == 0) {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            if(i == options.skip) {
+                counters_reset();
+                counters_start();
+                t_start = MPI_Wtime();
+            }
+
+            if(options.show_full || adaptive_enabled()) {
+                t_iter = MPI_Wtime();
+            }
+
+            if(persistent) {
+                MPI_Startall(window_size, request);
+            }
+
+            else {
+                for(j = 0; j < window_size; j++) {
+                    MPI_Isend(cycle_buffer(s_buf, i * window_size + j, size),
+                            size, MPI_CHAR, 1, 100, MPI_COMM_WORLD,
+                            request + j);
+                }
+            }
+
+            MPI_Waitall(window_size, request, reqstat);
+            MPI_Recv(r_buf, 4, MPI_CHAR, 1, 101, MPI_COMM_WORLD,
+                    &reqstat[0]);
+
+            if(options.show_full && i >= options.skip) {
+                samples[i - options.skip] = MPI_Wtime() - t_iter;
+            }
+
+            if(adaptive_enabled()) {
+                adaptive_finish_pt2pt(MPI_Wtime() - t_iter);
+            }
+        }
+
+        t_end = MPI_Wtime();
+        t = adaptive_enabled() ? adaptive_elapsed() : t_end - t_start;
+        counters_stop();
+    }
+
+    else if(myid == 1) {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            if(i == options.skip) {
+                counters_reset();
+                counters_start();
+            }
+
+            if(adaptive_enabled()) {
+                t_iter = MPI_Wtime();
+            }
+
+            if(persistent) {
+                MPI_Startall(window_size, request);
+            }
+
+            else {
+                for(j = 0; j < window_size; j++) {
+                    MPI_Irecv(cycle_buffer(r_buf, i * window_size + j, size),
+                            size, MPI_CHAR, 0, 100, MPI_COMM_WORLD,
+                            request + j);
+                }
+            }
+
+            MPI_Waitall(window_size, request, reqstat);
+            MPI_Send(s_buf, 4, MPI_CHAR, 0, 101, MPI_COMM_WORLD);
+
+            if(adaptive_enabled()) {
+                adaptive_finish_pt2pt(MPI_Wtime() - t_iter);
+            }
+        }
+
+        counters_stop();
+    }
+
+    if(persistent) {
+        for(j = 0; j < window_size; j++) {
+            MPI_Request_free(request + j);
+        }
+    }
+
+    return t;
+}
+
 int
 main (int argc, char *argv[])
 {
-    int myid, numprocs, i, j;
+    int myid, numprocs, w;
     int size;
     char *s_buf, *r_buf;
-    double t_start = 0.0, t_end = 0.0, t = 0.0;
+    double t = 0.0, regular = 0.0;
+    struct stats_t stats;
     int window_size = 64;
     int po_ret = process_options(argc, argv, BW);
 
@@ -79,10 +194,16 @@ main (int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if (options.show_full && allocate_samples()) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
     print_header(myid, BW);
 
     /* Bandwidth test */
-    for(size = 1; size <= MAX_MSG_SIZE; size *= 2) {
+    for(size = first_size(1, MAX_MSG_SIZE); size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
         touch_data(s_buf, r_buf, myid, size);
 
         if(size > LARGE_MESSAGE_SIZE) {
@@ -91,47 +212,44 @@ main (int argc, char *argv[])
             window_size = WINDOW_SIZE_LARGE;
         }
 
-        if(myid == 0) {
-            for(i = 0; i < options.loop + options.skip; i++) {
-                if(i == options.skip) {
-                    t_start = MPI_Wtime();
-                }
-
-                for(j = 0; j < window_size; j++) {
-                    MPI_Isend(s_buf, size, MPI_CHAR, 1, 100, MPI_COMM_WORLD,
-                            request + j);
-                }
+        for(w = 0; w < (options.num_windows ? options.num_windows : 1); w++) {
+            if(options.num_windows) {
+                window_size = options.windows[w];
+                options.window = window_size;
+            }
 
-                MPI_Waitall(window_size, request, reqstat);
-                MPI_Recv(r_buf, 4, MPI_CHAR, 1, 101, MPI_COMM_WORLD,
-                        &reqstat[0]);
+            /* time per message of the regular path in us */
+            if(options.persistent) {
+                regular = run_windows(s_buf, r_buf, myid, size, window_size,
+                        0) * 1e6 / (options.loop * window_size);
             }
 
-            t_end = MPI_Wtime();
-            t = t_end - t_start;
-        }
+            pvars_begin();
+            t = run_windows(s_buf, r_buf, myid, size, window_size,
+                    options.persistent);
 
-        else if(myid == 1) {
-            for(i = 0; i < options.loop + options.skip; i++) {
-                for(j = 0; j < window_size; j++) {
-                    MPI_Irecv(r_buf, size, MPI_CHAR, 0, 100, MPI_COMM_WORLD,
-                            request + j);
-                }
+            counters_reduce(options.loop, MPI_COMM_WORLD);
+            pvars_end(MPI_COMM_WORLD);
 
-                MPI_Waitall(window_size, request, reqstat);
-                MPI_Send(s_buf, 4, MPI_CHAR, 0, 101, MPI_COMM_WORLD);
+            if(options.show_full) {
+                calculate_stats(&stats, myid == 0 ? options.loop : 0, 1e6,
+                        MPI_COMM_WORLD);
             }
-        }
 
-        if(myid == 0) {
-            double tmp = size / 1e6 * options.loop * window_size;
+            if(myid == 0) {
+                double tmp = size / 1e6 * options.loop * window_size;
+
+                if(options.persistent) {
+                    set_comparison(size / regular, regular
+                            - t * 1e6 / (options.loop * window_size));
+                }
 
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, tmp / t);
-            fflush(stdout);
+                print_stats(myid, size, tmp / t, &stats);
+            }
         }
     }
 
+    free_samples();
     free_memory(s_buf, r_buf, myid);
     MPI_Finalize();
 
@@ -0,0 +1,480 @@
+#define BENCHMARK "OSU MPI Halo Exchange Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include <osu_pt2pt.h>
+
+#define MAX_NEIGHBORS 26
+
+static MPI_Comm cart, neighborhood;
+static int ndims, dims[3], num_neighbors, num_sends, num_recvs;
+static int offsets[MAX_NEIGHBORS][3], opposite[MAX_NEIGHBORS];
+static int neighbors[MAX_NEIGHBORS], sends[MAX_NEIGHBORS], recvs[MAX_NEIGHBORS];
+static MPI_Datatype send_types[MAX_NEIGHBORS], recv_types[MAX_NEIGHBORS];
+static MPI_Datatype w_send_types[MAX_NEIGHBORS], w_recv_types[MAX_NEIGHBORS];
+static int w_counts[MAX_NEIGHBORS];
+static MPI_Aint w_displs[MAX_NEIGHBORS];
+static double * grid;
+
+/*
+ * The faces come first in the order of the neighbors of a Cartesian
+ * communicator, the negative then the positive direction of each dimension,
+ * followed by the edges and corners the stencil includes.
+ */
+static void
+find_offsets (void)
+{
+    int o[3], d, j, nonzero;
+
+    num_neighbors = 0;
+
+    for (d = 0; d < ndims; d++) {
+        for (j = -1; j <= 1; j += 2) {
+            memset(offsets[num_neighbors], 0, sizeof(offsets[0]));
+            offsets[num_neighbors++][d] = j;
+        }
+    }
+
+    for (o[0] = -1; o[0] <= 1; o[0]++) {
+        for (o[1] = -1; o[1] <= 1; o[1]++) {
+            for (o[2] = 3 == ndims ? -1 : 0; o[2] <= (3 == ndims); o[2]++) {
+                nonzero = (0 != o[0]) + (0 != o[1]) + (0 != o[2]);
+
+                if (nonzero > 1 && nonzero <= (int)options.stencil) {
+                    memcpy(offsets[num_neighbors++], o, sizeof(o));
+                }
+            }
+        }
+    }
+
+    for (j = 0; j < num_neighbors; j++) {
+        for (opposite[j] = 0; offsets[opposite[j]][0] != -offsets[j][0]
+                || offsets[opposite[j]][1] != -offsets[j][1]
+                || offsets[opposite[j]][2] != -offsets[j][2]; opposite[j]++);
+    }
+}
+
+/*
+ * Neighbors across an open boundary are MPI_PROC_NULL.  On the Cartesian
+ * communicator the neighborhood collective sends to and receives from the
+ * neighbor in each direction.  Otherwise the others make up a distributed
+ * graph, where the message sent in direction j and the one received from
+ * the opposite direction appear in the same order on both ranks, so that
+ * they match even when a small periodic grid repeats a neighbor.
+ */
+static void
+find_neighbors (void)
+{
+    int coords[3], c[3], periods[3], d, j;
+
+    MPI_Cart_get(cart, ndims, dims, periods, coords);
+
+    for (j = 0; j < num_neighbors; j++) {
+        neighbors[j] = MPI_PROC_NULL;
+
+        for (d = 0; d < ndims; d++) {
+            c[d] = coords[d] + offsets[j][d];
+
+            if ((c[d] < 0 || c[d] >= dims[d]) && !periods[d]) {
+                break;
+            }
+
+            c[d] = (c[d] + dims[d]) % dims[d];
+        }
+
+        if (d == ndims) {
+            MPI_Cart_rank(cart, c, neighbors + j);
+        }
+    }
+
+    num_sends = num_recvs = 0;
+
+    if (stencil_faces == options.stencil) {
+        for (j = 0; j < num_neighbors; j++) {
+            sends[num_sends++] = recvs[num_recvs++] = j;
+        }
+
+        neighborhood = cart;
+    }
+
+    /*
+     * Equal weights rather than MPI_UNWEIGHTED, which some compilers take for
+     * an array too small to read from.
+     */
+    else {
+        int sources[MAX_NEIGHBORS], destinations[MAX_NEIGHBORS];
+        int weights[MAX_NEIGHBORS];
+
+        for (j = 0; j < num_neighbors; j++) {
+            weights[j] = 1;
+
+            if (MPI_PROC_NULL != neighbors[j]) {
+                destinations[num_sends] = neighbors[j];
+                sends[num_sends++] = j;
+            }
+
+            if (MPI_PROC_NULL != neighbors[opposite[j]]) {
+                sources[num_recvs] = neighbors[opposite[j]];
+                recvs[num_recvs++] = opposite[j];
+            }
+        }
+
+        MPI_Dist_graph_create_adjacent(cart, num_recvs, sources, weights,
+                num_sends, destinations, weights, MPI_INFO_NULL, 0,
+                &neighborhood);
+    }
+}
+
+/*
+ * Describes the interior cells sent towards each neighbor and the halo cells
+ * received from it in a subdomain of n cells with a halo of width cells
+ * around it.  Returns the number of bytes sent to the neighbors, and the
+ * size of the largest message in largest.
+ */
+static int
+make_types (int const * n, int width, int * largest)
+{
+    int sizes[3], subsizes[3], send_starts[3], recv_starts[3];
+    int bytes = 0, size, d, j;
+
+    *largest = 0;
+
+    for (j = 0; j < num_neighbors; j++) {
+        size = sizeof(double);
+
+        for (d = 0; d < ndims; d++) {
+            sizes[d] = n[d] + 2 * width;
+            subsizes[d] = offsets[j][d] ? width : n[d];
+            send_starts[d] = offsets[j][d] > 0 ? n[d] : width;
+            recv_starts[d] = offsets[j][d] < 0 ? 0 : offsets[j][d] > 0 ?
+                n[d] + width : width;
+            size *= subsizes[d];
+        }
+
+        MPI_Type_create_subarray(ndims, sizes, subsizes, send_starts,
+                MPI_ORDER_C, MPI_DOUBLE, send_types + j);
+        MPI_Type_create_subarray(ndims, sizes, subsizes, recv_starts,
+                MPI_ORDER_C, MPI_DOUBLE, recv_types + j);
+        MPI_Type_commit(send_types + j);
+        MPI_Type_commit(recv_types + j);
+        w_counts[j] = 1;
+
+        if (MPI_PROC_NULL != neighbors[j]) {
+            bytes += size;
+            *largest = size > *largest ? size : *largest;
+        }
+    }
+
+    for (j = 0; j < num_sends; j++) {
+        w_send_types[j] = send_types[sends[j]];
+    }
+
+    for (j = 0; j < num_recvs; j++) {
+        w_recv_types[j] = recv_types[recvs[j]];
+    }
+
+    return bytes;
+}
+
+static void
+free_types (void)
+{
+    int j;
+
+    for (j = 0; j < num_neighbors; j++) {
+        MPI_Type_free(send_types + j);
+        MPI_Type_free(recv_types + j);
+    }
+}
+
+/*
+ * Messages are tagged with the direction they travel in, so that a neighbor
+ * found in several directions of a small periodic grid gets each one right.
+ */
+static void
+exchange (enum halo_method method)
+{
+    MPI_Status status;
+    int j;
+
+    switch (method) {
+        case halo_isend:
+            for (j = 0; j < num_neighbors; j++) {
+                MPI_Irecv(grid, 1, recv_types[j], neighbors[j], opposite[j],
+                        cart, request + j);
+            }
+
+            for (j = 0; j < num_neighbors; j++) {
+                MPI_Isend(grid, 1, send_types[j], neighbors[j], j, cart,
+                        request + num_neighbors + j);
+            }
+
+            MPI_Waitall(2 * num_neighbors, request, reqstat);
+            break;
+        case halo_sendrecv:
+            for (j = 0; j < num_neighbors; j++) {
+                MPI_Sendrecv(grid, 1, send_types[j], neighbors[j], j, grid, 1,
+                        recv_types[opposite[j]], neighbors[opposite[j]], j,
+                        cart, &status);
+            }
+            break;
+        default:
+            MPI_Neighbor_alltoallw(grid, w_counts, w_displs, w_send_types,
+                    grid, w_counts, w_displs, w_recv_types, neighborhood);
+            break;
+    }
+}
+
+/*
+ * Returns the mean time of an exchange on this rank, after recording the
+ * time of each one.
+ */
+static double
+run_exchange (enum halo_method method)
+{
+    double t_start = 0.0, t_step;
+    int i;
+
+    MPI_Barrier(cart);
+
+    for(i = 0; i < options.loop + options.skip; i++) {
+        if(i == options.skip) t_start = MPI_Wtime();
+
+        t_step = MPI_Wtime();
+        exchange(method);
+
+        if(i >= options.skip) samples[i - options.skip] = MPI_Wtime() - t_step;
+    }
+
+    return (MPI_Wtime() - t_start) / options.loop;
+}
+
+int
+main (int argc, char *argv[])
+{
+    int myid, numprocs, periods[3], n[3], bytes, max_bytes, largest;
+    int i, j, d;
+    double elapsed, step;
+    char shape[64];
+    struct stats_t stats;
+    enum halo_method method;
+    int po_ret = process_options(argc, argv, HALO);
+
+    set_header(HEADER);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case po_cuda_not_avail:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case po_openacc_not_avail:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case po_bad_usage:
+            case po_help_message:
+                usage("osu_halo");
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case po_cuda_not_avail:
+        case po_openacc_not_avail:
+        case po_bad_usage:
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    ndims = options.halo_dims;
+
+    /* edges of 8, 16, 32, ... cells */
+    if (0 == options.num_subdomains) {
+        for (d = 8; MAX_SUBDOMAINS > options.num_subdomains; d *= 2) {
+            int * s = options.subdomains[options.num_subdomains];
+
+            if ((3 == ndims ? d : 1) * d * d > MAX_HALO_CELLS) {
+                break;
+            }
+
+            s[0] = s[1] = d;
+            s[2] = 3 == ndims ? d : 0;
+            options.num_subdomains++;
+        }
+    }
+
+    if (0 == options.num_methods) {
+        for (method = 0; method < NUM_HALO_METHODS; method++) {
+            options.methods[options.num_methods++] = method;
+        }
+    }
+
+    for (i = 0; i < options.num_subdomains; i++) {
+        for (d = 0; d < ndims; d++) {
+            if (options.subdomains[i][d] < options.halo_width) {
+                if (0 == myid) {
+                    fprintf(stderr, "The halo is wider than a subdomain\n");
+                }
+
+                MPI_Finalize();
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
+    dims[0] = dims[1] = dims[2] = 0;
+    periods[0] = periods[1] = periods[2] = options.halo_periodic;
+    MPI_Dims_create(numprocs, ndims, dims);
+    MPI_Cart_create(MPI_COMM_WORLD, ndims, dims, periods, 0, &cart);
+
+    find_offsets();
+    find_neighbors();
+
+    if (allocate_samples()) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    output_init(MPI_COMM_WORLD);
+
+    if (0 == myid && output_text()) {
+        printf(HEADER);
+        printf("# Process grid: %d", dims[0]);
+
+        for (d = 1; d < ndims; d++) {
+            printf("x%d", dims[d]);
+        }
+
+        printf(", %s boundaries, halo width: %d, neighbors: %d\n",
+                options.halo_periodic ? "periodic" : "open",
+                options.halo_width, num_neighbors);
+        printf("# Time per exchange, bandwidth of the rank sending the most "
+                "halo data\n");
+
+        if (allocator_selected()) {
+            printf("# Allocator: %s\n", allocator_spec());
+        }
+
+        printf("%-*s%*s%*s%*s%*s", 16, "# Subdomain", 12, "Method", 12,
+                "Bytes", FIELD_WIDTH, "Time (us)", FIELD_WIDTH, "MB/s");
+
+        if (options.show_full) {
+            printf("%*s%*s%*s", FIELD_WIDTH, "P50 (us)", FIELD_WIDTH,
+                    "P99 (us)", FIELD_WIDTH, "Max (us)");
+        }
+
+        printf("\n");
+        fflush(stdout);
+    }
+
+    for(i = 0; i < options.num_subdomains; i++) {
+        size_t count = 1;
+
+        for(d = 0; d < ndims; d++) {
+            n[d] = options.subdomains[i][d];
+            count *= n[d] + 2 * options.halo_width;
+        }
+
+        sprintf(shape, "%d", n[0]);
+
+        for(d = 1; d < ndims; d++) {
+            sprintf(shape + strlen(shape), "x%d", n[d]);
+        }
+
+        if (NULL == (grid = osu_malloc(count * sizeof(double)))) {
+            fprintf(stderr, "Error allocating host memory\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+
+        memset(grid, 0, count * sizeof(double));
+        bytes = make_types(n, options.halo_width, &largest);
+        MPI_Reduce(&bytes, &max_bytes, 1, MPI_INT, MPI_MAX, 0,
+                MPI_COMM_WORLD);
+        MPI_Allreduce(MPI_IN_PLACE, &largest, 1, MPI_INT, MPI_MAX,
+                MPI_COMM_WORLD);
+
+        if(largest > LARGE_MESSAGE_SIZE) {
+            options.loop = options.loop_large;
+            options.skip = options.skip_large;
+        }
+
+        for(j = 0; j < options.num_methods; j++) {
+            method = options.methods[j];
+            elapsed = run_exchange(method);
+
+            /* an exchange takes as long as on the slowest rank */
+            MPI_Reduce(&elapsed, &step, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+            calculate_stats(&stats, options.loop, 1e6, MPI_COMM_WORLD);
+
+            if(myid != 0) {
+                continue;
+            }
+
+            output_begin(max_bytes);
+            output_string("subdomain", shape);
+            output_string("method", halo_method_names[method]);
+            output_int("neighbors", num_neighbors);
+            output_double("time_us", step * 1e6);
+            output_double("bandwidth_mbps", max_bytes / 1e6 / step);
+
+            if (options.show_full) {
+                output_double("p50_us", stats.p50);
+                output_double("p99_us", stats.p99);
+                output_double("max_us", stats.max);
+            }
+
+            output_int("iterations", options.loop);
+            output_int("warmup", options.skip);
+            output_end();
+
+            if (output_text()) {
+                fprintf(stdout, "%-*s%*s%*d%*.*f%*.*f", 16, shape, 12,
+                        halo_method_names[method], 12, max_bytes, FIELD_WIDTH,
+                        FLOAT_PRECISION, step * 1e6, FIELD_WIDTH,
+                        FLOAT_PRECISION, max_bytes / 1e6 / step);
+
+                if (options.show_full) {
+                    fprintf(stdout, "%*.*f%*.*f%*.*f", FIELD_WIDTH,
+                            FLOAT_PRECISION, stats.p50, FIELD_WIDTH,
+                            FLOAT_PRECISION, stats.p99, FIELD_WIDTH,
+                            FLOAT_PRECISION, stats.max);
+                }
+
+                fprintf(stdout, "\n");
+                fflush(stdout);
+            }
+        }
+
+        free_types();
+        osu_free(grid);
+    }
+
+    if (neighborhood != cart) {
+        MPI_Comm_free(&neighborhood);
+    }
+
+    MPI_Comm_free(&cart);
+    free_samples();
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,304 @@
+#define BENCHMARK "OSU MPI Incast Bandwidth Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include <osu_pt2pt.h>
+
+#define WINDOW_SIZE WINDOW_SIZE_LARGE
+
+static char * s_buf, * r_buf;
+static int * indices, * pending, * windows_left;
+
+static void
+post_window (int sender, int size)
+{
+    int j;
+
+    for(j = 0; j < WINDOW_SIZE; j++) {
+        MPI_Irecv(r_buf, size, MPI_CHAR, sender, 100, MPI_COMM_WORLD,
+                request + (sender - 1) * WINDOW_SIZE + j);
+    }
+
+    pending[sender] = WINDOW_SIZE;
+}
+
+/*
+ * Rank 0 receives windows of messages from ranks 1 to senders.  Every
+ * sender is acknowledged as soon as its own window is complete and goes on
+ * independently of the others, so that a sender the receiver favors
+ * finishes early.
+ */
+static void
+receive_windows (int senders, int size, int windows)
+{
+    int done = 0, outcount, i, sender;
+
+    if(windows == 0) return;
+
+    for(sender = 1; sender <= senders; sender++) {
+        windows_left[sender] = windows;
+        post_window(sender, size);
+    }
+
+    while(done < senders) {
+        MPI_Waitsome(senders * WINDOW_SIZE, request, &outcount, indices,
+                reqstat);
+
+        for(i = 0; i < outcount; i++) {
+            sender = indices[i] / WINDOW_SIZE + 1;
+
+            if(--pending[sender]) {
+                continue;
+            }
+
+            MPI_Send(s_buf, 4, MPI_CHAR, sender, 101, MPI_COMM_WORLD);
+
+            if(--windows_left[sender]) {
+                post_window(sender, size);
+            }
+
+            else {
+                done++;
+            }
+        }
+    }
+}
+
+/*
+ * Returns the time taken on this rank, until the last sender finished on
+ * rank 0.  Senders record the time of each window when sampling.
+ */
+static double
+run_incast (int myid, int senders, int size, int windows, int sampling)
+{
+    double t_start, t_iter;
+    int i, j;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    t_start = MPI_Wtime();
+
+    if(myid == 0) {
+        receive_windows(senders, size, windows);
+    }
+
+    else if(myid <= senders) {
+        for(i = 0; i < windows; i++) {
+            t_iter = MPI_Wtime();
+
+            for(j = 0; j < WINDOW_SIZE; j++) {
+                MPI_Isend(s_buf, size, MPI_CHAR, 0, 100, MPI_COMM_WORLD,
+                        request + j);
+            }
+
+            MPI_Waitall(WINDOW_SIZE, request, reqstat);
+            MPI_Recv(r_buf, 4, MPI_CHAR, 0, 101, MPI_COMM_WORLD, &reqstat[0]);
+
+            if(sampling) samples[i] = MPI_Wtime() - t_iter;
+        }
+    }
+
+    return MPI_Wtime() - t_start;
+}
+
+int
+main (int argc, char *argv[])
+{
+    int myid, numprocs, size, senders, max_senders = 0, i;
+    double elapsed, bandwidth, local_min, local_max, min_bw, max_bw;
+    struct stats_t stats;
+    int po_ret = process_options(argc, argv, INCAST);
+
+    set_header(HEADER);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case po_cuda_not_avail:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case po_openacc_not_avail:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case po_bad_usage:
+            case po_help_message:
+                usage("osu_incast");
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case po_cuda_not_avail:
+        case po_openacc_not_avail:
+        case po_bad_usage:
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if(numprocs < 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    /* 1, 2, 4, ... senders and all of them */
+    if (0 == options.num_senders) {
+        for (senders = 1; senders < numprocs - 1; senders *= 2) {
+            options.senders[options.num_senders++] = senders;
+        }
+
+        options.senders[options.num_senders++] = numprocs - 1;
+    }
+
+    for (i = 0; i < options.num_senders; i++) {
+        if (options.senders[i] >= numprocs) {
+            if (0 == myid) {
+                fprintf(stderr, "Cannot run %d senders with %d processes\n",
+                        options.senders[i], numprocs);
+            }
+
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        }
+
+        if (options.senders[i] > max_senders) {
+            max_senders = options.senders[i];
+        }
+    }
+
+    if (grow_requests(max_senders * WINDOW_SIZE)) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    indices = malloc(max_senders * WINDOW_SIZE * sizeof(int));
+    pending = malloc(numprocs * sizeof(int));
+    windows_left = malloc(numprocs * sizeof(int));
+    s_buf = osu_malloc(MAX_MSG_SIZE);
+    r_buf = osu_malloc(MAX_MSG_SIZE);
+
+    if (NULL == indices || NULL == pending || NULL == windows_left
+            || NULL == s_buf || NULL == r_buf) {
+        fprintf(stderr, "Error allocating host memory\n");
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    memset(s_buf, 'a', MAX_MSG_SIZE);
+    memset(r_buf, 'b', MAX_MSG_SIZE);
+
+    if (allocate_samples()) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    output_init(MPI_COMM_WORLD);
+
+    if (0 == myid && sizes_skipped(MAX_MSG_SIZE)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped(MAX_MSG_SIZE), MAX_MSG_SIZE);
+    }
+
+    if (0 == myid && output_text()) {
+        printf(HEADER);
+        printf("# Window size: %d, shares are relative to an equal split, "
+                "times per window\n", WINDOW_SIZE);
+
+        if (allocator_selected()) {
+            printf("# Allocator: %s\n", allocator_spec());
+        }
+
+        printf("%-*s%*s%*s%*s%*s%*s%*s%*s\n", 10, "# Size", 10, "Senders",
+                FIELD_WIDTH, "Aggregate (MB/s)", 12, "Min share", 12,
+                "Max share", FIELD_WIDTH, "P50 (us)", FIELD_WIDTH,
+                "P99 (us)", FIELD_WIDTH, "Max (us)");
+        fflush(stdout);
+    }
+
+    for(size = first_size(1, MAX_MSG_SIZE); size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
+        if(size > LARGE_MESSAGE_SIZE) {
+            options.loop = options.loop_large;
+            options.skip = options.skip_large;
+        }
+
+        for(i = 0; i < options.num_senders; i++) {
+            senders = options.senders[i];
+
+            run_incast(myid, senders, size, options.skip, 0);
+            elapsed = run_incast(myid, senders, size, options.loop, 1);
+
+            /* each sender's own bandwidth, the others are left out */
+            bandwidth = size / 1e6 * WINDOW_SIZE * options.loop / elapsed;
+            local_min = myid && myid <= senders ? bandwidth : 1e300;
+            local_max = myid && myid <= senders ? bandwidth : 0.0;
+
+            MPI_Reduce(&local_min, &min_bw, 1, MPI_DOUBLE, MPI_MIN, 0,
+                    MPI_COMM_WORLD);
+            MPI_Reduce(&local_max, &max_bw, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+            calculate_stats(&stats, myid && myid <= senders ? options.loop :
+                    0, 1e6, MPI_COMM_WORLD);
+
+            if(myid != 0) {
+                continue;
+            }
+
+            /* rank 0 received everything in elapsed */
+            bandwidth *= senders;
+
+            output_begin(size);
+            output_int("senders", senders);
+            output_double("bandwidth_mbps", bandwidth);
+            output_double("min_share", min_bw * senders / bandwidth);
+            output_double("max_share", max_bw * senders / bandwidth);
+            output_double("p50_us", stats.p50);
+            output_double("p99_us", stats.p99);
+            output_double("max_us", stats.max);
+            output_int("iterations", options.loop);
+            output_int("warmup", options.skip);
+            output_end();
+
+            if (output_text()) {
+                fprintf(stdout, "%-*d%*d%*.*f%*.*f%*.*f%*.*f%*.*f%*.*f\n", 10,
+                        size, 10, senders, FIELD_WIDTH, FLOAT_PRECISION,
+                        bandwidth, 12, FLOAT_PRECISION, min_bw * senders
+                        / bandwidth, 12, FLOAT_PRECISION, max_bw * senders
+                        / bandwidth, FIELD_WIDTH, FLOAT_PRECISION, stats.p50,
+                        FIELD_WIDTH, FLOAT_PRECISION, stats.p99, FIELD_WIDTH,
+                        FLOAT_PRECISION, stats.max);
+                fflush(stdout);
+            }
+        }
+    }
+
+    free_samples();
+    free(indices);
+    free(pending);
+    free(windows_left);
+    osu_free(s_buf);
+    osu_free(r_buf);
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -10,14 +10,214 @@
  */
 #include <osu_pt2pt.h>
 
+/* messages the attached buffer of the buffered mode holds */
+#define BSEND_MESSAGES 4
+
+static char * bsend_buf = NULL;
+
+static void
+complete (MPI_Request * req, enum send_mode mode)
+{
+    MPI_Status reqstat;
+    int flag = 0;
+
+    if(send_test == mode) {
+        while(!flag) MPI_Test(req, &flag, &reqstat);
+    }
+
+    else {
+        MPI_Wait(req, &reqstat);
+    }
+}
+
+static void
+send_message (char * buf, int size, int peer, enum send_mode mode)
+{
+    MPI_Request req;
+
+    switch (mode) {
+        case send_sync:
+            MPI_Ssend(buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD);
+            break;
+        case send_buffered:
+            MPI_Bsend(buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD);
+            break;
+        case send_ready:
+            MPI_Rsend(buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD);
+            break;
+        case send_test:
+        case send_wait:
+            MPI_Isend(buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD, &req);
+            complete(&req, mode);
+            break;
+        default:
+            MPI_Send(buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD);
+            break;
+    }
+}
+
+/*
+ * In the ready mode the receive was posted to recv_request before the peer
+ * could send.
+ */
+static void
+recv_message (char * buf, int size, int peer, enum send_mode mode)
+{
+    MPI_Status reqstat;
+    MPI_Request req;
+
+    switch (mode) {
+        case send_ready:
+            MPI_Wait(recv_request, &reqstat);
+            break;
+        case send_test:
+        case send_wait:
+            MPI_Irecv(buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD, &req);
+            complete(&req, mode);
+            break;
+        default:
+            MPI_Recv(buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD, &reqstat);
+            break;
+    }
+}
+
+/*
+ * Runs the warmup and timed ping-pongs of one message size and returns the
+ * time taken by the timed ones on rank 0.  With persistent the send and the
+ * receive are set up once and restarted every iteration, otherwise the
+ * messages are sent in the given mode.
+ */
+static double
+run_pingpong (char * s_buf, char * r_buf, int myid, int size, int persistent,
+        enum send_mode mode)
+{
+    double t_start = 0.0, t_end = 0.0, t_iter = 0.0;
+    MPI_Status reqstat;
+    int i;
+
+    adaptive_schedule_pt2pt();
+
+    if(send_buffered == mode) {
+        MPI_Buffer_attach(bsend_buf, BSEND_MESSAGES
+                * (size + MPI_BSEND_OVERHEAD));
+    }
+
+    /* each rank posts its receive before the other one can send */
+    if(send_ready == mode) {
+        if(myid == 1) {
+            MPI_Irecv(cycle_buffer(r_buf, 0, size), size, MPI_CHAR, 0, 1,
+                    MPI_COMM_WORLD, recv_request);
+        }
+
+        MPI_Barrier(MPI_COMM_WORLD);
+    }
+
+    if(persistent && myid < 2) {
+        MPI_Send_init(s_buf, size, MPI_CHAR, 1 - myid, 1, MPI_COMM_WORLD,
+                send_request);
+        MPI_Recv_init(r_buf, size, MPI_CHAR, 1 - myid, 1, MPI_COMM_WORLD,
+                recv_request);
+    }
+
+    if(myid == 0) {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            if(i == options.skip) {
+                counters_reset();
+                counters_start();
+                t_start = MPI_Wtime();
+            }
+
+            if(options.show_full || adaptive_enabled()) t_iter = MPI_Wtime();
+
+            if(persistent) {
+                MPI_Start(send_request);
+                MPI_Wait(send_request, &reqstat);
+                MPI_Start(recv_request);
+                MPI_Wait(recv_request, &reqstat);
+            }
+
+            else {
+                if(send_ready == mode) {
+                    MPI_Irecv(cycle_buffer(r_buf, i, size), size, MPI_CHAR, 1,
+                            1, MPI_COMM_WORLD, recv_request);
+                }
+
+                send_message(cycle_buffer(s_buf, i, size), size, 1, mode);
+                recv_message(cycle_buffer(r_buf, i, size), size, 1, mode);
+            }
+
+            if(options.show_full && i >= options.skip) {
+                samples[i - options.skip] = MPI_Wtime() - t_iter;
+            }
+
+            if(adaptive_enabled()) adaptive_finish_pt2pt(MPI_Wtime() - t_iter);
+        }
+
+        t_end = MPI_Wtime();
+        counters_stop();
+    }
+
+    else if(myid == 1) {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            if(i == options.skip) {
+                counters_reset();
+                counters_start();
+            }
+
+            if(adaptive_enabled()) t_iter = MPI_Wtime();
+
+            if(persistent) {
+                MPI_Start(recv_request);
+                MPI_Wait(recv_request, &reqstat);
+                MPI_Start(send_request);
+                MPI_Wait(send_request, &reqstat);
+            }
+
+            else {
+                recv_message(cycle_buffer(r_buf, i, size), size, 0, mode);
+
+                if(send_ready == mode) {
+                    MPI_Irecv(cycle_buffer(r_buf, i + 1, size), size,
+                            MPI_CHAR, 0, 1, MPI_COMM_WORLD, recv_request);
+                }
+
+                send_message(cycle_buffer(s_buf, i, size), size, 0, mode);
+            }
+
+            if(adaptive_enabled()) adaptive_finish_pt2pt(MPI_Wtime() - t_iter);
+        }
+
+        counters_stop();
+    }
+
+    if(persistent && myid < 2) {
+        MPI_Request_free(send_request);
+        MPI_Request_free(recv_request);
+    }
+
+    /* the receive for the ping after the last one */
+    if(send_ready == mode && myid == 1) {
+        MPI_Cancel(recv_request);
+        MPI_Wait(recv_request, &reqstat);
+    }
+
+    if(send_buffered == mode) {
+        MPI_Buffer_detach(&bsend_buf, &i);
+    }
+
+    return adaptive_enabled() ? adaptive_elapsed() : t_end - t_start;
+}
+
 int
 main (int argc, char *argv[])
 {
-    int myid, numprocs, i;
+    int myid, numprocs;
     int size;
-    MPI_Status reqstat;
     char *s_buf, *r_buf;
-    double t_start = 0.0, t_end = 0.0;
+    double elapsed, regular = 0.0;
+    enum send_mode mode = options.num_modes ? options.modes[0] : send_standard;
+    int i;
+    struct stats_t stats;
     int po_ret = process_options(argc, argv, LAT);
 
     if (po_okay == po_ret && none != options.accel) {
@@ -78,11 +278,30 @@ main (int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
+    if (options.show_full && allocate_samples()) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < options.num_modes; i++) {
+        if (send_buffered == options.modes[i]) {
+            bsend_buf = malloc(BSEND_MESSAGES * (MAX_MSG_SIZE
+                        + MPI_BSEND_OVERHEAD));
+
+            if (NULL == bsend_buf) {
+                fprintf(stderr, "Error allocating host memory\n");
+                MPI_Finalize();
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+
     print_header(myid, LAT);
 
     
     /* Latency test */
-    for(size = 0; size <= MAX_MSG_SIZE; size = (size ? size * 2 : 1)) {
+    for(size = first_size(0, MAX_MSG_SIZE); size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
         touch_data(s_buf, r_buf, myid, size);
 
         if(size > LARGE_MESSAGE_SIZE) {
@@ -92,33 +311,47 @@ main (int argc, char *argv[])
 
         MPI_Barrier(MPI_COMM_WORLD);
 
-        if(myid == 0) {
-            for(i = 0; i < options.loop + options.skip; i++) {
-                if(i == options.skip) t_start = MPI_Wtime();
-
-                MPI_Send(s_buf, size, MPI_CHAR, 1, 1, MPI_COMM_WORLD);
-                MPI_Recv(r_buf, size, MPI_CHAR, 1, 1, MPI_COMM_WORLD, &reqstat);
-            }
+        /* one-way latency of the regular path in us */
+        if(options.persistent) {
+            regular = run_pingpong(s_buf, r_buf, myid, size, 0,
+                    send_standard) * 1e6 / (2.0 * options.loop);
+            MPI_Barrier(MPI_COMM_WORLD);
+        }
 
-            t_end = MPI_Wtime();
+        /* the other send modes, the first one is instrumented below */
+        for(i = 1; i < options.num_modes; i++) {
+            set_mode_latency(i, run_pingpong(s_buf, r_buf, myid, size, 0,
+                        options.modes[i]) * 1e6 / (2.0 * options.loop));
+            MPI_Barrier(MPI_COMM_WORLD);
         }
 
-        else if(myid == 1) {
-            for(i = 0; i < options.loop + options.skip; i++) {
-                MPI_Recv(r_buf, size, MPI_CHAR, 0, 1, MPI_COMM_WORLD, &reqstat);
-                MPI_Send(s_buf, size, MPI_CHAR, 0, 1, MPI_COMM_WORLD);
-            }
+        pvars_begin();
+        elapsed = run_pingpong(s_buf, r_buf, myid, size, options.persistent,
+                mode);
+
+        counters_reduce(options.loop, MPI_COMM_WORLD);
+        pvars_end(MPI_COMM_WORLD);
+
+        if(options.show_full) {
+            calculate_stats(&stats, myid == 0 ? options.loop : 0, 1e6 / 2.0,
+                    MPI_COMM_WORLD);
         }
 
         if(myid == 0) {
-            double latency = (t_end - t_start) * 1e6 / (2.0 * options.loop);
+            double latency = elapsed * 1e6 / (2.0 * options.loop);
+
+            if(options.persistent) {
+                set_comparison(regular, regular - latency);
+            }
+
+            set_mode_latency(0, latency);
 
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, latency);
-            fflush(stdout);
+            print_stats(myid, size, latency, &stats);
         }
     }
 
+    free_samples();
+    free(bsend_buf);
     free_memory(s_buf, r_buf, myid);
     MPI_Finalize();
 
@@ -0,0 +1,407 @@
+#define BENCHMARK "OSU MPI%s Derived Datatype Latency Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include <osu_pt2pt.h>
+
+/*
+ * Every message is a row of blocks of options.ddt_block bytes, whose starts
+ * are options.ddt_stride bytes apart, e.g. a column of ghost cells.  The row
+ * spans up to MAX_EXTENT bytes of the buffers.
+ */
+#define MAX_EXTENT (16 * MAX_MSG_SIZE)
+
+enum path {
+    path_datatype,
+    path_pack,
+    path_manual,
+    NUM_PATHS
+};
+
+static char const * type_names[] = {
+    "vector", "indexed", "subarray", "struct"
+};
+
+static char * s_buf, * r_buf, * s_packed, * r_packed;
+static int myid, pack_size;
+
+/*
+ * Describes count blocks with the datatype selected by -t.  All of them
+ * have the same layout, so that only the way the layout is described to
+ * the library differs.
+ */
+static int
+create_datatype (int count, MPI_Datatype * datatype)
+{
+    int block = options.ddt_block, stride = options.ddt_stride;
+    int sizes[2], subsizes[2], starts[2] = { 0, 0 };
+    int * lengths, * displacements, i;
+    MPI_Datatype * types;
+    MPI_Aint * offsets;
+
+    switch (options.ddt) {
+        case ddt_vector:
+            MPI_Type_vector(count, block, stride, MPI_CHAR, datatype);
+            break;
+        case ddt_indexed:
+            lengths = malloc(count * sizeof(int));
+            displacements = malloc(count * sizeof(int));
+
+            if (NULL == lengths || NULL == displacements) {
+                return 1;
+            }
+
+            for (i = 0; i < count; i++) {
+                lengths[i] = block;
+                displacements[i] = i * stride;
+            }
+
+            MPI_Type_indexed(count, lengths, displacements, MPI_CHAR,
+                    datatype);
+            free(lengths);
+            free(displacements);
+            break;
+        case ddt_subarray:
+            sizes[0] = subsizes[0] = count;
+            sizes[1] = stride;
+            subsizes[1] = block;
+            MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C,
+                    MPI_CHAR, datatype);
+            break;
+        case ddt_struct:
+            lengths = malloc(count * sizeof(int));
+            offsets = malloc(count * sizeof(MPI_Aint));
+            types = malloc(count * sizeof(MPI_Datatype));
+
+            if (NULL == lengths || NULL == offsets || NULL == types) {
+                return 1;
+            }
+
+            for (i = 0; i < count; i++) {
+                lengths[i] = block;
+                offsets[i] = (MPI_Aint)i * stride;
+                types[i] = MPI_CHAR;
+            }
+
+            MPI_Type_create_struct(count, lengths, offsets, types, datatype);
+            free(lengths);
+            free(offsets);
+            free(types);
+            break;
+    }
+
+    return MPI_Type_commit(datatype);
+}
+
+/*
+ * Hand-written pack and unpack loops.  Blocks and strides that are a whole
+ * number of words are copied a word at a time, a loop the compiler can
+ * vectorize, everything else a block at a time.
+ */
+static void
+pack_blocks (char * packed, char const * buffer, int count)
+{
+    int block = options.ddt_block, stride = options.ddt_stride;
+    int words = block / sizeof(uint64_t), step = stride / sizeof(uint64_t);
+    uint64_t * dst = (uint64_t *)packed;
+    uint64_t const * src = (uint64_t const *)buffer;
+    int i, j;
+
+    if (0 == block % sizeof(uint64_t) && 0 == stride % sizeof(uint64_t)) {
+        for (i = 0; i < count; i++) {
+            for (j = 0; j < words; j++) {
+                dst[i * words + j] = src[i * step + j];
+            }
+        }
+    }
+
+    else {
+        for (i = 0; i < count; i++) {
+            memcpy(packed + (size_t)i * block, buffer + (size_t)i * stride,
+                    block);
+        }
+    }
+}
+
+static void
+unpack_blocks (char * buffer, char const * packed, int count)
+{
+    int block = options.ddt_block, stride = options.ddt_stride;
+    int words = block / sizeof(uint64_t), step = stride / sizeof(uint64_t);
+    uint64_t * dst = (uint64_t *)buffer;
+    uint64_t const * src = (uint64_t const *)packed;
+    int i, j;
+
+    if (0 == block % sizeof(uint64_t) && 0 == stride % sizeof(uint64_t)) {
+        for (i = 0; i < count; i++) {
+            for (j = 0; j < words; j++) {
+                dst[i * step + j] = src[i * words + j];
+            }
+        }
+    }
+
+    else {
+        for (i = 0; i < count; i++) {
+            memcpy(buffer + (size_t)i * stride, packed + (size_t)i * block,
+                    block);
+        }
+    }
+}
+
+static void
+send_message (enum path path, MPI_Datatype datatype, int count, int size,
+        int peer)
+{
+    int position = 0;
+
+    switch (path) {
+        case path_datatype:
+            MPI_Send(s_buf, 1, datatype, peer, 1, MPI_COMM_WORLD);
+            break;
+        case path_pack:
+            MPI_Pack(s_buf, 1, datatype, s_packed, pack_size, &position,
+                    MPI_COMM_WORLD);
+            MPI_Send(s_packed, position, MPI_PACKED, peer, 1, MPI_COMM_WORLD);
+            break;
+        default:
+            pack_blocks(s_packed, s_buf, count);
+            MPI_Send(s_packed, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD);
+            break;
+    }
+}
+
+static void
+recv_message (enum path path, MPI_Datatype datatype, int count, int size,
+        int peer)
+{
+    MPI_Status reqstat;
+    int position = 0;
+
+    switch (path) {
+        case path_datatype:
+            MPI_Recv(r_buf, 1, datatype, peer, 1, MPI_COMM_WORLD, &reqstat);
+            break;
+        case path_pack:
+            MPI_Recv(r_packed, pack_size, MPI_PACKED, peer, 1,
+                    MPI_COMM_WORLD, &reqstat);
+            MPI_Unpack(r_packed, pack_size, &position, r_buf, 1, datatype,
+                    MPI_COMM_WORLD);
+            break;
+        default:
+            MPI_Recv(r_packed, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD,
+                    &reqstat);
+            unpack_blocks(r_buf, r_packed, count);
+            break;
+    }
+}
+
+/*
+ * Returns the one-way latency of count blocks sent along path in us.
+ */
+static double
+run_path (enum path path, MPI_Datatype datatype, int count)
+{
+    int size = count * options.ddt_block;
+    double t_start = 0.0, t_end = 0.0;
+    int i;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if(myid == 0) {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            if(i == options.skip) t_start = MPI_Wtime();
+
+            send_message(path, datatype, count, size, 1);
+            recv_message(path, datatype, count, size, 1);
+        }
+
+        t_end = MPI_Wtime();
+    }
+
+    else if(myid == 1) {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            recv_message(path, datatype, count, size, 0);
+            send_message(path, datatype, count, size, 0);
+        }
+    }
+
+    return (t_end - t_start) * 1e6 / (2.0 * options.loop);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int numprocs, count, max_count;
+    double latency[NUM_PATHS];
+    MPI_Datatype datatype;
+    enum path path;
+    int po_ret = process_options(argc, argv, DDT);
+
+    if (po_okay == po_ret && none != options.accel) {
+        if (init_accel()) {
+           fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    set_header(HEADER);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case po_cuda_not_avail:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case po_openacc_not_avail:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case po_bad_usage:
+            case po_help_message:
+                usage("osu_latency_ddt");
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case po_cuda_not_avail:
+        case po_openacc_not_avail:
+        case po_bad_usage:
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if(numprocs != 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    if (none != options.accel) {
+        if(myid == 0) {
+            fprintf(stderr, "This test only supports host buffers\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    max_count = MAX_MSG_SIZE / options.ddt_block;
+
+    if (max_count > MAX_EXTENT / options.ddt_stride) {
+        max_count = MAX_EXTENT / options.ddt_stride;
+    }
+
+    MPI_Pack_size(max_count * options.ddt_block, MPI_CHAR, MPI_COMM_WORLD,
+            &pack_size);
+
+    s_buf = osu_malloc((size_t)max_count * options.ddt_stride);
+    r_buf = osu_malloc((size_t)max_count * options.ddt_stride);
+    s_packed = osu_malloc(pack_size);
+    r_packed = osu_malloc(pack_size);
+
+    if (NULL == s_buf || NULL == r_buf || NULL == s_packed
+            || NULL == r_packed) {
+        fprintf(stderr, "Error allocating host memory\n");
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    memset(s_buf, 'a', (size_t)max_count * options.ddt_stride);
+    memset(r_buf, 'b', (size_t)max_count * options.ddt_stride);
+
+    output_init(MPI_COMM_WORLD);
+
+    if (0 == myid && sizes_skipped((size_t)max_count * options.ddt_block)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped((size_t)max_count
+                    * options.ddt_block), max_count * options.ddt_block);
+    }
+
+    if (0 == myid && output_text()) {
+        printf(HEADER, "");
+        printf("# Datatype: %s, %d byte blocks %d bytes apart\n",
+                type_names[options.ddt], options.ddt_block,
+                options.ddt_stride);
+
+        if (allocator_selected()) {
+            printf("# Allocator: %s\n", allocator_spec());
+        }
+
+        printf("%-*s%*s%*s%*s\n", 10, "# Size", FIELD_WIDTH, "Datatype (us)",
+                FIELD_WIDTH, "MPI_Pack (us)", FIELD_WIDTH, "Manual (us)");
+        fflush(stdout);
+    }
+
+    /* Latency test, in whole blocks */
+    for(count = first_count(1, max_count * options.ddt_block,
+                options.ddt_block); count <= max_count;
+            count = next_count(count, max_count * options.ddt_block,
+                options.ddt_block)) {
+        if(count * options.ddt_block > LARGE_MESSAGE_SIZE) {
+            options.loop = options.loop_large;
+            options.skip = options.skip_large;
+        }
+
+        if (create_datatype(count, &datatype)) {
+            fprintf(stderr, "Error creating the datatype\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+
+        for(path = path_datatype; path < NUM_PATHS; path++) {
+            latency[path] = run_path(path, datatype, count);
+        }
+
+        MPI_Type_free(&datatype);
+
+        if(myid == 0) {
+            output_begin(count * options.ddt_block);
+            output_string("datatype", type_names[options.ddt]);
+            output_int("block", options.ddt_block);
+            output_int("stride", options.ddt_stride);
+            output_double("datatype_us", latency[path_datatype]);
+            output_double("pack_us", latency[path_pack]);
+            output_double("manual_us", latency[path_manual]);
+            output_int("iterations", options.loop);
+            output_int("warmup", options.skip);
+            output_end();
+
+            if (output_text()) {
+                fprintf(stdout, "%-*d%*.*f%*.*f%*.*f\n", 10,
+                        count * options.ddt_block, FIELD_WIDTH,
+                        FLOAT_PRECISION, latency[path_datatype], FIELD_WIDTH,
+                        FLOAT_PRECISION, latency[path_pack], FIELD_WIDTH,
+                        FLOAT_PRECISION, latency[path_manual]);
+                fflush(stdout);
+            }
+        }
+    }
+
+    osu_free(s_buf);
+    osu_free(r_buf);
+    osu_free(s_packed);
+    osu_free(r_packed);
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
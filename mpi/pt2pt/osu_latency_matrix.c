@@ -0,0 +1,375 @@
+#define BENCHMARK "OSU MPI All-Pairs Latency and Bandwidth Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include <osu_pt2pt.h>
+
+#define WINDOW_SIZE WINDOW_SIZE_LARGE
+#define WORST_PAIRS 10
+
+struct pair {
+    int a;
+    int b;
+    double value;
+};
+
+static char * s_buf, * r_buf;
+
+/*
+ * Round-robin tournament: with n even, rank n - 1 stays in place while the
+ * others rotate, so that every rank meets every other one exactly once in
+ * n - 1 rounds.  Returns the partner of rank in round, n - 1 being the bye
+ * for an odd number of processes.
+ */
+static int
+partner (int rank, int round, int n)
+{
+    int m = n - 1, q;
+
+    if (rank == m) {
+        for (q = 0; 2 * q % m != round; q++);
+
+        return q;
+    }
+
+    q = ((round - rank) % m + m) % m;
+
+    return q == rank ? m : q;
+}
+
+/*
+ * Returns the one-way latency between rank and peer in us, on the lower of
+ * the two ranks.
+ */
+static double
+measure_latency (int rank, int peer)
+{
+    int size = options.lat_size, i;
+    double t_start = 0.0, t_end = 0.0;
+    MPI_Status reqstat;
+
+    for(i = 0; i < options.loop + options.skip; i++) {
+        if(i == options.skip) t_start = MPI_Wtime();
+
+        if(rank < peer) {
+            MPI_Send(s_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD);
+            MPI_Recv(r_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD,
+                    &reqstat);
+        }
+
+        else {
+            MPI_Recv(r_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD,
+                    &reqstat);
+            MPI_Send(s_buf, size, MPI_CHAR, peer, 1, MPI_COMM_WORLD);
+        }
+    }
+
+    t_end = MPI_Wtime();
+
+    return (t_end - t_start) * 1e6 / (2.0 * options.loop);
+}
+
+/*
+ * Returns the bandwidth from the lower to the higher rank in MB/s, on the
+ * lower one.  The test sends a window for every 100 ping-pongs of the
+ * latency test.
+ */
+static double
+measure_bandwidth (int rank, int peer)
+{
+    int size = options.bw_size, i, j;
+    int loop = (options.loop + 99) / 100, skip = (options.skip + 99) / 100;
+    double t_start = 0.0, t_end = 0.0;
+
+    for(i = 0; i < loop + skip; i++) {
+        if(i == skip) t_start = MPI_Wtime();
+
+        if(rank < peer) {
+            for(j = 0; j < WINDOW_SIZE; j++) {
+                MPI_Isend(s_buf, size, MPI_CHAR, peer, 100, MPI_COMM_WORLD,
+                        request + j);
+            }
+
+            MPI_Waitall(WINDOW_SIZE, request, reqstat);
+            MPI_Recv(r_buf, 4, MPI_CHAR, peer, 101, MPI_COMM_WORLD,
+                    &reqstat[0]);
+        }
+
+        else {
+            for(j = 0; j < WINDOW_SIZE; j++) {
+                MPI_Irecv(r_buf, size, MPI_CHAR, peer, 100, MPI_COMM_WORLD,
+                        request + j);
+            }
+
+            MPI_Waitall(WINDOW_SIZE, request, reqstat);
+            MPI_Send(s_buf, 4, MPI_CHAR, peer, 101, MPI_COMM_WORLD);
+        }
+    }
+
+    t_end = MPI_Wtime();
+
+    return size / 1e6 * loop * WINDOW_SIZE / (t_end - t_start);
+}
+
+static int
+compare_pairs (void const * a, void const * b)
+{
+    struct pair const * x = (struct pair const *)a;
+    struct pair const * y = (struct pair const *)b;
+
+    return (x->value > y->value) - (x->value < y->value);
+}
+
+/*
+ * Sorts the pairs of the upper triangle of matrix by increasing value.
+ */
+static void
+sort_pairs (struct pair * pairs, double const * matrix, int n)
+{
+    int i, j, k = 0;
+
+    for (i = 0; i < n; i++) {
+        for (j = i + 1; j < n; j++) {
+            pairs[k].a = i;
+            pairs[k].b = j;
+            pairs[k++].value = matrix[i * n + j];
+        }
+    }
+
+    qsort(pairs, k, sizeof(struct pair), compare_pairs);
+}
+
+static void
+print_worst (char const * label, struct pair * pairs, int count, int highest,
+        char const * hosts)
+{
+    int i;
+
+    printf("\n# %s: min %.*f, median %.*f, max %.*f\n", label,
+            FLOAT_PRECISION, pairs[0].value, FLOAT_PRECISION,
+            pairs[count / 2].value, FLOAT_PRECISION, pairs[count - 1].value);
+    printf("%-*s%*s%*s  %s\n", 10, "# Rank", 10, "Rank", FIELD_WIDTH, label,
+            "Hosts");
+
+    for (i = 0; i < count && i < WORST_PAIRS; i++) {
+        struct pair * p = pairs + (highest ? count - 1 - i : i);
+
+        printf("%-*d%*d%*.*f  %s %s\n", 10, p->a, 10, p->b, FIELD_WIDTH,
+                FLOAT_PRECISION, p->value, hosts + p->a
+                * MPI_MAX_PROCESSOR_NAME, hosts + p->b
+                * MPI_MAX_PROCESSOR_NAME);
+    }
+}
+
+static int
+write_matrix (char const * suffix, double const * matrix, int n)
+{
+    char * filename;
+    FILE * file;
+    int i, j;
+
+    filename = malloc(strlen(options.matrix_file) + strlen(suffix) + 2);
+
+    if (NULL == filename) {
+        return 1;
+    }
+
+    sprintf(filename, "%s.%s", options.matrix_file, suffix);
+
+    if (NULL == (file = fopen(filename, "w"))) {
+        fprintf(stderr, "Could not open matrix file `%s'\n", filename);
+        free(filename);
+        return 1;
+    }
+
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            fprintf(file, "%s%.*f", j ? " " : "", FLOAT_PRECISION,
+                    matrix[i * n + j]);
+        }
+
+        fprintf(file, "\n");
+    }
+
+    fclose(file);
+    free(filename);
+
+    return 0;
+}
+
+int
+main (int argc, char *argv[])
+{
+    int myid, numprocs, rounds, round, peer, length, count, i, j;
+    double * row_lat, * row_bw, * lat = NULL, * bw = NULL;
+    char name[MPI_MAX_PROCESSOR_NAME], * hosts = NULL;
+    struct pair * pairs = NULL;
+    int po_ret = process_options(argc, argv, MATRIX);
+
+    set_header(HEADER);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case po_cuda_not_avail:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case po_openacc_not_avail:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case po_bad_usage:
+            case po_help_message:
+                usage("osu_latency_matrix");
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case po_cuda_not_avail:
+        case po_openacc_not_avail:
+        case po_bad_usage:
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if(numprocs < 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires at least two processes\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    s_buf = osu_malloc(MAX_MSG_SIZE);
+    r_buf = osu_malloc(MAX_MSG_SIZE);
+    row_lat = calloc(numprocs, sizeof(double));
+    row_bw = calloc(numprocs, sizeof(double));
+
+    if (0 == myid) {
+        lat = malloc((size_t)numprocs * numprocs * sizeof(double));
+        bw = malloc((size_t)numprocs * numprocs * sizeof(double));
+        hosts = malloc((size_t)numprocs * MPI_MAX_PROCESSOR_NAME);
+        pairs = malloc((size_t)numprocs * (numprocs - 1) / 2
+                * sizeof(struct pair));
+    }
+
+    if (NULL == s_buf || NULL == r_buf || NULL == row_lat || NULL == row_bw
+            || (0 == myid && (NULL == lat || NULL == bw || NULL == hosts
+                    || NULL == pairs))) {
+        fprintf(stderr, "Error allocating host memory\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    memset(s_buf, 'a', MAX_MSG_SIZE);
+    memset(r_buf, 'b', MAX_MSG_SIZE);
+
+    output_init(MPI_COMM_WORLD);
+
+    /* an odd number of ranks gets a bye in every round */
+    rounds = numprocs + numprocs % 2 - 1;
+
+    if (0 == myid && output_text()) {
+        printf(HEADER);
+        printf("# %d ranks in %d rounds, latency of %d byte messages, "
+                "bandwidth of %d byte messages\n", numprocs, rounds,
+                options.lat_size, options.bw_size);
+
+        if (allocator_selected()) {
+            printf("# Allocator: %s\n", allocator_spec());
+        }
+
+        fflush(stdout);
+    }
+
+    for(round = 0; round < rounds; round++) {
+        peer = partner(myid, round, rounds + 1);
+
+        MPI_Barrier(MPI_COMM_WORLD);
+
+        if(peer < numprocs) {
+            double latency = measure_latency(myid, peer);
+            double bandwidth = measure_bandwidth(myid, peer);
+
+            if(myid < peer) {
+                row_lat[peer] = latency;
+                row_bw[peer] = bandwidth;
+            }
+        }
+    }
+
+    MPI_Gather(row_lat, numprocs, MPI_DOUBLE, lat, numprocs, MPI_DOUBLE, 0,
+            MPI_COMM_WORLD);
+    MPI_Gather(row_bw, numprocs, MPI_DOUBLE, bw, numprocs, MPI_DOUBLE, 0,
+            MPI_COMM_WORLD);
+
+    memset(name, 0, sizeof(name));
+    MPI_Get_processor_name(name, &length);
+    MPI_Gather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, hosts,
+            MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0, MPI_COMM_WORLD);
+
+    if (0 == myid) {
+        /* the lower rank of each pair measured it */
+        for (i = 0; i < numprocs; i++) {
+            for (j = i + 1; j < numprocs; j++) {
+                lat[j * numprocs + i] = lat[i * numprocs + j];
+                bw[j * numprocs + i] = bw[i * numprocs + j];
+
+                output_begin(options.lat_size);
+                output_int("rank_a", i);
+                output_int("rank_b", j);
+                output_double("latency_us", lat[i * numprocs + j]);
+                output_int("bandwidth_size", options.bw_size);
+                output_double("bandwidth_mbps", bw[i * numprocs + j]);
+                output_int("iterations", options.loop);
+                output_int("warmup", options.skip);
+                output_end();
+            }
+        }
+
+        count = numprocs * (numprocs - 1) / 2;
+
+        if (output_text()) {
+            sort_pairs(pairs, lat, numprocs);
+            print_worst("Latency (us)", pairs, count, 1, hosts);
+            sort_pairs(pairs, bw, numprocs);
+            print_worst("Bandwidth (MB/s)", pairs, count, 0, hosts);
+            fflush(stdout);
+        }
+
+        if (options.matrix_file && (write_matrix("latency", lat, numprocs)
+                    || write_matrix("bandwidth", bw, numprocs))) {
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+    }
+
+    free(lat);
+    free(bw);
+    free(hosts);
+    free(pairs);
+    free(row_lat);
+    free(row_bw);
+    osu_free(s_buf);
+    osu_free(r_buf);
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -38,7 +38,7 @@ int main(int argc, char *argv[])
 
     set_header(HEADER);
 
-    int po_ret = process_options(argc, argv, LAT);
+    int po_ret = process_options(argc, argv, LAT_MT);
 
     if (po_okay == po_ret && none != options.accel) {
         if (init_accel()) {
@@ -111,10 +111,15 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    output_init(MPI_COMM_WORLD);
+
     if(myid == 0) {
-        fprintf(stdout, HEADER);
-        fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
-        fflush(stdout);
+        if(output_text()) {
+            fprintf(stdout, HEADER);
+            fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH,
+                    "Latency (us)");
+            fflush(stdout);
+        }
 
         tags[i].id = i;
         pthread_create(&sr_threads[i], NULL, send_thread, &tags[i]);
@@ -161,7 +166,8 @@ void * recv_thread(void *arg) {
         return ret;
     }
 
-    for(size = 0, iter = 0; size <= MAX_MSG_SIZE; size = (size ? size * 2 : 1)) {
+    for(size = first_size(0, MAX_MSG_SIZE), iter = 0; size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
         pthread_mutex_lock(&finished_size_mutex);
 
         if(finished_size == THREADS) {
@@ -231,7 +237,8 @@ void * send_thread(void *arg) {
         return ret;
     }
 
-    for(size = 0, iter = 0; size <= MAX_MSG_SIZE; size = (size ? size * 2 : 1)) {
+    for(size = first_size(0, MAX_MSG_SIZE), iter = 0; size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
         MPI_Barrier(MPI_COMM_WORLD);
 
         if(size > LARGE_MESSAGE_SIZE) {
@@ -259,9 +266,18 @@ void * send_thread(void *arg) {
         t = t_end - t_start;
 
         latency = (t) * 1.0e6 / (2.0 * options.loop);
-        fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH, FLOAT_PRECISION,
-                latency);
-        fflush(stdout);
+
+        output_begin(size);
+        output_double("latency_us", latency);
+        output_int("iterations", options.loop);
+        output_int("warmup", options.skip);
+        output_end();
+
+        if(output_text()) {
+            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
+                    FLOAT_PRECISION, latency);
+            fflush(stdout);
+        }
         iter++;
     }
 
@@ -0,0 +1,358 @@
+#define BENCHMARK "OSU MPI%s Matching Queue Latency Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include <osu_pt2pt.h>
+
+/*
+ * The ping-pong uses PING_TAG.  The queues are filled with receives posted
+ * for, or messages sent with, QUEUE_TAG, so that they never match it.
+ */
+#define PING_TAG    1
+#define QUEUE_TAG   2
+#define FENCE_TAG   3
+
+#define DEFAULT_SIZE "8"
+
+enum position {
+    front,
+    middle,
+    back,
+    NUM_POSITIONS
+};
+
+static char * s_buf, * r_buf;
+static int myid;
+
+/*
+ * Posts ahead receives that never match, followed by the depth - ahead + 1
+ * receives of the ping-pong, which all match its messages.  Each message
+ * completes the first of these, behind the ahead others, and the test posts
+ * it again at the end of the queue, so that the matching receive always
+ * sits at the same position of a queue of depth other receives.  Only one
+ * of the receives sharing r_buf completes at a time.
+ */
+static void
+post_queue (int depth, int ahead, int size, int peer)
+{
+    int i;
+
+    for (i = 0; i < ahead; i++) {
+        MPI_Irecv(r_buf, 0, MPI_CHAR, peer, QUEUE_TAG, MPI_COMM_WORLD,
+                request + i);
+    }
+
+    for (i = ahead; i <= depth; i++) {
+        MPI_Irecv(r_buf, size, MPI_CHAR, peer, PING_TAG, MPI_COMM_WORLD,
+                request + i);
+    }
+}
+
+static void
+cancel_queue (int depth)
+{
+    int i;
+
+    for (i = 0; i <= depth; i++) {
+        MPI_Cancel(request + i);
+    }
+
+    MPI_Waitall(depth + 1, request, reqstat);
+}
+
+/*
+ * Sends depth messages that are not received before the ping-pong and a
+ * fence behind them, which cannot be received before they have arrived.
+ */
+static void
+inject_messages (int depth, int peer)
+{
+    int i;
+
+    for (i = 0; i < depth; i++) {
+        MPI_Isend(s_buf, 0, MPI_CHAR, peer, QUEUE_TAG, MPI_COMM_WORLD,
+                send_request + i);
+    }
+
+    MPI_Sendrecv(s_buf, 0, MPI_CHAR, peer, FENCE_TAG, r_buf, 0, MPI_CHAR,
+            peer, FENCE_TAG, MPI_COMM_WORLD, reqstat);
+}
+
+static void
+drain_messages (int depth, int peer)
+{
+    int i;
+
+    for (i = 0; i < depth; i++) {
+        MPI_Irecv(r_buf, 0, MPI_CHAR, peer, QUEUE_TAG, MPI_COMM_WORLD,
+                recv_request + i);
+    }
+
+    MPI_Waitall(depth, recv_request, reqstat);
+    MPI_Waitall(depth, send_request, reqstat);
+}
+
+/*
+ * Returns the one-way latency in us of size byte messages matched behind
+ * ahead of the depth entries of the queue.
+ */
+static double
+run_queue (int depth, int ahead, int size)
+{
+    double t_start = 0.0, t_end = 0.0;
+    int peer = 1 - myid, head = ahead, i;
+    MPI_Status status;
+
+    if (queue_posted == options.queue) {
+        post_queue(depth, ahead, size, peer);
+    }
+
+    else {
+        inject_messages(depth, peer);
+    }
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if(myid == 0) {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            if(i == options.skip) t_start = MPI_Wtime();
+
+            MPI_Send(s_buf, size, MPI_CHAR, peer, PING_TAG, MPI_COMM_WORLD);
+
+            if(queue_posted == options.queue) {
+                MPI_Wait(request + head, &status);
+                MPI_Irecv(r_buf, size, MPI_CHAR, peer, PING_TAG,
+                        MPI_COMM_WORLD, request + head);
+                head = head == depth ? ahead : head + 1;
+            }
+
+            else {
+                MPI_Recv(r_buf, size, MPI_CHAR, peer, PING_TAG,
+                        MPI_COMM_WORLD, &status);
+            }
+        }
+
+        t_end = MPI_Wtime();
+    }
+
+    else {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            /* repost before replying, so that the next ping finds it */
+            if(queue_posted == options.queue) {
+                MPI_Wait(request + head, &status);
+                MPI_Irecv(r_buf, size, MPI_CHAR, peer, PING_TAG,
+                        MPI_COMM_WORLD, request + head);
+                head = head == depth ? ahead : head + 1;
+            }
+
+            else {
+                MPI_Recv(r_buf, size, MPI_CHAR, peer, PING_TAG,
+                        MPI_COMM_WORLD, &status);
+            }
+
+            MPI_Send(s_buf, size, MPI_CHAR, peer, PING_TAG, MPI_COMM_WORLD);
+        }
+    }
+
+    if (queue_posted == options.queue) {
+        cancel_queue(depth);
+    }
+
+    else {
+        drain_messages(depth, peer);
+    }
+
+    return (t_end - t_start) * 1e6 / (2.0 * options.loop);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int numprocs, size, depth, max_depth = 0, i;
+    double latency[NUM_POSITIONS];
+    enum position position, last;
+    int po_ret = process_options(argc, argv, QUEUE);
+
+    if (po_okay == po_ret && none != options.accel) {
+        if (init_accel()) {
+           fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    set_header(HEADER);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case po_cuda_not_avail:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case po_openacc_not_avail:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case po_bad_usage:
+            case po_help_message:
+                usage("osu_latency_queue");
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case po_cuda_not_avail:
+        case po_openacc_not_avail:
+        case po_bad_usage:
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if(numprocs != 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < options.num_depths; i++) {
+        if (options.depths[i] > max_depth) {
+            max_depth = options.depths[i];
+        }
+    }
+
+    if (grow_requests(max_depth + 1)) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    if (allocate_memory(&s_buf, &r_buf, myid)) {
+        /* Error allocating memory */
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    /* the queue depth is the variable, one message size unless -S is given */
+    if (!sizes_enabled()) {
+        set_sizes(DEFAULT_SIZE);
+    }
+
+    output_init(MPI_COMM_WORLD);
+
+    if (0 == myid && sizes_skipped(MAX_MSG_SIZE)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped(MAX_MSG_SIZE), MAX_MSG_SIZE);
+    }
+
+    last = queue_posted == options.queue ? back : front;
+
+    if (0 == myid && output_text()) {
+        printf(HEADER, "");
+        printf("# Queue: %s\n", queue_posted == options.queue ?
+                "posted receives" : "unexpected messages");
+
+        if (allocator_selected()) {
+            printf("# Allocator: %s\n", allocator_spec());
+        }
+
+        printf("%-*s%*s", 10, "# Size", 10, "Depth");
+
+        if (queue_posted == options.queue) {
+            printf("%*s%*s%*s\n", FIELD_WIDTH, "Front (us)", FIELD_WIDTH,
+                    "Middle (us)", FIELD_WIDTH, "Back (us)");
+        }
+
+        else {
+            printf("%*s\n", FIELD_WIDTH, "Latency (us)");
+        }
+
+        fflush(stdout);
+    }
+
+    for(size = first_size(0, MAX_MSG_SIZE); size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
+        touch_data(s_buf, r_buf, myid, size);
+
+        if(size > LARGE_MESSAGE_SIZE) {
+            options.loop = options.loop_large;
+            options.skip = options.skip_large;
+        }
+
+        for(i = 0; i < options.num_depths; i++) {
+            depth = options.depths[i];
+
+            /*
+             * Posted receives are matched in order, so the number of them
+             * ahead of the matching one sets the search length.  Unexpected
+             * messages always queue up ahead of the ping-pong.
+             */
+            for(position = front; position <= last; position++) {
+                latency[position] = run_queue(depth, front == position ? 0 :
+                        middle == position ? depth / 2 : depth, size);
+            }
+
+            if(myid == 0) {
+                output_begin(size);
+                output_string("queue", queue_posted == options.queue ?
+                        "posted" : "unexpected");
+                output_int("depth", depth);
+
+                if(queue_posted == options.queue) {
+                    output_double("front_us", latency[front]);
+                    output_double("middle_us", latency[middle]);
+                    output_double("back_us", latency[back]);
+                }
+
+                else {
+                    output_double("latency_us", latency[front]);
+                }
+
+                output_int("iterations", options.loop);
+                output_int("warmup", options.skip);
+                output_end();
+
+                if (output_text()) {
+                    fprintf(stdout, "%-*d%*d", 10, size, 10, depth);
+
+                    for(position = front; position <= last; position++) {
+                        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                                latency[position]);
+                    }
+
+                    fprintf(stdout, "\n");
+                    fflush(stdout);
+                }
+            }
+        }
+    }
+
+    free_memory(s_buf, r_buf, myid);
+    MPI_Finalize();
+
+    if (none != options.accel) {
+        if (cleanup_accel()) {
+            fprintf(stderr, "Error cleaning up device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
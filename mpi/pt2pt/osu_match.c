@@ -0,0 +1,326 @@
+#define BENCHMARK "OSU MPI%s Message Matching Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include <osu_pt2pt.h>
+
+#define WINDOW_SIZE 64
+
+enum receive {
+    recv_exact,
+    recv_any_source,
+    recv_any_tag,
+    recv_mprobe,
+    NUM_RECEIVES
+};
+
+static char const * receive_names[] = {
+    "exact", "any_source", "any_tag", "mprobe"
+};
+
+static MPI_Comm comms[MAX_MATCH_COMMS];
+static char * s_buf, * r_buf;
+static int myid, channels, window;
+
+/*
+ * Message i of a run goes to channel i % channels, which is a tag on one of
+ * the communicators.  Both sides walk the channels in the same order, so
+ * that every communicator sees as many sends as receives.
+ */
+#define channel_comm(i) (comms[(i) % channels / options.match_tags])
+#define channel_tag(i)  ((i) % channels % options.match_tags)
+
+/*
+ * Receives message i with an exact or wildcard receive, or with a matched
+ * probe for any source and tag followed by MPI_Mrecv, as task runtimes poll.
+ */
+static void
+receive_message (enum receive receive, int size, int peer, int i)
+{
+    MPI_Message message;
+    MPI_Status status;
+
+    switch (receive) {
+        case recv_exact:
+            MPI_Recv(r_buf, size, MPI_CHAR, peer, channel_tag(i),
+                    channel_comm(i), &status);
+            break;
+        case recv_any_source:
+            MPI_Recv(r_buf, size, MPI_CHAR, MPI_ANY_SOURCE, channel_tag(i),
+                    channel_comm(i), &status);
+            break;
+        case recv_any_tag:
+            MPI_Recv(r_buf, size, MPI_CHAR, peer, MPI_ANY_TAG,
+                    channel_comm(i), &status);
+            break;
+        default:
+            MPI_Mprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, channel_comm(i), &message,
+                    &status);
+            MPI_Mrecv(r_buf, size, MPI_CHAR, &message, &status);
+            break;
+    }
+}
+
+static void
+post_receive (enum receive receive, int size, int peer, int i,
+        MPI_Request * req)
+{
+    MPI_Irecv(r_buf, size, MPI_CHAR, recv_any_source == receive ?
+            MPI_ANY_SOURCE : peer, recv_any_tag == receive ? MPI_ANY_TAG :
+            channel_tag(i), channel_comm(i), req);
+}
+
+/*
+ * Returns the one-way latency of the ping-pong in us.
+ */
+static double
+run_latency (enum receive receive, int size)
+{
+    double t_start = 0.0, t_end = 0.0;
+    int i;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if(myid == 0) {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            if(i == options.skip) t_start = MPI_Wtime();
+
+            MPI_Send(s_buf, size, MPI_CHAR, 1, channel_tag(i),
+                    channel_comm(i));
+            receive_message(receive, size, 1, i);
+        }
+
+        t_end = MPI_Wtime();
+    }
+
+    else if(myid == 1) {
+        for(i = 0; i < options.loop + options.skip; i++) {
+            receive_message(receive, size, 0, i);
+            MPI_Send(s_buf, size, MPI_CHAR, 0, channel_tag(i),
+                    channel_comm(i));
+        }
+    }
+
+    return (t_end - t_start) * 1e6 / (2.0 * options.loop);
+}
+
+/*
+ * Returns the rate in messages per second at which rank 1 receives windows
+ * of back-to-back messages over all channels.  Receives are posted ahead
+ * for all windows but those received through matched probes, which can only
+ * find messages that have arrived.  The test sends as many messages as the
+ * latency test.
+ */
+static double
+run_rate (enum receive receive, int size)
+{
+    int windows = (options.loop + window - 1) / window;
+    int skip = (options.skip + window - 1) / window;
+    double t_start = 0.0, t_end = 0.0;
+    int i, j;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if(myid == 0) {
+        for(i = 0; i < windows + skip; i++) {
+            if(i == skip) t_start = MPI_Wtime();
+
+            for(j = 0; j < window; j++) {
+                MPI_Isend(s_buf, size, MPI_CHAR, 1, channel_tag(j),
+                        channel_comm(j), request + j);
+            }
+
+            MPI_Waitall(window, request, reqstat);
+            MPI_Recv(r_buf, 0, MPI_CHAR, 1, 0, MPI_COMM_WORLD, &reqstat[0]);
+        }
+
+        t_end = MPI_Wtime();
+    }
+
+    else if(myid == 1) {
+        for(i = 0; i < windows + skip; i++) {
+            if(recv_mprobe == receive) {
+                for(j = 0; j < window; j++) {
+                    receive_message(receive, size, 0, j);
+                }
+            }
+
+            else {
+                for(j = 0; j < window; j++) {
+                    post_receive(receive, size, 0, j, request + j);
+                }
+
+                MPI_Waitall(window, request, reqstat);
+            }
+
+            MPI_Send(s_buf, 0, MPI_CHAR, 0, 0, MPI_COMM_WORLD);
+        }
+    }
+
+    return myid == 0 ? (double)window * windows / (t_end - t_start) : 0.0;
+}
+
+int
+main (int argc, char *argv[])
+{
+    int numprocs, size, i;
+    double latency[NUM_RECEIVES], rate[NUM_RECEIVES];
+    enum receive receive;
+    int po_ret = process_options(argc, argv, MATCH);
+
+    if (po_okay == po_ret && none != options.accel) {
+        if (init_accel()) {
+           fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    set_header(HEADER);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case po_cuda_not_avail:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case po_openacc_not_avail:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case po_bad_usage:
+            case po_help_message:
+                usage("osu_match");
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case po_cuda_not_avail:
+        case po_openacc_not_avail:
+        case po_bad_usage:
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if(numprocs != 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    /* keep every channel in flight in each window */
+    channels = options.match_tags * options.match_comms;
+    window = channels > WINDOW_SIZE ? channels : WINDOW_SIZE;
+
+    if (grow_requests(window)) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    if (allocate_memory(&s_buf, &r_buf, myid)) {
+        /* Error allocating memory */
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    for (i = 0; i < options.match_comms; i++) {
+        MPI_Comm_dup(MPI_COMM_WORLD, comms + i);
+    }
+
+    output_init(MPI_COMM_WORLD);
+
+    if (0 == myid && sizes_skipped(MAX_MSG_SIZE)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped(MAX_MSG_SIZE), MAX_MSG_SIZE);
+    }
+
+    if (0 == myid && output_text()) {
+        printf(HEADER, "");
+        printf("# Tags: %d, communicators: %d, window: %d messages\n",
+                options.match_tags, options.match_comms, window);
+
+        if (allocator_selected()) {
+            printf("# Allocator: %s\n", allocator_spec());
+        }
+
+        printf("%-*s%*s%*s%*s\n", 10, "# Size", FIELD_WIDTH, "Receive",
+                FIELD_WIDTH, "Latency (us)", FIELD_WIDTH, "Messages/s");
+        fflush(stdout);
+    }
+
+    for(size = first_size(0, MAX_MSG_SIZE); size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
+        touch_data(s_buf, r_buf, myid, size);
+
+        if(size > LARGE_MESSAGE_SIZE) {
+            options.loop = options.loop_large;
+            options.skip = options.skip_large;
+        }
+
+        for(receive = recv_exact; receive < NUM_RECEIVES; receive++) {
+            latency[receive] = run_latency(receive, size);
+            rate[receive] = run_rate(receive, size);
+        }
+
+        if(myid != 0) {
+            continue;
+        }
+
+        for(receive = recv_exact; receive < NUM_RECEIVES; receive++) {
+            output_begin(size);
+            output_string("receive", receive_names[receive]);
+            output_int("tags", options.match_tags);
+            output_int("communicators", options.match_comms);
+            output_double("latency_us", latency[receive]);
+            output_double("messages_per_second", rate[receive]);
+            output_int("iterations", options.loop);
+            output_int("warmup", options.skip);
+            output_end();
+
+            if (output_text()) {
+                fprintf(stdout, "%-*d%*s%*.*f%*.*f\n", 10, size, FIELD_WIDTH,
+                        receive_names[receive], FIELD_WIDTH, FLOAT_PRECISION,
+                        latency[receive], FIELD_WIDTH, FLOAT_PRECISION,
+                        rate[receive]);
+            }
+        }
+
+        fflush(stdout);
+    }
+
+    for (i = 0; i < options.match_comms; i++) {
+        MPI_Comm_free(comms + i);
+    }
+
+    free_memory(s_buf, r_buf, myid);
+    MPI_Finalize();
+
+    if (none != options.accel) {
+        if (cleanup_accel()) {
+            fprintf(stderr, "Error cleaning up device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -16,6 +16,9 @@
 #include <string.h>
 #include <assert.h>
 
+#include "osu_alloc.h"
+#include "osu_sizes.h"
+
 #define DEFAULT_WINDOW       (64)
 
 #define ITERS_SMALL          (100)          
@@ -48,8 +51,7 @@ static int skip_override;
 
 int main(int argc, char *argv[])
 {
-    char *s_buf, *r_buf;
-    unsigned long align_size = sysconf(_SC_PAGESIZE);
+    char *s_buf = NULL, *r_buf = NULL;
     int numprocs, rank;
     int pairs, print_rate;
     int window_size, window_varied;
@@ -69,7 +71,7 @@ int main(int argc, char *argv[])
     window_varied    = 0;
     print_rate       = 1;
 
-    while((c = getopt(argc, argv, "p:w:r:x:i:vh")) != -1) {
+    while((c = getopt(argc, argv, "p:w:r:x:i:a:S:vh")) != -1) {
         switch (c) {
             case 'i':
                 loop = atoi(optarg);
@@ -100,6 +102,28 @@ int main(int argc, char *argv[])
                 window_varied = 1;
                 break;
 
+            case 'a':
+                if(set_allocator(optarg)) {
+                    if(0 == rank) {
+                        usage();
+                    }
+
+                    goto error;
+                }
+
+                break;
+
+            case 'S':
+                if(set_sizes(optarg)) {
+                    if(0 == rank) {
+                        usage();
+                    }
+
+                    goto error;
+                }
+
+                break;
+
             case 'r':
                 print_rate = atoi(optarg);
 
@@ -122,12 +146,12 @@ int main(int argc, char *argv[])
         }
     }
 
-    if (posix_memalign((void**)&s_buf, align_size, MAX_MSG_SIZE)) {
+    if (NULL == (s_buf = osu_malloc(MAX_MSG_SIZE))) {
         fprintf(stderr, "Error allocating host memory\n");
         return 1;
     }
 
-    if (posix_memalign((void**)&r_buf, align_size, MAX_MSG_SIZE)) {
+    if (NULL == (r_buf = osu_malloc(MAX_MSG_SIZE))) {
         fprintf(stderr, "Error allocating host memory\n");
         return 1;
     }
@@ -142,9 +166,18 @@ int main(int argc, char *argv[])
         return EXIT_FAILURE;
     }
 
+    if(rank == 0 && sizes_skipped(MAX_MSG_SIZE)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped(MAX_MSG_SIZE), MAX_MSG_SIZE);
+    }
+
     if(rank == 0) {
         fprintf(stdout, HEADER);
 
+        if(allocator_selected()) {
+            fprintf(stdout, "# Allocator: %s\n", allocator_spec());
+        }
+
         if(window_varied) {
             fprintf(stdout, "# [ pairs: %d ] [ window size: varied ]\n", pairs);
             fprintf(stdout, "\n# Uni-directional Bandwidth (MB/sec)\n");
@@ -172,7 +205,7 @@ int main(int argc, char *argv[])
    if(window_varied) {
        int window_array[] = WINDOW_SIZES;
        double ** bandwidth_results;
-       int log_val = 1, tmp_message_size = MAX_MSG_SIZE;
+       int num_sizes = 0;
        int i, j;
 
        for(i = 0; i < WINDOW_SIZES_COUNT; i++) {
@@ -184,13 +217,14 @@ int main(int argc, char *argv[])
        request = (MPI_Request *) malloc(sizeof(MPI_Request) * window_size);
        reqstat = (MPI_Status *) malloc(sizeof(MPI_Status) * window_size);
 
-       while(tmp_message_size >>= 1) {
-           log_val++;
+       for(curr_size = first_size(1, MAX_MSG_SIZE); curr_size <= MAX_MSG_SIZE;
+               curr_size = next_size(curr_size, MAX_MSG_SIZE)) {
+           num_sizes++;
        }
 
-       bandwidth_results = (double **) malloc(sizeof(double *) * log_val);
+       bandwidth_results = (double **) malloc(sizeof(double *) * num_sizes);
 
-       for(i = 0; i < log_val; i++) {
+       for(i = 0; i < num_sizes; i++) {
            bandwidth_results[i] = (double *)malloc(sizeof(double) *
                    WINDOW_SIZES_COUNT);
        }
@@ -206,7 +240,9 @@ int main(int argc, char *argv[])
            fflush(stdout);
        }
     
-       for(j = 0, curr_size = 1; curr_size <= MAX_MSG_SIZE; curr_size *= 2, j++) {
+       for(j = 0, curr_size = first_size(1, MAX_MSG_SIZE);
+               curr_size <= MAX_MSG_SIZE;
+               curr_size = next_size(curr_size, MAX_MSG_SIZE), j++) {
            if(rank == 0) {
                fprintf(stdout, "%-7d", curr_size);
            }
@@ -238,7 +274,9 @@ int main(int argc, char *argv[])
             fprintf(stdout, "\n");
             fflush(stdout);
 
-            for(c = 0, curr_size = 1; curr_size <= MAX_MSG_SIZE; curr_size *= 2) { 
+            for(c = 0, curr_size = first_size(1, MAX_MSG_SIZE);
+                    curr_size <= MAX_MSG_SIZE;
+                    curr_size = next_size(curr_size, MAX_MSG_SIZE)) {
                 fprintf(stdout, "%-7d", curr_size); 
 
                 for(i = 0; i < WINDOW_SIZES_COUNT; i++) {
@@ -259,7 +297,8 @@ int main(int argc, char *argv[])
        request = (MPI_Request *)malloc(sizeof(MPI_Request) * window_size);
        reqstat = (MPI_Status *)malloc(sizeof(MPI_Status) * window_size);
 
-       for(curr_size = 1; curr_size <= MAX_MSG_SIZE; curr_size *= 2) {
+       for(curr_size = first_size(1, MAX_MSG_SIZE); curr_size <= MAX_MSG_SIZE;
+               curr_size = next_size(curr_size, MAX_MSG_SIZE)) {
            double bw, rate;
 
            bw = calc_bw(rank, curr_size, pairs, window_size, s_buf, r_buf);
@@ -282,8 +321,8 @@ int main(int argc, char *argv[])
    }
 
 error:
-   free(r_buf);
-   free(s_buf);
+   osu_free(r_buf);
+   osu_free(s_buf);
 
    MPI_Finalize();
 
@@ -298,6 +337,10 @@ void usage() {
     printf("                   [cannot be used with -v]\n");
     printf("  -v               Vary the window size (default no)\n");
     printf("                   [cannot be used with -w]\n");
+    printf("  -a=<spec>        Host buffer allocator, one per rank: default, 4k, 2m,\n");
+    printf("                   1g or mpi, optionally followed by :<numa node>\n");
+    printf("  -S=<sizes>       Message sizes instead of the powers of two, e.g.\n");
+    printf("                   1k:64k:x1.5,1m (see the README)\n");
     printf("  -h               Print this help\n");
     printf("\n");
     printf("  Note: This benchmark relies on block ordering of the ranks.  Please see\n");
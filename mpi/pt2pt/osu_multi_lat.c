@@ -20,11 +20,10 @@ static void multi_latency(int rank, int pairs);
 
 int main(int argc, char* argv[])
 {
-    unsigned long align_size = sysconf(_SC_PAGESIZE);
     int rank, nprocs; 
-    int pairs;
+    int pairs, i;
 
-    int po_ret = process_options(argc, argv, LAT);
+    int po_ret = process_options(argc, argv, MULTI_LAT);
 
     if (po_okay == po_ret && none != options.accel) {
         if (init_accel()) {
@@ -70,12 +69,12 @@ int main(int argc, char* argv[])
             break;
     }
 
-    if (posix_memalign((void**)&s_buf, align_size, MAX_MSG_SIZE)) {
+    if (NULL == (s_buf = osu_malloc(MAX_MSG_SIZE))) {
         fprintf(stderr, "Error allocating host memory\n");
         return EXIT_FAILURE;
     }
 
-    if (posix_memalign((void**)&r_buf, align_size, MAX_MSG_SIZE)) {
+    if (NULL == (r_buf = osu_malloc(MAX_MSG_SIZE))) {
         fprintf(stderr, "Error allocating host memory\n");
         return EXIT_FAILURE;
     }
@@ -83,9 +82,52 @@ int main(int argc, char* argv[])
     memset(s_buf, 0, MAX_MSG_SIZE);
     memset(r_buf, 0, MAX_MSG_SIZE);
 
-    if(rank == 0) {
+    if (options.show_full && allocate_samples()) {
+        MPI_Finalize();
+        return EXIT_FAILURE;
+    }
+
+    output_init(MPI_COMM_WORLD);
+    counters_init(MPI_COMM_WORLD);
+    pvars_init(MPI_COMM_WORLD);
+
+    if(rank == 0 && output_text()) {
         fprintf(stdout, HEADER);
-        fprintf(stdout, "%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+
+        if (allocator_selected()) {
+            fprintf(stdout, "# Allocator: %s\n", allocator_spec());
+        }
+
+        if (counters_count()) {
+            fprintf(stdout, "# Counters are per iteration averages over all "
+                    "ranks\n");
+        }
+
+        if (pvars_count()) {
+            fprintf(stdout, "# MPI_T variables are combined over all ranks "
+                    "for every message size\n");
+        }
+
+        fprintf(stdout, "%-*s%*s", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+
+        if (options.show_full) {
+            fprintf(stdout, "%*s%*s%*s%*s%*s%*s", FIELD_WIDTH, "Min (us)",
+                    FIELD_WIDTH, "P50 (us)", FIELD_WIDTH, "P90 (us)",
+                    FIELD_WIDTH, "P99 (us)", FIELD_WIDTH, "P99.9 (us)",
+                    FIELD_WIDTH, "Max (us)");
+        }
+
+        for (i = 0; i < counters_count(); i++) {
+            fprintf(stdout, "%*s", FIELD_WIDTH, counters_label(i));
+        }
+
+        pvars_print_labels(stdout);
+
+        if (adaptive_enabled()) {
+            fprintf(stdout, "%*s%*s", 12, "Iterations", 12, "Warmup");
+        }
+
+        fprintf(stdout, "\n");
         fflush(stdout);
     }
 
@@ -95,10 +137,11 @@ int main(int argc, char* argv[])
     
     MPI_Barrier(MPI_COMM_WORLD);
 
-    MPI_Finalize();
+    free_samples();
+    osu_free(r_buf);
+    osu_free(s_buf);
 
-    free(r_buf);
-    free(s_buf);
+    MPI_Finalize();
 
     return EXIT_SUCCESS;
 }
@@ -107,14 +150,16 @@ static void multi_latency(int rank, int pairs)
 {
     int size, partner;
     int i;
-    double t_start = 0.0, t_end = 0.0,
+    double t_start = 0.0, t_end = 0.0, t_iter = 0.0,
            latency = 0.0, total_lat = 0.0,
            avg_lat = 0.0;
+    struct stats_t stats;
 
     MPI_Status reqstat;
 
 
-    for(size = 0; size <= MAX_MSG_SIZE; size  = (size ? size * 2 : 1)) {
+    for(size = first_size(0, MAX_MSG_SIZE); size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
 
         MPI_Barrier(MPI_COMM_WORLD);
 
@@ -126,6 +171,9 @@ static void multi_latency(int rank, int pairs)
             options.skip = options.skip;
         }
 
+        adaptive_schedule_pt2pt();
+        pvars_begin();
+
         if (rank < pairs) {
             partner = rank + pairs;
 
@@ -134,14 +182,29 @@ static void multi_latency(int rank, int pairs)
                 if (i == options.skip) {
                     t_start = MPI_Wtime();
                     MPI_Barrier(MPI_COMM_WORLD);
+                    counters_reset();
+                    counters_start();
+                }
+
+                if (options.show_full || adaptive_enabled()) {
+                    t_iter = MPI_Wtime();
                 }
 
                 MPI_Send(s_buf, size, MPI_CHAR, partner, 1, MPI_COMM_WORLD);
                 MPI_Recv(r_buf, size, MPI_CHAR, partner, 1, MPI_COMM_WORLD,
                          &reqstat);
+
+                if (options.show_full && i >= options.skip) {
+                    samples[i - options.skip] = MPI_Wtime() - t_iter;
+                }
+
+                if (adaptive_enabled()) {
+                    adaptive_finish_pt2pt(MPI_Wtime() - t_iter);
+                }
             }
 
             t_end = MPI_Wtime();
+            counters_stop();
 
         } else {
             partner = rank - pairs;
@@ -151,28 +214,44 @@ static void multi_latency(int rank, int pairs)
                 if (i == options.skip) {
                     t_start = MPI_Wtime();
                     MPI_Barrier(MPI_COMM_WORLD);
+                    counters_reset();
+                    counters_start();
+                }
+
+                if (adaptive_enabled()) {
+                    t_iter = MPI_Wtime();
                 }
 
                 MPI_Recv(r_buf, size, MPI_CHAR, partner, 1, MPI_COMM_WORLD,
                          &reqstat);
                 MPI_Send(s_buf, size, MPI_CHAR, partner, 1, MPI_COMM_WORLD);
+
+                if (adaptive_enabled()) {
+                    adaptive_finish_pt2pt(MPI_Wtime() - t_iter);
+                }
             }
 
             t_end = MPI_Wtime();
+            counters_stop();
         }
 
-        latency = (t_end - t_start) * 1.0e6 / (2.0 * options.loop);
+        latency = (adaptive_enabled() ? adaptive_elapsed() : t_end - t_start)
+            * 1.0e6 / (2.0 * options.loop);
 
         MPI_Reduce(&latency, &total_lat, 1, MPI_DOUBLE, MPI_SUM, 0, 
                    MPI_COMM_WORLD);
 
         avg_lat = total_lat/(double) (pairs * 2);
 
-        if(0 == rank) {
-            fprintf(stdout, "%-*d%*.*f\n", 10, size, FIELD_WIDTH,
-                    FLOAT_PRECISION, avg_lat);
-            fflush(stdout);
+        counters_reduce(options.loop, MPI_COMM_WORLD);
+        pvars_end(MPI_COMM_WORLD);
+
+        if (options.show_full) {
+            calculate_stats(&stats, rank < pairs ? options.loop : 0,
+                    1.0e6 / 2.0, MPI_COMM_WORLD);
         }
+
+        print_stats(rank, size, avg_lat, &stats);
     }
 }
 
@@ -0,0 +1,396 @@
+#define BENCHMARK "OSU MPI Partitioned Communication Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+
+#include <osu_pt2pt.h>
+#include <pthread.h>
+
+typedef struct thread_tag  {
+        int id;
+} thread_tag_t;
+
+#if MPI_VERSION >= 4
+static char * s_buf, * r_buf;
+static double * arrival;
+static int partition_size, partitioned, running = 1;
+static MPI_Request partitioned_request;
+static pthread_barrier_t start_barrier, done_barrier;
+
+static void
+compute (double seconds)
+{
+    double t_start = MPI_Wtime();
+
+    while (MPI_Wtime() - t_start < seconds);
+}
+
+/*
+ * Every thread fills its partition of the send buffer once per iteration
+ * and marks it ready at once when the buffer goes out in partitions.  With
+ * -w thread t computes for t times the imbalance before it starts, so that
+ * the partitions become ready one after the other.
+ */
+static void *
+fill_thread (void * arg)
+{
+    thread_tag_t * tag = (thread_tag_t *)arg;
+
+    for (;;) {
+        pthread_barrier_wait(&start_barrier);
+
+        if (!running) {
+            break;
+        }
+
+        compute(tag->id * options.imbalance / 1e6);
+        memset(s_buf + (size_t)tag->id * partition_size, 'a' + tag->id % 26,
+                partition_size);
+
+        if (partitioned) {
+            MPI_Pready(tag->id, partitioned_request);
+        }
+
+        pthread_barrier_wait(&done_barrier);
+    }
+
+    return NULL;
+}
+
+/*
+ * Returns the time from releasing the threads until the receiver
+ * acknowledged the whole buffer.  Without partitions the buffer goes out in
+ * a single MPI_Isend once all threads are done, and fill is set to the time
+ * they took.
+ */
+static double
+send_buffer (double * fill)
+{
+    double t_start = MPI_Wtime();
+
+    if(partitioned) {
+        MPI_Start(&partitioned_request);
+    }
+
+    pthread_barrier_wait(&start_barrier);
+    pthread_barrier_wait(&done_barrier);
+    *fill = MPI_Wtime() - t_start;
+
+    if(partitioned) {
+        MPI_Wait(&partitioned_request, reqstat);
+    }
+
+    else {
+        MPI_Isend(s_buf, partition_size * options.threads, MPI_CHAR, 1, 100,
+                MPI_COMM_WORLD, request);
+        MPI_Wait(request, reqstat);
+    }
+
+    MPI_Recv(r_buf, 0, MPI_CHAR, 1, 101, MPI_COMM_WORLD, reqstat);
+
+    return MPI_Wtime() - t_start;
+}
+
+/*
+ * Returns how long on average the partitions had arrived before the whole
+ * buffer was complete, which is what a receiver consuming partitions as
+ * they arrive gains.  A single message has all of it arrive at once.
+ */
+static double
+receive_buffer (void)
+{
+    double t_done, early = 0.0;
+    int arrived = 0, flag, p;
+
+    if(!partitioned) {
+        MPI_Recv(r_buf, partition_size * options.threads, MPI_CHAR, 0, 100,
+                MPI_COMM_WORLD, reqstat);
+        MPI_Send(s_buf, 0, MPI_CHAR, 0, 101, MPI_COMM_WORLD);
+
+        return 0.0;
+    }
+
+    MPI_Start(&partitioned_request);
+
+    for(p = 0; p < options.threads; p++) {
+        arrival[p] = -1.0;
+    }
+
+    while(arrived < options.threads) {
+        for(p = 0; p < options.threads; p++) {
+            if(arrival[p] >= 0.0) continue;
+
+            MPI_Parrived(partitioned_request, p, &flag);
+
+            if(flag) {
+                arrival[p] = MPI_Wtime();
+                arrived++;
+            }
+        }
+    }
+
+    MPI_Wait(&partitioned_request, reqstat);
+    t_done = MPI_Wtime();
+
+    for(p = 0; p < options.threads; p++) {
+        early += t_done - arrival[p];
+    }
+
+    MPI_Send(s_buf, 0, MPI_CHAR, 0, 101, MPI_COMM_WORLD);
+
+    return early / options.threads;
+}
+#endif
+
+int
+main (int argc, char *argv[])
+{
+    int numprocs, provided, myid, err;
+    int po_ret = process_options(argc, argv, PARTITIONED);
+#if MPI_VERSION >= 4
+    pthread_t * threads = NULL;
+    thread_tag_t * tags = NULL;
+    double elapsed[2], fill, t_fill, early, local_early, overlap, t;
+    int size, i;
+#endif
+
+    set_header(HEADER);
+
+    err = MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+
+    if(err != MPI_SUCCESS) {
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case po_cuda_not_avail:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case po_openacc_not_avail:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case po_bad_usage:
+            case po_help_message:
+                usage("osu_partitioned");
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case po_cuda_not_avail:
+        case po_openacc_not_avail:
+        case po_bad_usage:
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if(numprocs != 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+#if MPI_VERSION < 4
+    /* nothing to measure, but not an error either */
+    if(myid == 0) {
+        fprintf(stderr, "Partitioned communication is not supported by this "
+                "MPI library (MPI %d.%d), skipping the test\n", MPI_VERSION,
+                MPI_SUBVERSION);
+    }
+
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+#else
+    if(provided != MPI_THREAD_MULTIPLE) {
+        if(myid == 0) {
+            fprintf(stderr,
+                "MPI_Init_thread must return MPI_THREAD_MULTIPLE!\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    s_buf = osu_malloc(MAX_MSG_SIZE);
+    r_buf = osu_malloc(MAX_MSG_SIZE);
+    arrival = malloc(options.threads * sizeof(double));
+    threads = malloc(options.threads * sizeof(pthread_t));
+    tags = malloc(options.threads * sizeof(thread_tag_t));
+
+    if (NULL == s_buf || NULL == r_buf || NULL == arrival || NULL == threads
+            || NULL == tags) {
+        fprintf(stderr, "Error allocating host memory\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    memset(s_buf, 'a', MAX_MSG_SIZE);
+    memset(r_buf, 'b', MAX_MSG_SIZE);
+
+    /* the threads live across all iterations, their start is not timed */
+    if(myid == 0) {
+        pthread_barrier_init(&start_barrier, NULL, options.threads + 1);
+        pthread_barrier_init(&done_barrier, NULL, options.threads + 1);
+
+        for(i = 0; i < options.threads; i++) {
+            tags[i].id = i;
+            pthread_create(&threads[i], NULL, fill_thread, &tags[i]);
+        }
+    }
+
+    output_init(MPI_COMM_WORLD);
+
+    if (0 == myid && sizes_skipped(MAX_MSG_SIZE)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped(MAX_MSG_SIZE), MAX_MSG_SIZE);
+    }
+
+    if(myid == 0 && output_text()) {
+        fprintf(stdout, HEADER);
+        fprintf(stdout, "# Threads: %d, imbalance: %d us per thread, "
+                "partitions of size / threads bytes\n", options.threads,
+                options.imbalance);
+        fprintf(stdout, "# Times from starting the threads until the receiver "
+                "has the buffer, Isend\n# after all threads joined, overlap "
+                "of the transfer with the fill\n");
+
+        if (allocator_selected()) {
+            fprintf(stdout, "# Allocator: %s\n", allocator_spec());
+        }
+
+        fprintf(stdout, "%-*s%*s%*s%*s%*s%*s\n", 10, "# Size", FIELD_WIDTH,
+                "Partitioned (us)", FIELD_WIDTH, "Isend (us)", FIELD_WIDTH,
+                "Fill (us)", FIELD_WIDTH, "Overlap (%)", FIELD_WIDTH,
+                "Early-bird (us)");
+        fflush(stdout);
+    }
+
+    for(size = first_size(options.threads, MAX_MSG_SIZE); size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
+        if(size > LARGE_MESSAGE_SIZE) {
+            options.loop = options.loop_large;
+            options.skip = options.skip_large;
+        }
+
+        partition_size = size / options.threads;
+
+        if(myid == 0) {
+            MPI_Psend_init(s_buf, options.threads, partition_size, MPI_CHAR,
+                    1, 100, MPI_COMM_WORLD, MPI_INFO_NULL,
+                    &partitioned_request);
+        }
+
+        else {
+            MPI_Precv_init(r_buf, options.threads, partition_size, MPI_CHAR,
+                    0, 100, MPI_COMM_WORLD, MPI_INFO_NULL,
+                    &partitioned_request);
+        }
+
+        fill = 0.0;
+        local_early = 0.0;
+
+        for(partitioned = 1; partitioned >= 0; partitioned--) {
+            elapsed[partitioned] = 0.0;
+            MPI_Barrier(MPI_COMM_WORLD);
+
+            for(i = 0; i < options.loop + options.skip; i++) {
+                if(myid == 0) {
+                    t = send_buffer(&t_fill);
+
+                    if(i >= options.skip) {
+                        elapsed[partitioned] += t;
+                        if(!partitioned) fill += t_fill;
+                    }
+                }
+
+                else {
+                    t = receive_buffer();
+                    if(i >= options.skip) local_early += t;
+                }
+            }
+        }
+
+        MPI_Request_free(&partitioned_request);
+        MPI_Reduce(&local_early, &early, 1, MPI_DOUBLE, MPI_SUM, 0,
+                MPI_COMM_WORLD);
+
+        if(myid != 0) {
+            continue;
+        }
+
+        elapsed[0] *= 1e6 / options.loop;
+        elapsed[1] *= 1e6 / options.loop;
+        fill *= 1e6 / options.loop;
+        early *= 1e6 / options.loop;
+
+        /* the share of the transfer the partitions hid behind the fill */
+        overlap = elapsed[0] > fill ? 100.0 * (elapsed[0] - elapsed[1])
+            / (elapsed[0] - fill) : 0.0;
+        overlap = overlap > 0.0 ? overlap : 0.0;
+
+        output_begin(size);
+        output_int("threads", options.threads);
+        output_int("imbalance_us", options.imbalance);
+        output_double("partitioned_us", elapsed[1]);
+        output_double("isend_us", elapsed[0]);
+        output_double("fill_us", fill);
+        output_double("overlap_pct", overlap);
+        output_double("early_bird_us", early);
+        output_int("iterations", options.loop);
+        output_int("warmup", options.skip);
+        output_end();
+
+        if(output_text()) {
+            fprintf(stdout, "%-*d%*.*f%*.*f%*.*f%*.*f%*.*f\n", 10, size,
+                    FIELD_WIDTH, FLOAT_PRECISION, elapsed[1], FIELD_WIDTH,
+                    FLOAT_PRECISION, elapsed[0], FIELD_WIDTH, FLOAT_PRECISION,
+                    fill, FIELD_WIDTH, FLOAT_PRECISION, overlap, FIELD_WIDTH,
+                    FLOAT_PRECISION, early);
+            fflush(stdout);
+        }
+    }
+
+    if(myid == 0) {
+        running = 0;
+        pthread_barrier_wait(&start_barrier);
+
+        for(i = 0; i < options.threads; i++) {
+            pthread_join(threads[i], NULL);
+        }
+
+        pthread_barrier_destroy(&start_barrier);
+        pthread_barrier_destroy(&done_barrier);
+    }
+
+    free(threads);
+    free(tags);
+    free(arrival);
+    osu_free(s_buf);
+    osu_free(r_buf);
+    MPI_Finalize();
+
+    return EXIT_SUCCESS;
+#endif
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -13,10 +13,19 @@
  */
 #include "osu_pt2pt.h"
 
-MPI_Request request[MAX_REQ_NUM];
-MPI_Status  reqstat[MAX_REQ_NUM];
-MPI_Request send_request[MAX_REQ_NUM];
-MPI_Request recv_request[MAX_REQ_NUM];
+static MPI_Request request_array[MAX_REQ_NUM];
+static MPI_Status  reqstat_array[MAX_REQ_NUM];
+static MPI_Request send_request_array[MAX_REQ_NUM];
+static MPI_Request recv_request_array[MAX_REQ_NUM];
+static int num_requests = MAX_REQ_NUM;
+
+MPI_Request * request = request_array;
+MPI_Status  * reqstat = reqstat_array;
+MPI_Request * send_request = send_request_array;
+MPI_Request * recv_request = recv_request_array;
+
+double * samples = NULL;
+static unsigned long long histogram[HIST_BUCKETS];
 
 #ifdef _ENABLE_CUDA_
 CUcontext cuContext;
@@ -24,6 +33,22 @@ CUcontext cuContext;
 
 static char const * benchmark_header = NULL;
 static int benchmark_type;
+static double comparison_value, comparison_saved;
+static double mode_latency[NUM_SEND_MODES];
+static char const * mode_names[] = {
+    "send", "ssend", "bsend", "rsend", "test", "wait"
+};
+static char const * mode_labels[] = {
+    "Send (us)", "Ssend (us)", "Bsend (us)", "Rsend (us)",
+    "Isend+Test (us)", "Isend+Wait (us)"
+};
+static char const * mode_fields[] = {
+    "send_latency_us", "ssend_latency_us", "bsend_latency_us",
+    "rsend_latency_us", "test_latency_us", "wait_latency_us"
+};
+char const * halo_method_names[] = {
+    "isend", "sendrecv", "alltoallw"
+};
 struct options_t options;
 
 void
@@ -38,10 +63,53 @@ static struct {
     int opt;
 } bad_usage;
 
+/*
+ * The options each benchmark type accepts besides -d, -x, -i, -o and -h,
+ * indexed by the type.  usage() lists and process_options() accepts only
+ * these.
+ */
+static char const * const type_options[] = {
+    "SWpcaCPTf",        /* BW */
+    "SepcaCPTf",        /* LAT */
+    "Sta",              /* DDT */
+    "SqQa",             /* QUEUE */
+    "Sga",              /* MATCH */
+    "Ska",              /* INCAST */
+    "sFa",              /* MATRIX */
+    "SRa",              /* BISECT */
+    "DBHNMbaf",         /* HALO */
+    "Snwa",             /* PARTITIONED */
+    "S",                /* LAT_MT */
+    "SaCPTf",           /* MULTI_LAT */
+    "Sca"               /* THRESHOLDS */
+};
+
+static int
+supported (int opt)
+{
+    return NULL != strchr("dxioh", opt)
+        || NULL != strchr(type_options[benchmark_type], opt);
+}
 
 void
 usage (char const * name)
 {
+    if (bad_usage.message) {
+        if (bad_usage.optarg) {
+            fprintf(stderr, "%s [-%c %s]\n\n", bad_usage.message,
+                    (char)bad_usage.opt, bad_usage.optarg);
+        }
+
+        else if (bad_usage.opt) {
+            fprintf(stderr, "%s [-%c]\n\n", bad_usage.message,
+                    (char)bad_usage.opt);
+        }
+
+        else {
+            fprintf(stderr, "%s\n\n", bad_usage.message);
+        }
+    }
+
     if (CUDA_ENABLED || OPENACC_ENABLED) {
         printf("Usage: %s [options] [RANK0 RANK1]\n\n", name);
         printf("RANK0 and RANK1 may be `D', `H', or 'M' which specifies whether\n"
@@ -62,9 +130,132 @@ usage (char const * name)
 
     printf("  -x ITER       number of warmup iterations to skip before timing"
             "(default %d)\n",
-            benchmark_type == BW ? BW_SKIP_SMALL : LAT_SKIP_SMALL);
+            benchmark_type == BW || benchmark_type == INCAST ? BW_SKIP_SMALL :
+            benchmark_type == QUEUE ? QUEUE_SKIP : benchmark_type == MATRIX ?
+            MATRIX_SKIP : benchmark_type == BISECT ? BISECT_SKIP_SMALL :
+            benchmark_type == HALO ? HALO_SKIP_SMALL :
+            benchmark_type == PARTITIONED ? PART_SKIP_SMALL : LAT_SKIP_SMALL);
     printf("  -i ITER       number of iterations for timing (default %d)\n",
-            benchmark_type == BW ? BW_LOOP_SMALL : LAT_LOOP_SMALL);
+            benchmark_type == BW || benchmark_type == INCAST ? BW_LOOP_SMALL :
+            benchmark_type == QUEUE ? QUEUE_LOOP : benchmark_type == MATRIX ?
+            MATRIX_LOOP : benchmark_type == BISECT ? BISECT_LOOP_SMALL :
+            benchmark_type == HALO ? HALO_LOOP_SMALL :
+            benchmark_type == PARTITIONED ? PART_LOOP_SMALL : LAT_LOOP_SMALL);
+
+    if (supported('S')) {
+        printf(SIZES_HELP_STRING);
+    }
+
+    if (supported('t')) {
+        printf("  -t TYPE[:BLOCK[:STRIDE]]\n"
+               "                send BLOCK byte blocks STRIDE bytes apart (default\n"
+               "                8 and 2 * BLOCK) described by the datatype TYPE:\n"
+               "                vector (default), indexed, subarray or struct\n");
+    }
+
+    if (supported('q')) {
+        printf("  -q MODE       fill the matching queue with posted receives that do\n"
+               "                not match (`posted', default) or with unexpected\n"
+               "                messages (`unexpected')\n");
+        printf("  -Q DEPTHS     run each of the comma separated queue depths in\n"
+               "                DEPTHS (default 0,1,10,100,1000,10000,100000)\n");
+    }
+
+    if (supported('g')) {
+        printf("  -g TAGS[:COMMS]\n"
+               "                cycle the messages through TAGS tags on each of COMMS\n"
+               "                communicators (default 1 and 1)\n");
+    }
+
+    if (supported('k')) {
+        printf("  -k SENDERS    run each of the comma separated numbers of senders in\n"
+               "                SENDERS (default 1, 2, 4, ... and all other ranks)\n");
+    }
+
+    if (supported('s')) {
+        printf("  -s LAT[:BW]   message sizes of the latency and the bandwidth test\n"
+               "                (default 8 and %d)\n", MAX_MSG_SIZE / 4);
+        printf("  -F PREFIX     write the latency and bandwidth matrices to the files\n"
+               "                PREFIX.latency and PREFIX.bandwidth\n");
+    }
+
+    if (supported('R')) {
+        printf("  -R ROUNDS[:SEED]\n"
+               "                draw ROUNDS random matchings of the ranks for each\n"
+               "                message size from the random seed SEED (default 50\n"
+               "                and 1)\n");
+    }
+
+    if (supported('D')) {
+        printf("  -D DIMS       decompose a 2 or 3 (default) dimensional domain\n");
+        printf("  -B SUBDOMAINS run each of the comma separated subdomain shapes in\n"
+               "                SUBDOMAINS, N or NxN[xN] cells of 8 bytes per rank\n"
+               "                (default N = 8, 16, 32, ... up to %d cells)\n",
+               MAX_HALO_CELLS);
+        printf("  -H WIDTH      halo width in cells (default 1)\n");
+        printf("  -N STENCIL    exchange the `faces' (default) of the subdomain, the\n"
+               "                faces and `edges' or the faces, edges and `corners'\n");
+        printf("  -M METHODS    time each of the comma separated exchange methods in\n"
+               "                METHODS: isend (MPI_Isend, MPI_Irecv and MPI_Waitall),\n"
+               "                sendrecv (MPI_Sendrecv in each direction), alltoallw\n"
+               "                (MPI_Neighbor_alltoallw) or all (default)\n");
+        printf("  -b BOUNDARY   `periodic' (default) or `open' domain boundaries\n");
+    }
+
+    if (supported('n')) {
+        printf("  -n THREADS    fill the send buffer in THREADS partitions, one per\n"
+               "                thread (default 4)\n");
+        printf("  -w US         let thread t compute t * US microseconds before it\n"
+               "                fills its partition, to model load imbalance\n"
+               "                (default 0)\n");
+    }
+
+    if (supported('W')) {
+        printf("  -W WINDOWS    run every message size with each of the comma\n"
+               "                separated window sizes in WINDOWS (default 64)\n");
+    }
+
+    if (supported('e')) {
+        printf("  -e MODES      time each of the comma separated send modes in MODES:\n"
+               "                send, ssend, bsend (with an attached buffer), rsend\n"
+               "                (to a posted receive), test (MPI_Isend and MPI_Irecv\n"
+               "                polled with MPI_Test), wait (the same with MPI_Wait)\n"
+               "                or all\n");
+    }
+
+    if (supported('p')) {
+        printf("  -p            restart persistent requests set up once per message\n"
+               "                size instead of posting new ones and report the time\n"
+               "                saved per message compared with the regular path\n");
+    }
+
+    if (supported('c')) {
+        printf(POOL_HELP_STRING);
+    }
+
+    if (supported('a')) {
+        printf(ALLOC_HELP_STRING);
+    }
+
+    if (supported('C')) {
+        printf(ADAPTIVE_HELP_STRING);
+    }
+
+    printf(OUTPUT_HELP_STRING);
+
+    if (supported('P')) {
+        printf(COUNTERS_HELP_STRING);
+    }
+
+    if (supported('T')) {
+        printf(PVARS_HELP_STRING);
+    }
+
+    if (supported('f')) {
+        printf("  -f            print full statistics (min, p50, p90, p99, p99.9 and\n"
+               "                max of the time taken by each timed iteration)\n");
+    }
+
     printf("  -h            print this help message\n");
     fflush(stdout);
 }
@@ -82,6 +273,368 @@ set_num_iterations (int value)
     return 0;
 }
 
+static int
+set_windows (char * val_str)
+{
+    char * window;
+
+    options.num_windows = 0;
+
+    for (window = strtok(val_str, ","); window; window = strtok(NULL, ",")) {
+        if (MAX_WINDOWS == options.num_windows || 0 >= atoi(window)
+                || MAX_REQ_NUM < atoi(window)) {
+            return -1;
+        }
+
+        options.windows[options.num_windows++] = atoi(window);
+    }
+
+    return options.num_windows ? 0 : -1;
+}
+
+static int
+set_modes (char * val_str)
+{
+    char * name;
+    int i, mode;
+
+    options.num_modes = 0;
+
+    if (0 == strcmp(val_str, "all")) {
+        for (mode = 0; mode < NUM_SEND_MODES; mode++) {
+            options.modes[options.num_modes++] = mode;
+        }
+
+        return 0;
+    }
+
+    for (name = strtok(val_str, ","); name; name = strtok(NULL, ",")) {
+        for (mode = 0; mode < NUM_SEND_MODES; mode++) {
+            if (0 == strcmp(name, mode_names[mode])) {
+                break;
+            }
+        }
+
+        if (NUM_SEND_MODES == mode) {
+            return -1;
+        }
+
+        for (i = 0; i < options.num_modes; i++) {
+            if (mode == options.modes[i]) {
+                return -1;
+            }
+        }
+
+        options.modes[options.num_modes++] = mode;
+    }
+
+    return options.num_modes ? 0 : -1;
+}
+
+static int
+set_datatype (char * val_str)
+{
+    char * type = strtok(val_str, ":");
+    char * block = strtok(NULL, ":");
+    char * stride = strtok(NULL, ":");
+
+    if (NULL == type) {
+        return -1;
+    }
+
+    if (0 == strcmp(type, "vector")) {
+        options.ddt = ddt_vector;
+    }
+
+    else if (0 == strcmp(type, "indexed")) {
+        options.ddt = ddt_indexed;
+    }
+
+    else if (0 == strcmp(type, "subarray")) {
+        options.ddt = ddt_subarray;
+    }
+
+    else if (0 == strcmp(type, "struct")) {
+        options.ddt = ddt_struct;
+    }
+
+    else {
+        return -1;
+    }
+
+    if (block) {
+        options.ddt_block = atoi(block);
+        options.ddt_stride = 2 * options.ddt_block;
+    }
+
+    if (stride) {
+        options.ddt_stride = atoi(stride);
+    }
+
+    if (0 >= options.ddt_block || options.ddt_block > MAX_MSG_SIZE
+            || options.ddt_stride < options.ddt_block) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+set_queue (char * val_str)
+{
+    if (0 == strcmp(val_str, "posted")) {
+        options.queue = queue_posted;
+    }
+
+    else if (0 == strcmp(val_str, "unexpected")) {
+        options.queue = queue_unexpected;
+    }
+
+    else {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+set_depths (char * val_str)
+{
+    char * depth;
+
+    options.num_depths = 0;
+
+    for (depth = strtok(val_str, ","); depth; depth = strtok(NULL, ",")) {
+        if (MAX_DEPTHS == options.num_depths || 0 > atoi(depth)
+                || MAX_QUEUE_DEPTH < atoi(depth)) {
+            return -1;
+        }
+
+        options.depths[options.num_depths++] = atoi(depth);
+    }
+
+    return options.num_depths ? 0 : -1;
+}
+
+static int
+set_channels (char * val_str)
+{
+    char * tags = strtok(val_str, ":");
+    char * comms = strtok(NULL, ":");
+
+    if (NULL == tags || 0 >= atoi(tags) || MAX_MATCH_TAGS < atoi(tags)) {
+        return -1;
+    }
+
+    options.match_tags = atoi(tags);
+
+    if (comms) {
+        if (0 >= atoi(comms) || MAX_MATCH_COMMS < atoi(comms)) {
+            return -1;
+        }
+
+        options.match_comms = atoi(comms);
+    }
+
+    return 0;
+}
+
+static int
+set_senders (char * val_str)
+{
+    char * senders;
+
+    options.num_senders = 0;
+
+    for (senders = strtok(val_str, ","); senders;
+            senders = strtok(NULL, ",")) {
+        if (MAX_SENDER_COUNTS == options.num_senders
+                || 0 >= atoi(senders)) {
+            return -1;
+        }
+
+        options.senders[options.num_senders++] = atoi(senders);
+    }
+
+    return options.num_senders ? 0 : -1;
+}
+
+static int
+set_matrix_sizes (char * val_str)
+{
+    char * lat = strtok(val_str, ":");
+    char * bw = strtok(NULL, ":");
+
+    if (NULL == lat || 0 > atoi(lat) || MAX_MSG_SIZE < atoi(lat)) {
+        return -1;
+    }
+
+    options.lat_size = atoi(lat);
+
+    if (bw) {
+        if (0 >= atoi(bw) || MAX_MSG_SIZE < atoi(bw)) {
+            return -1;
+        }
+
+        options.bw_size = atoi(bw);
+    }
+
+    return 0;
+}
+
+static int
+set_rounds (char * val_str)
+{
+    char * rounds = strtok(val_str, ":");
+    char * seed = strtok(NULL, ":");
+
+    if (NULL == rounds || 0 >= atoi(rounds) || MAX_ROUNDS < atoi(rounds)) {
+        return -1;
+    }
+
+    options.rounds = atoi(rounds);
+
+    if (seed) {
+        if (0 > atoi(seed)) {
+            return -1;
+        }
+
+        options.seed = atoi(seed);
+    }
+
+    return 0;
+}
+
+static int
+set_subdomains (char * val_str)
+{
+    char * shape;
+    int * n;
+
+    options.num_subdomains = 0;
+
+    for (shape = strtok(val_str, ","); shape; shape = strtok(NULL, ",")) {
+        if (MAX_SUBDOMAINS == options.num_subdomains) {
+            return -1;
+        }
+
+        /* the dimensions not given stay 0 until the number of them is known */
+        n = options.subdomains[options.num_subdomains++];
+        n[0] = n[1] = n[2] = 0;
+        sscanf(shape, "%dx%dx%d", n, n + 1, n + 2);
+
+        if (0 >= n[0] || 0 > n[1] || 0 > n[2] || (0 == n[1] && n[2])) {
+            return -1;
+        }
+    }
+
+    return options.num_subdomains ? 0 : -1;
+}
+
+static int
+set_stencil (char * val_str)
+{
+    if (0 == strcmp(val_str, "faces")) {
+        options.stencil = stencil_faces;
+    }
+
+    else if (0 == strcmp(val_str, "edges")) {
+        options.stencil = stencil_edges;
+    }
+
+    else if (0 == strcmp(val_str, "corners")) {
+        options.stencil = stencil_corners;
+    }
+
+    else {
+        return -1;
+    }
+
+    return 0;
+}
+
+static int
+set_methods (char * val_str)
+{
+    char * name;
+    int i, method;
+
+    options.num_methods = 0;
+
+    if (0 == strcmp(val_str, "all")) {
+        for (method = 0; method < NUM_HALO_METHODS; method++) {
+            options.methods[options.num_methods++] = method;
+        }
+
+        return 0;
+    }
+
+    for (name = strtok(val_str, ","); name; name = strtok(NULL, ",")) {
+        for (method = 0; method < NUM_HALO_METHODS; method++) {
+            if (0 == strcmp(name, halo_method_names[method])) {
+                break;
+            }
+        }
+
+        if (NUM_HALO_METHODS == method) {
+            return -1;
+        }
+
+        for (i = 0; i < options.num_methods; i++) {
+            if (method == options.methods[i]) {
+                return -1;
+            }
+        }
+
+        options.methods[options.num_methods++] = method;
+    }
+
+    return options.num_methods ? 0 : -1;
+}
+
+static int
+set_boundary (char * val_str)
+{
+    if (0 == strcmp(val_str, "periodic")) {
+        options.halo_periodic = 1;
+    }
+
+    else if (0 == strcmp(val_str, "open")) {
+        options.halo_periodic = 0;
+    }
+
+    else {
+        return -1;
+    }
+
+    return 0;
+}
+
+/*
+ * A single edge length applies to all dimensions, otherwise a subdomain
+ * needs one for each.
+ */
+static int
+check_subdomains (void)
+{
+    int i, * n;
+
+    for (i = 0; i < options.num_subdomains; i++) {
+        n = options.subdomains[i];
+
+        if (0 == n[1]) {
+            n[1] = n[0];
+            n[2] = 3 == options.halo_dims ? n[0] : 0;
+        }
+
+        else if ((3 == options.halo_dims) != (0 != n[2])) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 static int
 set_num_warmup (int value)
 {
@@ -101,88 +654,400 @@ process_options (int argc, char *argv[], int type)
     extern char * optarg;
     extern int optind;
     
-    char const * optstring = (CUDA_ENABLED || OPENACC_ENABLED) ? "+d:x:i:h" : "+x:i:h";
+    char const * optstring = (CUDA_ENABLED || OPENACC_ENABLED) ? "+d:x:i:S:W:e:pt:q:Q:g:k:s:F:R:D:B:H:N:M:b:n:w:c:a:C:o:P:T:fh" : "+x:i:S:W:e:pt:q:Q:g:k:s:F:R:D:B:H:N:M:b:n:w:c:a:C:o:P:T:fh";
+    int default_depths[] = { 0, 1, 10, 100, 1000, 10000, 100000 };
     int c;
     
     /*
      * set default options
      */
       
+    bad_usage.message = NULL;
     options.src = 'H';
     options.dst = 'H';
+    options.show_full = 0;
+    options.persistent = 0;
+    options.num_windows = 0;
+    options.window = 0;
+    options.num_modes = 0;
+    options.ddt = ddt_vector;
+    options.ddt_block = 8;
+    options.ddt_stride = 16;
+    options.queue = queue_posted;
+    options.num_depths = sizeof(default_depths) / sizeof(int);
+    memcpy(options.depths, default_depths, sizeof(default_depths));
+    options.match_tags = 1;
+    options.match_comms = 1;
+    options.num_senders = 0;
+    options.matrix_file = NULL;
+    options.lat_size = 8;
+    options.bw_size = MAX_MSG_SIZE / 4;
+    options.rounds = 50;
+    options.seed = 1;
+    options.halo_dims = 3;
+    options.halo_periodic = 1;
+    options.halo_width = 1;
+    options.stencil = stencil_faces;
+    options.num_methods = 0;
+    options.num_subdomains = 0;
+    options.threads = 4;
+    options.imbalance = 0;
+    output_set_command(argc, argv);
+
+    benchmark_type = type;
+    switch (type) {
+        case BW:
+        case INCAST:
+            options.loop = BW_LOOP_SMALL;
+            options.skip = BW_SKIP_SMALL;
+            options.loop_large = BW_LOOP_LARGE;
+            options.skip_large = BW_SKIP_LARGE;
+            break;
+        case LAT:
+        case LAT_MT:
+        case MULTI_LAT:
+        case THRESHOLDS:
+        case DDT:
+        case MATCH:
+            options.loop = LAT_LOOP_SMALL;
+            options.skip = LAT_SKIP_SMALL;
+            options.loop_large = LAT_LOOP_LARGE;
+            options.skip_large = LAT_SKIP_LARGE;
+            break;
+        case QUEUE:
+            options.loop = QUEUE_LOOP;
+            options.skip = QUEUE_SKIP;
+            options.loop_large = QUEUE_LOOP;
+            options.skip_large = QUEUE_SKIP;
+            break;
+        case MATRIX:
+            options.loop = MATRIX_LOOP;
+            options.skip = MATRIX_SKIP;
+            options.loop_large = MATRIX_LOOP;
+            options.skip_large = MATRIX_SKIP;
+            break;
+        case BISECT:
+            options.loop = BISECT_LOOP_SMALL;
+            options.skip = BISECT_SKIP_SMALL;
+            options.loop_large = BISECT_LOOP_LARGE;
+            options.skip_large = BISECT_SKIP_LARGE;
+            break;
+        case HALO:
+            options.loop = HALO_LOOP_SMALL;
+            options.skip = HALO_SKIP_SMALL;
+            options.loop_large = HALO_LOOP_LARGE;
+            options.skip_large = HALO_SKIP_LARGE;
+            break;
+        case PARTITIONED:
+            options.loop = PART_LOOP_SMALL;
+            options.skip = PART_SKIP_SMALL;
+            options.loop_large = PART_LOOP_LARGE;
+            options.skip_large = PART_SKIP_LARGE;
+            break;
+    }
+
+    if (CUDA_ENABLED) { 
+        options.accel = cuda;
+    }
+    
+    else if (OPENACC_ENABLED) {
+        options.accel = openacc;
+    }
+    
+    else {
+        options.accel = none;
+    }
+    
+    while((c = getopt(argc, argv, optstring)) != -1) {
+        bad_usage.opt = c;
+
+        if ('?' != c && !supported(c)) {
+            bad_usage.message = "Option Not Supported by This Benchmark";
+            bad_usage.optarg = NULL;
+
+            return po_bad_usage;
+        }
+
+        switch (c) {
+            case 'd':
+                /* optarg should contain cuda or openacc */
+                if (0 == strncasecmp(optarg, "cuda", 10)) {
+                    if (!CUDA_ENABLED) {
+                        return po_cuda_not_avail;
+                    }
+                    options.accel = cuda;
+                }
+                
+                else if (0 == strncasecmp(optarg, "openacc", 10)) {
+                    if (!OPENACC_ENABLED) {
+                        return po_openacc_not_avail;
+                    }
+                    options.accel = openacc;
+                }
+                
+                else {
+                    return po_bad_usage;
+                }
+                break;
+            case 'i':
+                if (set_num_iterations(atoi(optarg))) {
+                    bad_usage.message = "Invalid Number of Iterations";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'x':
+                if (set_num_warmup(atoi(optarg))) {
+                    bad_usage.message = "Invalid Number of Warmup Iterations";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'S':
+                if (set_sizes(optarg)) {
+                    bad_usage.message = "Invalid Message Sizes";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'W':
+                if (set_windows(optarg)) {
+                    bad_usage.message = "Invalid Window Sizes";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'e':
+                if (set_modes(optarg)) {
+                    bad_usage.message = "Invalid Send Modes";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'p':
+                options.persistent = 1;
+                break;
+            case 't':
+                if (set_datatype(optarg)) {
+                    bad_usage.message = "Invalid Datatype";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'q':
+                if (set_queue(optarg)) {
+                    bad_usage.message = "Invalid Queue";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'Q':
+                if (set_depths(optarg)) {
+                    bad_usage.message = "Invalid Queue Depths";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'g':
+                if (set_channels(optarg)) {
+                    bad_usage.message = "Invalid Tags or Communicators";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'k':
+                if (set_senders(optarg)) {
+                    bad_usage.message = "Invalid Numbers of Senders";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 's':
+                if (set_matrix_sizes(optarg)) {
+                    bad_usage.message = "Invalid Message Sizes";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'F':
+                options.matrix_file = optarg;
+                break;
+            case 'R':
+                if (set_rounds(optarg)) {
+                    bad_usage.message = "Invalid Number of Rounds";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'D':
+                if (0 != strcmp(optarg, "2") && 0 != strcmp(optarg, "3")) {
+                    bad_usage.message = "Invalid Number of Dimensions";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+
+                options.halo_dims = atoi(optarg);
+                break;
+            case 'B':
+                if (set_subdomains(optarg)) {
+                    bad_usage.message = "Invalid Subdomains";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'H':
+                if (0 >= atoi(optarg)) {
+                    bad_usage.message = "Invalid Halo Width";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+
+                options.halo_width = atoi(optarg);
+                break;
+            case 'N':
+                if (set_stencil(optarg)) {
+                    bad_usage.message = "Invalid Stencil";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'M':
+                if (set_methods(optarg)) {
+                    bad_usage.message = "Invalid Exchange Methods";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'b':
+                if (set_boundary(optarg)) {
+                    bad_usage.message = "Invalid Boundary";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+                break;
+            case 'n':
+                if (1 > atoi(optarg) || MAX_THREADS < atoi(optarg)) {
+                    bad_usage.message = "Invalid Number of Threads";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+
+                options.threads = atoi(optarg);
+                break;
+            case 'w':
+                if (0 > atoi(optarg)) {
+                    bad_usage.message = "Invalid Imbalance";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
+                }
+
+                options.imbalance = atoi(optarg);
+                break;
+            case 'c':
+                if (set_buffer_pool(optarg)) {
+                    bad_usage.message = "Invalid Buffer Pool";
+                    bad_usage.optarg = optarg;
 
-    benchmark_type = type;
-    switch (type) {
-        case BW:
-            options.loop = BW_LOOP_SMALL;
-            options.skip = BW_SKIP_SMALL;
-            options.loop_large = BW_LOOP_LARGE;
-            options.skip_large = BW_SKIP_LARGE;
-            break;
-        case LAT:
-            options.loop = LAT_LOOP_SMALL;
-            options.skip = LAT_SKIP_SMALL;
-            options.loop_large = LAT_LOOP_LARGE;
-            options.skip_large = LAT_SKIP_LARGE;
-            break;
-    }
+                    return po_bad_usage;
+                }
+                break;
+            case 'a':
+                if (set_allocator(optarg)) {
+                    bad_usage.message = "Invalid Allocator";
+                    bad_usage.optarg = optarg;
 
-    if (CUDA_ENABLED) { 
-        options.accel = cuda;
-    }
-    
-    else if (OPENACC_ENABLED) {
-        options.accel = openacc;
-    }
-    
-    else {
-        options.accel = none;
-    }
-    
-    while((c = getopt(argc, argv, optstring)) != -1) {
-        switch (c) {
-            case 'd':
-                /* optarg should contain cuda or openacc */
-                if (0 == strncasecmp(optarg, "cuda", 10)) {
-                    if (!CUDA_ENABLED) {
-                        return po_cuda_not_avail;
-                    }
-                    options.accel = cuda;
+                    return po_bad_usage;
                 }
-                
-                else if (0 == strncasecmp(optarg, "openacc", 10)) {
-                    if (!OPENACC_ENABLED) {
-                        return po_openacc_not_avail;
-                    }
-                    options.accel = openacc;
+                break;
+            case 'C':
+                if (set_adaptive(optarg)) {
+                    bad_usage.message = "Invalid Confidence Interval Width";
+                    bad_usage.optarg = optarg;
+
+                    return po_bad_usage;
                 }
-                
-                else {
+                break;
+            case 'o':
+                if (set_output(optarg)) {
+                    bad_usage.message = "Invalid Output Format";
+                    bad_usage.optarg = optarg;
+
                     return po_bad_usage;
                 }
                 break;
-            case 'i':
-                if (set_num_iterations(atoi(optarg))) {
-                    bad_usage.message = "Invalid Number of Iterations";
+            case 'P':
+                if (set_counters(optarg)) {
+                    bad_usage.message = "Invalid Counter Events";
                     bad_usage.optarg = optarg;
 
                     return po_bad_usage;
                 }
                 break;
-            case 'x':
-                if (set_num_warmup(atoi(optarg))) {
-                    bad_usage.message = "Invalid Number of Warmup Iterations";
+            case 'T':
+                if (set_pvars(optarg)) {
+                    bad_usage.message = "Invalid MPI_T Variables";
                     bad_usage.optarg = optarg;
 
                     return po_bad_usage;
                 }
                 break;
+            case 'f':
+                options.show_full = 1;
+                break;
             case 'h':
                 return po_help_message;
             default:
                 return po_bad_usage;
         }
     }
+
+    /* the checks below concern combinations of options */
+    bad_usage.opt = 0;
+
+    /* persistent requests only exist for the standard mode */
+    if (options.persistent && options.num_modes) {
+        bad_usage.message = "Send Modes and Persistent Requests Exclude Each "
+            "Other";
+        bad_usage.optarg = NULL;
+
+        return po_bad_usage;
+    }
+
+    /* persistent requests stay bound to the buffers they were set up with */
+    if (options.persistent && buffer_pool_size()) {
+        bad_usage.message = "Buffer Pool and Persistent Requests Exclude Each "
+            "Other";
+        bad_usage.optarg = NULL;
+
+        return po_bad_usage;
+    }
+
+    if (check_subdomains()) {
+        bad_usage.message = "Subdomains Do Not Match the Number of Dimensions";
+        bad_usage.optarg = NULL;
+
+        return po_bad_usage;
+    }
     
     if (CUDA_ENABLED || OPENACC_ENABLED) {
         if ((optind + 2) == argc) {
@@ -284,7 +1149,8 @@ allocate_managed_buffer (char ** buffer)
     switch (options.accel) {
 #ifdef _ENABLE_CUDA_
         case cuda:
-            cuerr = cudaMallocManaged((void **)buffer, MYBUFSIZE, cudaMemAttachGlobal);
+            cuerr = cudaMallocManaged((void **)buffer, MYBUFSIZE + buffer_pool_size(),
+                    cudaMemAttachGlobal);
 
             if (cudaSuccess != cuerr) {
                 fprintf(stderr, "Could not allocate device memory\n");
@@ -310,7 +1176,7 @@ allocate_device_buffer (char ** buffer)
     switch (options.accel) {
 #ifdef _ENABLE_CUDA_
         case cuda:
-            cuerr = cudaMalloc((void **)buffer, MYBUFSIZE);
+            cuerr = cudaMalloc((void **)buffer, MYBUFSIZE + buffer_pool_size());
 
             if (cudaSuccess != cuerr) {
                 fprintf(stderr, "Could not allocate device memory\n");
@@ -320,7 +1186,7 @@ allocate_device_buffer (char ** buffer)
 #endif
 #ifdef _ENABLE_OPENACC_
         case openacc:
-            *buffer = acc_malloc(MYBUFSIZE);
+            *buffer = acc_malloc(MYBUFSIZE + buffer_pool_size());
             if (NULL == *buffer) {
                 fprintf(stderr, "Could not allocate device memory\n");
                 return 1;
@@ -338,8 +1204,6 @@ allocate_device_buffer (char ** buffer)
 int
 allocate_memory (char ** sbuf, char ** rbuf, int rank)
 {
-    unsigned long align_size = sysconf(_SC_PAGESIZE);
-
     switch (rank) {
         case 0:
             if ('D' == options.src) {
@@ -367,12 +1231,12 @@ allocate_memory (char ** sbuf, char ** rbuf, int rank)
             }
 
             else {
-                if (posix_memalign((void**)sbuf, align_size, MYBUFSIZE)) {
+                if (NULL == (*sbuf = osu_malloc(MYBUFSIZE + buffer_pool_size()))) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
 
-                if (posix_memalign((void**)rbuf, align_size, MYBUFSIZE)) {
+                if (NULL == (*rbuf = osu_malloc(MYBUFSIZE + buffer_pool_size()))) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
@@ -404,12 +1268,12 @@ allocate_memory (char ** sbuf, char ** rbuf, int rank)
             }
 
             else {
-                if (posix_memalign((void**)sbuf, align_size, MYBUFSIZE)) {
+                if (NULL == (*sbuf = osu_malloc(MYBUFSIZE + buffer_pool_size()))) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
 
-                if (posix_memalign((void**)rbuf, align_size, MYBUFSIZE)) {
+                if (NULL == (*rbuf = osu_malloc(MYBUFSIZE + buffer_pool_size()))) {
                     fprintf(stderr, "Error allocating host memory\n");
                     return 1;
                 }
@@ -417,13 +1281,101 @@ allocate_memory (char ** sbuf, char ** rbuf, int rank)
             break;
     }
 
+    /* fault in the whole pool so that page faults are not timed */
+    if (buffer_pool_size() && 'H' == (0 == rank ? options.src : options.dst)) {
+        memset(*sbuf, 0, MYBUFSIZE + buffer_pool_size());
+        memset(*rbuf, 0, MYBUFSIZE + buffer_pool_size());
+    }
+
+    return 0;
+}
+
+/*
+ * Makes the request arrays hold at least count requests.  None of them may
+ * be active, their contents are not kept.
+ */
+int
+grow_requests (int count)
+{
+    MPI_Request * requests, * sends, * recvs;
+    MPI_Status * statuses;
+
+    if (count <= num_requests) {
+        return 0;
+    }
+
+    requests = malloc(count * sizeof(MPI_Request));
+    statuses = malloc(count * sizeof(MPI_Status));
+    sends = malloc(count * sizeof(MPI_Request));
+    recvs = malloc(count * sizeof(MPI_Request));
+
+    if (NULL == requests || NULL == statuses || NULL == sends
+            || NULL == recvs) {
+        fprintf(stderr, "Error allocating %d requests\n", count);
+        free(requests);
+        free(statuses);
+        free(sends);
+        free(recvs);
+        return 1;
+    }
+
+    if (request_array != request) {
+        free(request);
+        free(reqstat);
+        free(send_request);
+        free(recv_request);
+    }
+
+    request = requests;
+    reqstat = statuses;
+    send_request = sends;
+    recv_request = recvs;
+    num_requests = count;
+
     return 0;
 }
 
+/*
+ * With -C the number of warmup and timed iterations is not known up front,
+ * so the sampling engine moves options.skip and options.loop, the bounds of
+ * the timing loops, after every iteration.  Both ranks have to call
+ * adaptive_finish_pt2pt() on every iteration.
+ */
+void
+adaptive_schedule_pt2pt (void)
+{
+    if (!adaptive_enabled()) {
+        return;
+    }
+
+    adaptive_reset();
+    options.skip = adaptive_loop_skip();
+    options.loop = adaptive_loop_iterations();
+}
+
+void
+adaptive_finish_pt2pt (double time)
+{
+    adaptive_record(time, MPI_COMM_WORLD);
+    options.skip = adaptive_loop_skip();
+    options.loop = adaptive_loop_iterations();
+}
+
 void
 print_header (int rank, int type)
 {
-    if (0 == rank) {
+    int i;
+
+    output_init(MPI_COMM_WORLD);
+    counters_init(MPI_COMM_WORLD);
+    pvars_init(MPI_COMM_WORLD);
+
+    if (0 == rank && sizes_skipped(MAX_MSG_SIZE)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped(MAX_MSG_SIZE), MAX_MSG_SIZE);
+    }
+
+    if (0 == rank && output_text()) {
         switch (options.accel) {
             case cuda:
                 printf(benchmark_header, "-CUDA");
@@ -443,17 +1395,351 @@ print_header (int rank, int type)
                         'M' == options.src ? "MANAGED (M)" : ('D' == options.src ? "DEVICE (D)" : "HOST (H)"),
                         'M' == options.dst ? "MANAGED (M)" : ('D' == options.dst ? "DEVICE (D)" : "HOST (H)"));
             default:
+                if (allocator_selected()) {
+                    printf("# Allocator: %s\n", allocator_spec());
+                }
+
+                print_buffer_pool();
+
+                if (options.persistent) {
+                    printf("# Persistent requests, compared with %s\n",
+                            type == BW ? "MPI_Isend/MPI_Irecv" :
+                            "MPI_Send/MPI_Recv");
+                }
+
+                if (adaptive_enabled()) {
+                    printf("# Iterations chosen for a 95%% confidence "
+                            "interval\n");
+                }
+
+                if (counters_count()) {
+                    printf("# Counters are per iteration averages over all "
+                            "ranks\n");
+                }
+
+                if (pvars_count()) {
+                    printf("# MPI_T variables are combined over all ranks "
+                            "for every message size\n");
+                }
+
+                if (options.num_modes > 1 && (options.show_full
+                            || counters_count() || pvars_count())) {
+                    printf("# Statistics, counters and MPI_T variables are "
+                            "of the %s mode\n", mode_names[options.modes[0]]);
+                }
+
+                if (options.show_full && type == BW) {
+                    printf("# Min/P50/P90/P99/P99.9/Max are the time to complete "
+                            "one window\n");
+                }
+
+                printf("%-*s", 10, "# Size");
+
+                if (options.num_windows) {
+                    printf("%*s", 10, "Window");
+                }
+
                 if (type == BW) {
-                    printf("%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Bandwidth (MB/s)");
+                    printf("%*s", FIELD_WIDTH, "Bandwidth (MB/s)");
                 } 
+                else if (options.num_modes) {
+                    for (i = 0; i < options.num_modes; i++) {
+                        printf("%*s", FIELD_WIDTH,
+                                mode_labels[options.modes[i]]);
+                    }
+                }
                 else {
-                    printf("%-*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)");
+                    printf("%*s", FIELD_WIDTH, "Latency (us)");
                 }
+
+                if (options.persistent) {
+                    printf("%*s%*s", 24, type == BW ?
+                            "Non-persistent (MB/s)" : "Non-persistent (us)",
+                            FIELD_WIDTH, "Saved (us/msg)");
+                }
+
+                if (options.show_full) {
+                    printf("%*s%*s%*s%*s%*s%*s", FIELD_WIDTH, "Min (us)",
+                            FIELD_WIDTH, "P50 (us)", FIELD_WIDTH, "P90 (us)",
+                            FIELD_WIDTH, "P99 (us)", FIELD_WIDTH, "P99.9 (us)",
+                            FIELD_WIDTH, "Max (us)");
+                }
+
+                for (i = 0; i < counters_count(); i++) {
+                    printf("%*s", FIELD_WIDTH, counters_label(i));
+                }
+
+                pvars_print_labels(stdout);
+
+                if (adaptive_enabled()) {
+                    printf("%*s%*s", 12, "Iterations", 12, "Warmup");
+                }
+
+                printf("\n");
                 fflush(stdout);
         }
     }
 }
 
+/*
+ * With -p the value passed to print_stats() is that of the persistent
+ * requests, and the benchmark sets the value of the regular path and the
+ * time it takes longer per message here beforehand.
+ */
+void
+set_comparison (double value, double saved)
+{
+    comparison_value = value;
+    comparison_saved = saved;
+}
+
+/*
+ * Sets the latency of the index-th send mode given with -m for print_stats.
+ */
+void
+set_mode_latency (int index, double value)
+{
+    mode_latency[index] = value;
+}
+
+void
+print_stats (int rank, int size, double value, struct stats_t const * stats)
+{
+    int i;
+
+    if (rank) return;
+
+    output_begin(size);
+
+    if (options.num_windows) {
+        output_int("window", options.window);
+    }
+
+    if (options.num_modes) {
+        for (i = 0; i < options.num_modes; i++) {
+            output_double(mode_fields[options.modes[i]], mode_latency[i]);
+        }
+    }
+
+    else {
+        output_double(BW == benchmark_type ? "bandwidth_mbps" : "latency_us",
+                value);
+    }
+
+    if (options.persistent) {
+        output_double(BW == benchmark_type ? "nonpersistent_bandwidth_mbps"
+                : "nonpersistent_latency_us", comparison_value);
+        output_double("saved_us", comparison_saved);
+    }
+
+    if (options.show_full) {
+        output_double("min_us", stats->min);
+        output_double("p50_us", stats->p50);
+        output_double("p90_us", stats->p90);
+        output_double("p99_us", stats->p99);
+        output_double("p999_us", stats->p999);
+        output_double("max_us", stats->max);
+    }
+
+    for (i = 0; i < counters_count(); i++) {
+        output_double(counters_field(i), counters_value(i));
+    }
+
+    for (i = 0; i < pvars_count(); i++) {
+        output_double(pvars_name(i), pvars_value(i));
+    }
+
+    output_int("iterations", options.loop);
+    output_int("warmup", options.skip);
+    output_end();
+
+    if (!output_text()) return;
+
+    fprintf(stdout, "%-*d", 10, size);
+
+    if (options.num_windows) {
+        fprintf(stdout, "%*d", 10, options.window);
+    }
+
+    if (options.num_modes) {
+        for (i = 0; i < options.num_modes; i++) {
+            fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                    mode_latency[i]);
+        }
+    }
+
+    else {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION, value);
+    }
+
+    if (options.persistent) {
+        fprintf(stdout, "%*.*f%*.*f", 24, FLOAT_PRECISION, comparison_value,
+                FIELD_WIDTH, 3, comparison_saved);
+    }
+
+    if (options.show_full) {
+        fprintf(stdout, "%*.*f%*.*f%*.*f%*.*f%*.*f%*.*f",
+                FIELD_WIDTH, FLOAT_PRECISION, stats->min,
+                FIELD_WIDTH, FLOAT_PRECISION, stats->p50,
+                FIELD_WIDTH, FLOAT_PRECISION, stats->p90,
+                FIELD_WIDTH, FLOAT_PRECISION, stats->p99,
+                FIELD_WIDTH, FLOAT_PRECISION, stats->p999,
+                FIELD_WIDTH, FLOAT_PRECISION, stats->max);
+    }
+
+    for (i = 0; i < counters_count(); i++) {
+        fprintf(stdout, "%*.*f", FIELD_WIDTH, FLOAT_PRECISION,
+                counters_value(i));
+    }
+
+    pvars_print_values(stdout);
+
+    if (adaptive_enabled()) {
+        fprintf(stdout, "%*d%*d", 12, options.loop, 12, options.skip);
+    }
+
+    fprintf(stdout, "\n");
+    fflush(stdout);
+}
+
+int
+allocate_samples (void)
+{
+    int count = options.loop > options.loop_large ? options.loop :
+        options.loop_large;
+
+    if (adaptive_enabled()) {
+        count = ADAPTIVE_MAX_ITERATIONS;
+    }
+
+    samples = malloc(sizeof(double) * count);
+
+    if (NULL == samples) {
+        fprintf(stderr, "Error allocating sample buffer\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+void
+free_samples (void)
+{
+    free(samples);
+    samples = NULL;
+}
+
+static int
+hist_index (unsigned long long value)
+{
+    int shift = 0;
+
+    while ((value >> shift) >= 2 * HIST_SUB_COUNT) {
+        shift++;
+    }
+
+    if (shift > HIST_MAGNITUDES - 1) {
+        return HIST_BUCKETS - 1;
+    }
+
+    return HIST_SUB_COUNT * (shift + 1) + (value >> shift) - HIST_SUB_COUNT;
+}
+
+static double
+hist_value (int index)
+{
+    int shift;
+    unsigned long long lower;
+
+    if (index < HIST_SUB_COUNT) {
+        return index;
+    }
+
+    shift = index / HIST_SUB_COUNT - 1;
+    lower = (unsigned long long)(index % HIST_SUB_COUNT + HIST_SUB_COUNT)
+        << shift;
+
+    /* report the midpoint of the bucket */
+    return lower + ((1ULL << shift) - 1) / 2.0;
+}
+
+/*
+ * Bin the first count entries of samples (in seconds) into a histogram with
+ * nanosecond resolution, sum the histograms of all ranks in comm and compute
+ * the percentiles on rank 0.  All values are multiplied by scale before being
+ * reported, e.g. 1e6 / 2 converts round trip seconds to one-way microseconds.
+ */
+void
+calculate_stats (struct stats_t * stats, int count, double scale,
+        MPI_Comm comm)
+{
+    static unsigned long long total[HIST_BUCKETS];
+    double const quantile[4] = {0.50, 0.90, 0.99, 0.999};
+    double * result[4];
+    double local_min = 1e300, local_max = 0.0;
+    unsigned long long n = 0, seen = 0, target;
+    int i, q, rank;
+
+    memset(histogram, 0, sizeof(histogram));
+
+    for (i = 0; i < count; i++) {
+        if (samples[i] < local_min) local_min = samples[i];
+        if (samples[i] > local_max) local_max = samples[i];
+
+        histogram[hist_index((unsigned long long)(samples[i] * 1e9))]++;
+    }
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Reduce(histogram, total, HIST_BUCKETS, MPI_UNSIGNED_LONG_LONG,
+            MPI_SUM, 0, comm);
+    MPI_Reduce(&local_min, &stats->min, 1, MPI_DOUBLE, MPI_MIN, 0, comm);
+    MPI_Reduce(&local_max, &stats->max, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+
+    if (rank) return;
+
+    result[0] = &stats->p50;
+    result[1] = &stats->p90;
+    result[2] = &stats->p99;
+    result[3] = &stats->p999;
+
+    for (i = 0; i < HIST_BUCKETS; i++) {
+        n += total[i];
+    }
+
+    if (0 == n) {
+        memset(stats, 0, sizeof(struct stats_t));
+        return;
+    }
+
+    stats->min *= scale;
+    stats->max *= scale;
+
+    for (i = 0, q = 0; i < HIST_BUCKETS && q < 4; i++) {
+        seen += total[i];
+
+        while (q < 4) {
+            target = (unsigned long long)ceil(quantile[q] * n);
+
+            if (seen < target) {
+                break;
+            }
+
+            *result[q] = hist_value(i) * 1e-9 * scale;
+
+            /* the bucket midpoint may fall outside of the observed range */
+            if (*result[q] < stats->min) {
+                *result[q] = stats->min;
+            }
+
+            else if (*result[q] > stats->max) {
+                *result[q] = stats->max;
+            }
+
+            q++;
+        }
+    }
+}
+
 void
 set_device_memory (void * ptr, int data, size_t size)
 {
@@ -557,8 +1843,8 @@ free_memory (void * sbuf, void * rbuf, int rank)
             }
 
             else {
-                free(sbuf);
-                free(rbuf);
+                osu_free(sbuf);
+                osu_free(rbuf);
             }
             break;
         case 1:
@@ -568,8 +1854,8 @@ free_memory (void * sbuf, void * rbuf, int rank)
             }
 
             else {
-                free(sbuf);
-                free(rbuf);
+                osu_free(sbuf);
+                osu_free(rbuf);
             }
             break;
     }
@@ -18,6 +18,13 @@
 #include <string.h>
 #include <stdint.h>
 
+#include "osu_adaptive.h"
+#include "osu_alloc.h"
+#include "osu_output.h"
+#include "osu_counters.h"
+#include "osu_pvars.h"
+#include "osu_sizes.h"
+
 #ifdef _ENABLE_CUDA_
 #include "cuda.h"
 #include "cuda_runtime.h"
@@ -47,6 +54,16 @@
 #define MYBUFSIZE (MAX_MSG_SIZE)
 
 #define WINDOW_SIZE_LARGE  64
+#define MAX_WINDOWS 16
+#define MAX_DEPTHS 64
+#define MAX_QUEUE_DEPTH 1000000
+#define MAX_MATCH_TAGS 32767
+#define MAX_MATCH_COMMS 256
+#define MAX_SENDER_COUNTS 64
+#define MAX_ROUNDS 1000000
+#define MAX_SUBDOMAINS 16
+#define MAX_HALO_CELLS (1<<22)
+#define MAX_THREADS 1024
 #define LARGE_MESSAGE_SIZE  8192
 
 #ifdef _ENABLE_OPENACC_
@@ -61,10 +78,14 @@
 #   define CUDA_ENABLED 0
 #endif
 
-extern MPI_Request request[MAX_REQ_NUM];
-extern MPI_Status  reqstat[MAX_REQ_NUM];
-extern MPI_Request send_request[MAX_REQ_NUM];
-extern MPI_Request recv_request[MAX_REQ_NUM];
+/*
+ * The request arrays hold MAX_REQ_NUM requests unless grow_requests() was
+ * called for more.
+ */
+extern MPI_Request * request;
+extern MPI_Status  * reqstat;
+extern MPI_Request * send_request;
+extern MPI_Request * recv_request;
 
 #ifdef _ENABLE_CUDA_
 extern CUcontext cuContext;
@@ -72,6 +93,17 @@ extern CUcontext cuContext;
 
 #define BW 0
 #define LAT 1
+#define DDT 2
+#define QUEUE 3
+#define MATCH 4
+#define INCAST 5
+#define MATRIX 6
+#define BISECT 7
+#define HALO 8
+#define PARTITIONED 9
+#define LAT_MT 10
+#define MULTI_LAT 11
+#define THRESHOLDS 12
 
 #define BW_LOOP_SMALL   100
 #define BW_SKIP_SMALL   10
@@ -83,6 +115,37 @@ extern CUcontext cuContext;
 #define LAT_LOOP_LARGE  1000
 #define LAT_SKIP_LARGE  10
 
+#define QUEUE_LOOP      1000
+#define QUEUE_SKIP      10
+
+#define MATRIX_LOOP     1000
+#define MATRIX_SKIP     10
+
+#define BISECT_LOOP_SMALL   10
+#define BISECT_SKIP_SMALL   2
+#define BISECT_LOOP_LARGE   4
+#define BISECT_SKIP_LARGE   1
+
+#define HALO_LOOP_SMALL     1000
+#define HALO_SKIP_SMALL     100
+#define HALO_LOOP_LARGE     100
+#define HALO_SKIP_LARGE     10
+
+#define PART_LOOP_SMALL     1000
+#define PART_SKIP_SMALL     100
+#define PART_LOOP_LARGE     100
+#define PART_SKIP_LARGE     10
+
+/*
+ * Per-iteration samples are binned into an HDR-style log-linear histogram
+ * with 2^HIST_SUB_BITS linear sub-buckets per power of two, giving a relative
+ * error below 1% while allowing histograms from many ranks to be summed.
+ */
+#define HIST_SUB_BITS       7
+#define HIST_SUB_COUNT      (1 << HIST_SUB_BITS)
+#define HIST_MAGNITUDES     40
+#define HIST_BUCKETS        (HIST_SUB_COUNT * (HIST_MAGNITUDES + 1))
+
 enum po_ret_type {
     po_cuda_not_avail,
     po_openacc_not_avail,
@@ -97,6 +160,41 @@ enum accel_type {
     openacc
 };
 
+enum ddt_type {
+    ddt_vector,
+    ddt_indexed,
+    ddt_subarray,
+    ddt_struct
+};
+
+enum send_mode {
+    send_standard,
+    send_sync,
+    send_buffered,
+    send_ready,
+    send_test,
+    send_wait,
+    NUM_SEND_MODES
+};
+
+enum halo_stencil {
+    stencil_faces = 1,
+    stencil_edges,
+    stencil_corners
+};
+
+enum halo_method {
+    halo_isend,
+    halo_sendrecv,
+    halo_alltoallw,
+    NUM_HALO_METHODS
+};
+
+enum queue_type {
+    queue_posted,
+    queue_unexpected
+};
+
 struct options_t {
     char src;
     char dst;
@@ -107,19 +205,74 @@ struct options_t {
     int skip_large;
     char managedSend;
     char managedRecv;
+    int show_full;
+    int persistent;
+    int num_windows;
+    int windows[MAX_WINDOWS];
+    int window;
+    int num_modes;
+    enum send_mode modes[NUM_SEND_MODES];
+    enum ddt_type ddt;
+    int ddt_block;
+    int ddt_stride;
+    enum queue_type queue;
+    int num_depths;
+    int depths[MAX_DEPTHS];
+    int match_tags;
+    int match_comms;
+    int num_senders;
+    int senders[MAX_SENDER_COUNTS];
+    char const * matrix_file;
+    int lat_size;
+    int bw_size;
+    int rounds;
+    unsigned seed;
+    int halo_dims;
+    int halo_periodic;
+    int halo_width;
+    enum halo_stencil stencil;
+    int num_methods;
+    enum halo_method methods[NUM_HALO_METHODS];
+    int num_subdomains;
+    int subdomains[MAX_SUBDOMAINS][3];
+    int threads;
+    int imbalance;
+};
+
+struct stats_t {
+    double min;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
 };
 
 extern struct options_t options;
+extern double * samples;
+extern char const * halo_method_names[];
 
 void usage (char const *);
 int process_options (int argc, char *argv[], int type);
 int allocate_memory (char **sbuf, char **rbuf, int rank);
+int grow_requests (int count);
 void print_header (int rank, int type);
 void touch_data (void *sbuf, void *rbuf, int rank, size_t size);
+void adaptive_schedule_pt2pt (void);
+void adaptive_finish_pt2pt (double time);
 void free_memory (void *sbuf, void *rbuf, int rank);
 int init_accel (void);
 int cleanup_accel (void);
 
+int allocate_samples (void);
+void free_samples (void);
+void calculate_stats (struct stats_t * stats, int count, double scale,
+        MPI_Comm comm);
+void print_stats (int rank, int size, double value,
+        struct stats_t const * stats);
+void set_comparison (double value, double saved);
+void set_mode_latency (int index, double value);
+
 void set_header (const char * header);
 
 #endif
@@ -0,0 +1,474 @@
+#define BENCHMARK "OSU MPI%s Protocol Threshold Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include <osu_pt2pt.h>
+
+/*
+ * A message size is taken to be handled differently from the smaller ones
+ * when its time per message differs by more than TOLERANCE, and at least
+ * MIN_DIFFERENCE us, from the linear extrapolation of the two sizes before
+ * it.  Every size is timed REPEATS times and the fastest run is used, which
+ * is much less sensitive to noise than the mean.  Thresholds are located to
+ * the byte below RESOLUTION bytes and to 1/RESOLUTION of the size above.
+ */
+#define TOLERANCE       0.10
+#define MIN_DIFFERENCE  0.05
+#define REPEATS         3
+#define RESOLUTION      4096
+#define MAX_THRESHOLDS  32
+#define WINDOW_SIZE     64
+
+struct point {
+    int size;
+    double time;
+};
+
+struct threshold {
+    struct point below;
+    struct point above;
+    double penalty;
+};
+
+struct metric {
+    char const * name;
+    double (*measure) (int size);
+    struct point last[2];
+    int num_last;
+    struct threshold thresholds[MAX_THRESHOLDS];
+    int num_thresholds;
+};
+
+static char * s_buf, * r_buf;
+static int myid;
+static int loop_small, skip_small;
+
+static void
+set_iterations (int size, int * loop, int * skip)
+{
+    *loop = size > LARGE_MESSAGE_SIZE ? options.loop_large : loop_small;
+    *skip = size > LARGE_MESSAGE_SIZE ? options.skip_large : skip_small;
+}
+
+static void
+min_time (double * time, double elapsed)
+{
+    if (0.0 == *time || elapsed < *time) {
+        *time = elapsed;
+    }
+}
+
+/*
+ * Returns the one-way latency of a ping-pong of size bytes in us, on both
+ * ranks so that they take the same decisions.
+ */
+static double
+measure_latency (int size)
+{
+    double t_start = 0.0, t_end, latency = 0.0;
+    MPI_Status reqstat;
+    int i, loop, skip;
+
+    set_iterations(size, &loop, &skip);
+    touch_data(s_buf, r_buf, myid, size);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if(myid == 0) {
+        for(i = 0; i < skip + REPEATS * loop; i++) {
+            if(i >= skip && 0 == (i - skip) % loop) {
+                t_end = MPI_Wtime();
+
+                if(i > skip) min_time(&latency, t_end - t_start);
+
+                t_start = t_end;
+            }
+
+            MPI_Send(cycle_buffer(s_buf, i, size), size, MPI_CHAR, 1, 1,
+                    MPI_COMM_WORLD);
+            MPI_Recv(cycle_buffer(r_buf, i, size), size, MPI_CHAR, 1, 1,
+                    MPI_COMM_WORLD, &reqstat);
+        }
+
+        min_time(&latency, MPI_Wtime() - t_start);
+        latency = latency * 1e6 / (2.0 * loop);
+    }
+
+    else if(myid == 1) {
+        for(i = 0; i < skip + REPEATS * loop; i++) {
+            MPI_Recv(cycle_buffer(r_buf, i, size), size, MPI_CHAR, 0, 1,
+                    MPI_COMM_WORLD, &reqstat);
+            MPI_Send(cycle_buffer(s_buf, i, size), size, MPI_CHAR, 0, 1,
+                    MPI_COMM_WORLD);
+        }
+    }
+
+    MPI_Bcast(&latency, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    return latency;
+}
+
+/*
+ * Returns the time per message of a stream of size bytes in us, i.e. the
+ * inverse of the bandwidth.  Windows of WINDOW_SIZE messages are sent as in
+ * osu_bw, as many messages per run as the latency test exchanges.
+ */
+static double
+measure_bandwidth (int size)
+{
+    double t_start = 0.0, t_end, time = 0.0;
+    int i, j, loop, skip;
+
+    set_iterations(size, &loop, &skip);
+    loop = loop > WINDOW_SIZE ? loop / WINDOW_SIZE : 1;
+    skip = skip > WINDOW_SIZE ? skip / WINDOW_SIZE : 1;
+    touch_data(s_buf, r_buf, myid, size);
+    MPI_Barrier(MPI_COMM_WORLD);
+
+    if(myid == 0) {
+        for(i = 0; i < skip + REPEATS * loop; i++) {
+            if(i >= skip && 0 == (i - skip) % loop) {
+                t_end = MPI_Wtime();
+
+                if(i > skip) min_time(&time, t_end - t_start);
+
+                t_start = t_end;
+            }
+
+            for(j = 0; j < WINDOW_SIZE; j++) {
+                MPI_Isend(cycle_buffer(s_buf, i * WINDOW_SIZE + j, size),
+                        size, MPI_CHAR, 1, 100, MPI_COMM_WORLD, request + j);
+            }
+
+            MPI_Waitall(WINDOW_SIZE, request, reqstat);
+            MPI_Recv(r_buf, 4, MPI_CHAR, 1, 101, MPI_COMM_WORLD,
+                    &reqstat[0]);
+        }
+
+        min_time(&time, MPI_Wtime() - t_start);
+        time = time * 1e6 / (loop * WINDOW_SIZE);
+    }
+
+    else if(myid == 1) {
+        for(i = 0; i < skip + REPEATS * loop; i++) {
+            for(j = 0; j < WINDOW_SIZE; j++) {
+                MPI_Irecv(cycle_buffer(r_buf, i * WINDOW_SIZE + j, size),
+                        size, MPI_CHAR, 0, 100, MPI_COMM_WORLD, request + j);
+            }
+
+            MPI_Waitall(WINDOW_SIZE, request, reqstat);
+            MPI_Send(s_buf, 4, MPI_CHAR, 0, 101, MPI_COMM_WORLD);
+        }
+    }
+
+    MPI_Bcast(&time, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+
+    return time;
+}
+
+/*
+ * Extrapolates the time of size from the last two sizes of the current
+ * protocol.  The slope is not allowed to be negative so that noise on small
+ * sizes does not predict times that shrink with the size.
+ */
+static double
+predict (struct metric const * m, int size)
+{
+    struct point const * a = &m->last[0], * b = &m->last[1];
+    double slope = (b->time - a->time) / (b->size - a->size);
+
+    return b->time + (slope > 0.0 ? slope : 0.0) * (size - b->size);
+}
+
+static double
+margin (struct metric const * m, int size)
+{
+    double margin = predict(m, size) * TOLERANCE;
+
+    return margin > MIN_DIFFERENCE ? margin : MIN_DIFFERENCE;
+}
+
+static int
+deviation (struct metric const * m, struct point const * p)
+{
+    double expected = predict(m, p->size);
+
+    if (p->time > expected + margin(m, p->size)) {
+        return 1;
+    }
+
+    else if (p->time < expected - margin(m, p->size)) {
+        return -1;
+    }
+
+    return 0;
+}
+
+static void
+add_point (struct metric * m, struct point const * p)
+{
+    if (m->num_last == 2) {
+        m->last[0] = m->last[1];
+    }
+
+    m->last[m->num_last == 2 ? 1 : m->num_last++] = *p;
+}
+
+/*
+ * Bisects the sizes between below, which behaves like the sizes before it,
+ * and above, which deviates from them in direction, down to the first size
+ * that deviates.  Both ends are timed once more at the end and the
+ * threshold is dropped unless the time steps from one to the other by more
+ * than the margin, as it does not when it changes gradually.  The step,
+ * net of the extrapolated growth, is the penalty of the threshold.
+ */
+static void
+refine (struct metric * m, struct point below, struct point above,
+        int direction)
+{
+    struct threshold * t;
+    struct point mid;
+    double step;
+
+    while (above.size - below.size > 1
+            && above.size - below.size > below.size / RESOLUTION) {
+        mid.size = below.size + (above.size - below.size) / 2;
+        mid.time = m->measure(mid.size);
+
+        if (deviation(m, &mid) == direction) {
+            above = mid;
+        }
+
+        else {
+            below = mid;
+        }
+    }
+
+    below.time = m->measure(below.size);
+    above.time = m->measure(above.size);
+    step = (above.time - predict(m, above.size))
+        - (below.time - predict(m, below.size));
+
+    if (direction * step > margin(m, above.size)
+            && m->num_thresholds < MAX_THRESHOLDS) {
+        t = &m->thresholds[m->num_thresholds++];
+        t->below = below;
+        t->above = above;
+        t->penalty = step;
+    }
+
+    m->num_last = 0;
+    add_point(m, &above);
+}
+
+/*
+ * Checks a size of the coarse sweep against the sizes before it.  A
+ * deviation is measured once more before it is refined, to rule out noise.
+ */
+static void
+check_size (struct metric * m, struct point const * p)
+{
+    struct point again = *p;
+    int direction;
+
+    if (m->num_last == 2 && (direction = deviation(m, p))) {
+        again.time = m->measure(p->size);
+
+        if (deviation(m, &again) == direction) {
+            refine(m, m->last[1], again, direction);
+
+            if (m->last[0].size == again.size) {
+                return;
+            }
+        }
+    }
+
+    add_point(m, &again);
+}
+
+static void
+print_thresholds (struct metric const * m)
+{
+    int bandwidth = m->measure == measure_bandwidth;
+    struct threshold const * t;
+    double before, after;
+    int i;
+
+    for (i = 0; i < m->num_thresholds; i++) {
+        t = &m->thresholds[i];
+        before = bandwidth ? t->below.size / t->below.time : t->below.time;
+        after = bandwidth ? t->above.size / t->above.time : t->above.time;
+
+        output_begin(t->above.size);
+        output_string("metric", m->name);
+        output_int("below", t->below.size);
+        output_double(bandwidth ? "before_mbps" : "before_us", before);
+        output_double(bandwidth ? "after_mbps" : "after_us", after);
+        output_double("penalty_us", t->penalty);
+        output_end();
+    }
+
+    if (!output_text()) return;
+
+    printf("\n# %s thresholds\n", bandwidth ? "Bandwidth" : "Latency");
+    printf("%-*s%*s%*s%*s%*s\n", 10, "# Below", 10, "Above", FIELD_WIDTH,
+            bandwidth ? "Before (MB/s)" : "Before (us)", FIELD_WIDTH,
+            bandwidth ? "After (MB/s)" : "After (us)", FIELD_WIDTH,
+            "Penalty (us)");
+
+    for (i = 0; i < m->num_thresholds; i++) {
+        t = &m->thresholds[i];
+        before = bandwidth ? t->below.size / t->below.time : t->below.time;
+        after = bandwidth ? t->above.size / t->above.time : t->above.time;
+
+        printf("%-*d%*d%*.*f%*.*f%*.*f\n", 10, t->below.size, 10,
+                t->above.size, FIELD_WIDTH, FLOAT_PRECISION, before,
+                FIELD_WIDTH, FLOAT_PRECISION, after, FIELD_WIDTH, 3,
+                t->penalty);
+    }
+
+    if (!m->num_thresholds) {
+        printf("# none found\n");
+    }
+
+    fflush(stdout);
+}
+
+int
+main (int argc, char *argv[])
+{
+    int numprocs, size;
+    struct metric latency = { "latency", measure_latency };
+    struct metric bandwidth = { "bandwidth", measure_bandwidth };
+    struct point p;
+    int po_ret = process_options(argc, argv, THRESHOLDS);
+
+    if (po_okay == po_ret && none != options.accel) {
+        if (init_accel()) {
+           fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    set_header(HEADER);
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+    MPI_Comm_rank(MPI_COMM_WORLD, &myid);
+
+    if (0 == myid) {
+        switch (po_ret) {
+            case po_cuda_not_avail:
+                fprintf(stderr, "CUDA support not enabled.  Please recompile "
+                        "benchmark with CUDA support.\n");
+                break;
+            case po_openacc_not_avail:
+                fprintf(stderr, "OPENACC support not enabled.  Please "
+                        "recompile benchmark with OPENACC support.\n");
+                break;
+            case po_bad_usage:
+            case po_help_message:
+                usage("osu_thresholds");
+                break;
+        }
+    }
+
+    switch (po_ret) {
+        case po_cuda_not_avail:
+        case po_openacc_not_avail:
+        case po_bad_usage:
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if(numprocs != 2) {
+        if(myid == 0) {
+            fprintf(stderr, "This test requires exactly two processes\n");
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    if (allocate_memory(&s_buf, &r_buf, myid)) {
+        /* Error allocating memory */
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    loop_small = options.loop;
+    skip_small = options.skip;
+    output_init(MPI_COMM_WORLD);
+
+    if (0 == myid && sizes_skipped(MAX_MSG_SIZE)) {
+        fprintf(stderr, "Skipping %d message sizes above the limit of %d "
+                "bytes\n", sizes_skipped(MAX_MSG_SIZE), MAX_MSG_SIZE);
+    }
+
+    if (0 == myid && output_text()) {
+        printf(HEADER, "");
+        printf("# Sizes whose time per message deviates by more than %d%% "
+                "from the\n# extrapolation of the smaller sizes are "
+                "bisected\n", (int)(TOLERANCE * 100));
+        printf("%-*s%*s%*s\n", 10, "# Size", FIELD_WIDTH, "Latency (us)",
+                FIELD_WIDTH, "Bandwidth (MB/s)");
+        fflush(stdout);
+    }
+
+    /* Coarse sweep */
+    for(size = first_size(1, MAX_MSG_SIZE); size <= MAX_MSG_SIZE;
+            size = next_size(size, MAX_MSG_SIZE)) {
+        p.size = size;
+        p.time = measure_latency(size);
+        check_size(&latency, &p);
+
+        p.time = measure_bandwidth(size);
+        check_size(&bandwidth, &p);
+
+        if(myid == 0) {
+            output_begin(size);
+            output_double("latency_us", latency.last[latency.num_last - 1].time);
+            output_double("bandwidth_mbps",
+                    size / bandwidth.last[bandwidth.num_last - 1].time);
+            output_end();
+
+            if (output_text()) {
+                fprintf(stdout, "%-*d%*.*f%*.*f\n", 10, size, FIELD_WIDTH,
+                        FLOAT_PRECISION,
+                        latency.last[latency.num_last - 1].time,
+                        FIELD_WIDTH, FLOAT_PRECISION,
+                        size / bandwidth.last[bandwidth.num_last - 1].time);
+                fflush(stdout);
+            }
+        }
+    }
+
+    if(myid == 0) {
+        print_thresholds(&latency);
+        print_thresholds(&bandwidth);
+    }
+
+    free_memory(s_buf, r_buf, myid);
+    MPI_Finalize();
+
+    if (none != options.accel) {
+        if (cleanup_accel()) {
+            fprintf(stderr, "Error cleaning up device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
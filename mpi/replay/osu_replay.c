@@ -0,0 +1,927 @@
+#define BENCHMARK "OSU MPI%s Trace Replay Test"
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include "osu_coll.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+
+#define MAX_LINE_LEN        1024
+#define MAX_PHASES          64
+#define MAX_PHASE_NAME_LEN  64
+#define MAX_REPEAT_DEPTH    16
+
+enum op_type {
+    op_send,
+    op_isend,
+    op_recv,
+    op_irecv,
+    op_sendrecv,
+    op_waitall,
+    op_barrier,
+    op_bcast,
+    op_reduce,
+    op_allreduce,
+    op_allgather,
+    op_alltoall,
+    op_compute,
+};
+
+/*
+ * ARGS lists the arguments of each operation: P a peer, S a size, R a root,
+ * T a tag, U microseconds.  Lower case letters are optional.
+ */
+static struct {
+    char const * name;
+    char const * args;
+} const op_info[] = {
+    [op_send] = {"send", "PSt"},
+    [op_isend] = {"isend", "PSt"},
+    [op_recv] = {"recv", "PSt"},
+    [op_irecv] = {"irecv", "PSt"},
+    [op_sendrecv] = {"sendrecv", "PSpt"},
+    [op_waitall] = {"waitall", ""},
+    [op_barrier] = {"barrier", ""},
+    [op_bcast] = {"bcast", "Sr"},
+    [op_reduce] = {"reduce", "Sr"},
+    [op_allreduce] = {"allreduce", "S"},
+    [op_allgather] = {"allgather", "S"},
+    [op_alltoall] = {"alltoall", "S"},
+    [op_compute] = {"compute", "U"},
+};
+
+#define NUM_OPS (sizeof(op_info) / sizeof(op_info[0]))
+
+struct op {
+    enum op_type type;
+    int peer;       /* destination, or root of bcast and reduce */
+    int source;     /* source of recv, irecv and sendrecv */
+    int tag;
+    int size;
+    size_t offset;  /* position in the receive buffer */
+    double seconds;
+    int phase;
+};
+
+struct trace {
+    struct op * ops;
+    int num_ops;
+    int max_ops;
+    char phases[MAX_PHASES][MAX_PHASE_NAME_LEN];
+    int num_phases;
+    size_t send_size;
+    size_t recv_size;
+    int max_requests;
+};
+
+static char error_message[MAX_LINE_LEN + 128];
+
+static void
+print_trace_help (int rank)
+{
+    if (rank) return;
+
+    printf("TRACE is a text file with one operation or directive per line, `#'\n");
+    printf("starts a comment.  SIZE is in bytes (suffix k or m for KiB or MiB),\n");
+    printf("PEER is a rank or +N/-N relative to the own rank, recv and irecv also\n");
+    printf("accept `any':\n");
+    printf("  send|isend PEER SIZE [TAG]        recv|irecv PEER SIZE [TAG]\n");
+    printf("  sendrecv DEST SIZE [SOURCE [TAG]] waitall\n");
+    printf("  barrier                           bcast|reduce SIZE [ROOT]\n");
+    printf("  allreduce|allgather|alltoall SIZE compute MICROSECONDS\n");
+    printf("  rank all|LIST  following lines only apply to the ranks in LIST,\n");
+    printf("                 e.g. 0,2-5\n");
+    printf("  phase NAME     following operations count towards phase NAME\n");
+    printf("  repeat N ... end\n");
+    printf("                 run the enclosed lines N times\n");
+    printf("\n");
+    fflush(stdout);
+}
+
+static int
+parse_error (int line, char const * message, char const * token)
+{
+    snprintf(error_message, sizeof(error_message), "line %d: %s%s%s%s",
+            line, message, token ? " `" : "", token ? token : "",
+            token ? "'" : "");
+
+    return 1;
+}
+
+static int
+parse_int (char const * token, long min, long max, long * value)
+{
+    char * end;
+
+    errno = 0;
+    *value = strtol(token, &end, 10);
+
+    return end == token || '\0' != *end || errno || *value < min
+        || *value > max;
+}
+
+static int
+parse_size (char const * token, int * size)
+{
+    unsigned long long value;
+    char * end;
+
+    if (!isdigit((unsigned char)token[0])) {
+        return 1;
+    }
+
+    errno = 0;
+    value = strtoull(token, &end, 10);
+
+    if ('k' == *end || 'K' == *end) {
+        value <<= 10;
+        end++;
+    }
+
+    else if ('m' == *end || 'M' == *end) {
+        value <<= 20;
+        end++;
+    }
+
+    if ('\0' != *end || errno || value > INT_MAX) {
+        return 1;
+    }
+
+    *size = value;
+
+    return 0;
+}
+
+static int
+parse_peer (char const * token, int rank, int numprocs, int any, int * peer)
+{
+    long value;
+
+    if (any && 0 == strcmp(token, "any")) {
+        *peer = MPI_ANY_SOURCE;
+        return 0;
+    }
+
+    if ('+' == token[0] || '-' == token[0]) {
+        if (parse_int(token, -INT_MAX, INT_MAX, &value)) {
+            return 1;
+        }
+
+        *peer = ((rank + value) % numprocs + numprocs) % numprocs;
+        return 0;
+    }
+
+    if (parse_int(token, 0, numprocs - 1, &value)) {
+        return 1;
+    }
+
+    *peer = value;
+
+    return 0;
+}
+
+/*
+ * Returns 1 if rank is in the comma separated list of ranks and rank ranges.
+ */
+static int
+parse_ranks (char const * list, int rank, int * selected)
+{
+    char const * p = list;
+    long first, last;
+    char * end;
+
+    *selected = 0 == strcmp(list, "all") || 0 == strcmp(list, "*");
+
+    while (!*selected && *p) {
+        first = last = strtol(p, &end, 10);
+
+        if (end == p || first < 0) {
+            return 1;
+        }
+
+        if ('-' == *end) {
+            p = end + 1;
+            last = strtol(p, &end, 10);
+
+            if (end == p || last < first) {
+                return 1;
+            }
+        }
+
+        if (',' != *end && '\0' != *end) {
+            return 1;
+        }
+
+        *selected = first <= rank && rank <= last;
+        p = end + (',' == *end);
+    }
+
+    return 0;
+}
+
+static int
+find_phase (struct trace * trace, char const * name)
+{
+    int i;
+
+    for (i = 0; i < trace->num_phases; i++) {
+        if (0 == strcmp(trace->phases[i], name)) {
+            return i;
+        }
+    }
+
+    if (MAX_PHASES == trace->num_phases) {
+        return -1;
+    }
+
+    snprintf(trace->phases[i], MAX_PHASE_NAME_LEN, "%s", name);
+
+    return trace->num_phases++;
+}
+
+static struct op *
+add_op (struct trace * trace)
+{
+    struct op * ops = trace->ops;
+
+    if (trace->num_ops == trace->max_ops) {
+        trace->max_ops = trace->max_ops ? 2 * trace->max_ops : 256;
+
+        if (NULL == (ops = realloc(ops, trace->max_ops * sizeof(struct op)))) {
+            fprintf(stderr, "Error allocating memory for the trace\n");
+            MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+        }
+
+        trace->ops = ops;
+    }
+
+    memset(&ops[trace->num_ops], 0, sizeof(struct op));
+
+    return &ops[trace->num_ops++];
+}
+
+/*
+ * Parses the arguments of an operation in the order given by op_info.
+ */
+static int
+parse_op (struct trace * trace, enum op_type type, char ** tokens,
+        int num_tokens, int rank, int numprocs, int line)
+{
+    char const * args = op_info[type].args;
+    struct op op;
+    long value;
+    int i;
+
+    memset(&op, 0, sizeof(op));
+    op.type = type;
+    op.source = -1;
+
+    if (num_tokens > (int)strlen(args)) {
+        return parse_error(line, "too many arguments for",
+                op_info[type].name);
+    }
+
+    for (i = 0; args[i]; i++) {
+        char const * token = i < num_tokens ? tokens[i] : NULL;
+
+        if (NULL == token) {
+            if (isupper((unsigned char)args[i])) {
+                return parse_error(line, "missing arguments for",
+                        op_info[type].name);
+            }
+
+            continue;
+        }
+
+        switch (tolower((unsigned char)args[i])) {
+            case 'p':
+                if (parse_peer(token, rank, numprocs, type == op_recv
+                            || type == op_irecv || (type == op_sendrecv
+                                && 0 != i), i ? &op.source : &op.peer)) {
+                    return parse_error(line, "invalid peer", token);
+                }
+                break;
+            case 's':
+                if (parse_size(token, &op.size)) {
+                    return parse_error(line, "invalid size", token);
+                }
+                break;
+            case 'r':
+                if (parse_int(token, 0, numprocs - 1, &value)) {
+                    return parse_error(line, "invalid root", token);
+                }
+
+                op.peer = value;
+                break;
+            case 't':
+                if (parse_int(token, 0, 32767, &value)) {
+                    return parse_error(line, "invalid tag", token);
+                }
+
+                op.tag = value;
+                break;
+            case 'u':
+                op.seconds = strtod(token, NULL) / 1e6;
+
+                if (!(op.seconds >= 0.0)) {
+                    return parse_error(line, "invalid time", token);
+                }
+                break;
+        }
+    }
+
+    /* receives name their source as the peer */
+    if (type == op_recv || type == op_irecv) {
+        op.source = op.peer;
+    }
+
+    else if (type == op_sendrecv && op.source < 0) {
+        op.source = op.peer;
+    }
+
+    *add_op(trace) = op;
+
+    return 0;
+}
+
+/*
+ * Parses the trace text into the operations of this rank.  Every rank sees
+ * the same phases, so that their times can be combined.
+ */
+static int
+parse_trace (char * text, int rank, int numprocs, struct trace * trace)
+{
+    char * tokens[8], * p, * next;
+    int repeat_start[MAX_REPEAT_DEPTH], repeat_count[MAX_REPEAT_DEPTH];
+    int depth = 0, line = 0, active = 1, phase = 0, num_tokens, i, j;
+    long value;
+
+    memset(trace, 0, sizeof(*trace));
+    find_phase(trace, "(none)");
+
+    for (p = text; p && *p; p = next) {
+        line++;
+
+        if ((next = strchr(p, '\n'))) {
+            *next++ = '\0';
+        }
+
+        p[strcspn(p, "#")] = '\0';
+
+        for (num_tokens = 0; num_tokens < 8; num_tokens++) {
+            if (NULL == (tokens[num_tokens] = strtok(num_tokens ? NULL : p,
+                            " \t\r"))) {
+                break;
+            }
+        }
+
+        if (0 == num_tokens) {
+            continue;
+        }
+
+        if (8 == num_tokens) {
+            return parse_error(line, "too many arguments", NULL);
+        }
+
+        if (0 == strcmp(tokens[0], "rank")) {
+            if (2 != num_tokens || parse_ranks(tokens[1], rank, &active)) {
+                return parse_error(line, "invalid rank list", tokens[1]);
+            }
+        }
+
+        else if (0 == strcmp(tokens[0], "phase")) {
+            if (2 != num_tokens) {
+                return parse_error(line, "phase needs a name", NULL);
+            }
+
+            if ((phase = find_phase(trace, tokens[1])) < 0) {
+                return parse_error(line, "too many phases", NULL);
+            }
+        }
+
+        else if (0 == strcmp(tokens[0], "repeat")) {
+            if (2 != num_tokens || parse_int(tokens[1], 1, INT_MAX, &value)) {
+                return parse_error(line, "invalid repeat count", tokens[1]);
+            }
+
+            if (MAX_REPEAT_DEPTH == depth) {
+                return parse_error(line, "repeat nested too deeply", NULL);
+            }
+
+            repeat_start[depth] = trace->num_ops;
+            repeat_count[depth++] = value;
+        }
+
+        else if (0 == strcmp(tokens[0], "end")) {
+            int first, last;
+
+            if (0 == depth) {
+                return parse_error(line, "end without repeat", NULL);
+            }
+
+            first = repeat_start[--depth];
+            last = trace->num_ops;
+
+            for (i = 1; i < repeat_count[depth]; i++) {
+                for (j = first; j < last; j++) {
+                    struct op * op = add_op(trace);
+
+                    *op = trace->ops[j];
+                }
+            }
+        }
+
+        else {
+            for (i = 0; i < (int)NUM_OPS; i++) {
+                if (0 == strcmp(tokens[0], op_info[i].name)) {
+                    break;
+                }
+            }
+
+            if (NUM_OPS == i) {
+                return parse_error(line, "unknown operation", tokens[0]);
+            }
+
+            if (parse_op(trace, i, tokens + 1, num_tokens - 1, rank, numprocs,
+                        line)) {
+                return 1;
+            }
+
+            if (active) {
+                trace->ops[trace->num_ops - 1].phase = phase;
+            }
+
+            else {
+                trace->num_ops--;
+            }
+        }
+    }
+
+    if (depth) {
+        return parse_error(line, "repeat without end", NULL);
+    }
+
+    return 0;
+}
+
+/*
+ * Lays out the receive buffer, so that pending nonblocking receives do not
+ * overlap, and sizes the buffers and the request array.
+ */
+static void
+layout_trace (struct trace * trace, int numprocs)
+{
+    size_t pending = 0, send_size, recv_size;
+    int requests = 0, i;
+
+    for (i = 0; i < trace->num_ops; i++) {
+        struct op * op = &trace->ops[i];
+        size_t size = op->size;
+
+        send_size = recv_size = 0;
+
+        switch (op->type) {
+            case op_send:
+            case op_isend:
+                send_size = size;
+                break;
+            case op_recv:
+            case op_irecv:
+                recv_size = size;
+                break;
+            case op_sendrecv:
+            case op_bcast:
+                send_size = recv_size = size;
+                break;
+            case op_reduce:
+            case op_allreduce:
+                send_size = recv_size = max(size, sizeof(float));
+                break;
+            case op_allgather:
+                send_size = size;
+                recv_size = size * numprocs;
+                break;
+            case op_alltoall:
+                send_size = recv_size = size * numprocs;
+                break;
+            default:
+                break;
+        }
+
+        op->offset = pending;
+        trace->send_size = max(trace->send_size, send_size);
+        trace->recv_size = max(trace->recv_size, pending + recv_size);
+
+        if (op_irecv == op->type) {
+            pending += size;
+        }
+
+        if (op_irecv == op->type || op_isend == op->type) {
+            trace->max_requests = max(trace->max_requests, ++requests);
+        }
+
+        else if (op_waitall == op->type) {
+            pending = 0;
+            requests = 0;
+        }
+    }
+
+    trace->send_size = max(trace->send_size, 1);
+    trace->recv_size = max(trace->recv_size, 1);
+    trace->max_requests = max(trace->max_requests, 1);
+}
+
+/*
+ * Runs the trace once and adds the time spent in every phase.  Requests still
+ * pending at the end are completed as part of the last operation.
+ */
+static void
+replay (struct trace const * trace, MPI_Comm comm, char * sendbuf,
+        char * recvbuf, MPI_Request * requests, double * phase_time)
+{
+    double t_last = MPI_Wtime(), t_now;
+    int num_requests = 0, i;
+
+    for (i = 0; i < trace->num_ops; i++) {
+        struct op const * op = &trace->ops[i];
+        char * rbuf = recvbuf + op->offset;
+        int count = max(op->size / (int)sizeof(float), 1);
+
+        switch (op->type) {
+            case op_send:
+                MPI_Send(sendbuf, op->size, MPI_CHAR, op->peer, op->tag, comm);
+                break;
+            case op_isend:
+                MPI_Isend(sendbuf, op->size, MPI_CHAR, op->peer, op->tag, comm,
+                        &requests[num_requests++]);
+                break;
+            case op_recv:
+                MPI_Recv(rbuf, op->size, MPI_CHAR, op->source, op->tag, comm,
+                        MPI_STATUS_IGNORE);
+                break;
+            case op_irecv:
+                MPI_Irecv(rbuf, op->size, MPI_CHAR, op->source, op->tag, comm,
+                        &requests[num_requests++]);
+                break;
+            case op_sendrecv:
+                MPI_Sendrecv(sendbuf, op->size, MPI_CHAR, op->peer, op->tag,
+                        rbuf, op->size, MPI_CHAR, op->source, op->tag, comm,
+                        MPI_STATUS_IGNORE);
+                break;
+            case op_waitall:
+                MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+                num_requests = 0;
+                break;
+            case op_barrier:
+                MPI_Barrier(comm);
+                break;
+            case op_bcast:
+                MPI_Bcast(rbuf, op->size, MPI_CHAR, op->peer, comm);
+                break;
+            case op_reduce:
+                MPI_Reduce(sendbuf, rbuf, count, MPI_FLOAT, MPI_SUM, op->peer,
+                        comm);
+                break;
+            case op_allreduce:
+                MPI_Allreduce(sendbuf, rbuf, count, MPI_FLOAT, MPI_SUM, comm);
+                break;
+            case op_allgather:
+                MPI_Allgather(sendbuf, op->size, MPI_CHAR, rbuf, op->size,
+                        MPI_CHAR, comm);
+                break;
+            case op_alltoall:
+                MPI_Alltoall(sendbuf, op->size, MPI_CHAR, rbuf, op->size,
+                        MPI_CHAR, comm);
+                break;
+            case op_compute:
+                while (MPI_Wtime() - t_last < op->seconds);
+                break;
+        }
+
+        if (num_requests && i == trace->num_ops - 1) {
+            MPI_Waitall(num_requests, requests, MPI_STATUSES_IGNORE);
+        }
+
+        t_now = MPI_Wtime();
+        phase_time[op->phase] += t_now - t_last;
+        t_last = t_now;
+    }
+}
+
+/*
+ * Reads the trace on rank 0 and hands it to every rank.
+ */
+static char *
+read_trace (char const * filename, int rank)
+{
+    long length = 0;
+    char * text = NULL;
+    FILE * file;
+
+    if (0 == rank) {
+        if (NULL == (file = fopen(filename, "r"))) {
+            fprintf(stderr, "Could not open trace `%s': %s\n", filename,
+                    strerror(errno));
+            length = -1;
+        }
+
+        else {
+            fseek(file, 0, SEEK_END);
+            length = ftell(file);
+            rewind(file);
+
+            if (length < 0 || NULL == (text = malloc(length + 1))
+                    || fread(text, 1, length, file) != (size_t)length) {
+                fprintf(stderr, "Could not read trace `%s'\n", filename);
+                length = -1;
+            }
+
+            fclose(file);
+        }
+    }
+
+    MPI_Bcast(&length, 1, MPI_LONG, 0, MPI_COMM_WORLD);
+
+    if (length < 0) {
+        free(text);
+        return NULL;
+    }
+
+    if (rank && NULL == (text = malloc(length + 1))) {
+        fprintf(stderr, "Error allocating memory for the trace\n");
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    MPI_Bcast(text, length, MPI_CHAR, 0, MPI_COMM_WORLD);
+    text[length] = '\0';
+
+    return text;
+}
+
+/*
+ * Prints the time per replay spent in every phase: the average, minimum and
+ * maximum over all ranks and the share of the average replay time.
+ */
+static void
+print_phases (int rank, int numprocs, struct trace const * trace,
+        double const * phase_time, double avg_time)
+{
+    double data[4 * MAX_PHASES], min_data[MAX_PHASES], max_data[MAX_PHASES];
+    double * avg = data, * ops = data + MAX_PHASES;
+    double * bytes = data + 2 * MAX_PHASES, * share = data + 3 * MAX_PHASES;
+    int n = trace->num_phases, width = 16, i;
+
+    memset(data, 0, sizeof(data));
+
+    for (i = 0; i < n; i++) {
+        avg[i] = phase_time[i] * 1e6 / options.iterations;
+    }
+
+    for (i = 0; i < trace->num_ops; i++) {
+        struct op const * op = &trace->ops[i];
+
+        ops[op->phase] += 1.0;
+
+        if (op_recv != op->type && op_irecv != op->type) {
+            bytes[op->phase] += op->size;
+        }
+    }
+
+    MPI_Reduce(avg, min_data, n, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+    MPI_Reduce(avg, max_data, n, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(0 == rank ? MPI_IN_PLACE : data, data, 3 * MAX_PHASES,
+            MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+    if (rank) return;
+
+    for (i = 0; i < n; i++) {
+        avg[i] /= numprocs;
+        share[i] = avg_time > 0.0 ? 100.0 * avg[i] / avg_time : 0.0;
+
+        if ((int)strlen(trace->phases[i]) + 2 > width) {
+            width = strlen(trace->phases[i]) + 2;
+        }
+    }
+
+    for (i = 0; i < n; i++) {
+        if (0.0 == ops[i] && 0.0 == avg[i]) {
+            continue;
+        }
+
+        output_begin(0);
+        output_string("phase", trace->phases[i]);
+        output_double("avg_us", avg[i]);
+        output_double("min_us", min_data[i]);
+        output_double("max_us", max_data[i]);
+        output_double("share_pct", share[i]);
+        output_double("operations", ops[i]);
+        output_double("bytes", bytes[i]);
+        output_int("iterations", options.iterations);
+        output_end();
+    }
+
+    if (!output_text()) return;
+
+    fprintf(stdout, "\n# Per replay and phase: operations and bytes sent by "
+            "all ranks, time over ranks\n");
+    fprintf(stdout, "%-*s", width, "# Phase");
+    fprintf(stdout, "%*s", FIELD_WIDTH, "Operations");
+    fprintf(stdout, "%*s", FIELD_WIDTH, "Bytes");
+    fprintf(stdout, "%*s", FIELD_WIDTH, "Avg Time(us)");
+    fprintf(stdout, "%*s", FIELD_WIDTH, "Min Time(us)");
+    fprintf(stdout, "%*s", FIELD_WIDTH, "Max Time(us)");
+    fprintf(stdout, "%*s\n", FIELD_WIDTH, "Share(%)");
+
+    for (i = 0; i < n; i++) {
+        if (0.0 == ops[i] && 0.0 == avg[i]) {
+            continue;
+        }
+
+        fprintf(stdout, "%-*s", width, trace->phases[i]);
+        fprintf(stdout, "%*.0f%*.0f", FIELD_WIDTH, ops[i], FIELD_WIDTH,
+                bytes[i]);
+        fprintf(stdout, "%*.*f%*.*f%*.*f%*.*f\n",
+                FIELD_WIDTH, FLOAT_PRECISION, avg[i],
+                FIELD_WIDTH, FLOAT_PRECISION, min_data[i],
+                FIELD_WIDTH, FLOAT_PRECISION, max_data[i],
+                FIELD_WIDTH, FLOAT_PRECISION, share[i]);
+    }
+
+    fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+    int i = 0, rank, failed;
+    int numprocs;
+    double avg_time = 0.0, max_time = 0.0, min_time = 0.0;
+    double latency = 0.0, t_start = 0.0, t_stop = 0.0;
+    double timer=0.0;
+    double phase_time[MAX_PHASES];
+    char * sendbuf = NULL, * recvbuf = NULL, * text;
+    MPI_Request * requests;
+    struct trace trace;
+    int po_ret;
+    MPI_Comm comm;
+
+    set_header(HEADER);
+    set_benchmark_name("osu_replay");
+    enable_accel_support();
+    enable_replay_support();
+    po_ret = process_options(argc, argv);
+
+    if (po_okay == po_ret && none != options.accel) {
+        if (init_accel()) {
+            fprintf(stderr, "Error initializing device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    options.show_size = 0;
+
+    MPI_Init(&argc, &argv);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &numprocs);
+
+    if (po_okay == po_ret && optind != argc - 1) {
+        if (0 == rank) {
+            fprintf(stderr, "Please specify one trace file\n\n");
+        }
+
+        po_ret = po_help_message;
+        failed = 1;
+    }
+
+    else {
+        failed = 0;
+    }
+
+    switch (po_ret) {
+        case po_bad_usage:
+            print_bad_usage_message(rank);
+            print_trace_help(rank);
+            MPI_Finalize();
+            exit(EXIT_FAILURE);
+        case po_help_message:
+            print_help_message(rank);
+            print_trace_help(rank);
+            MPI_Finalize();
+            exit(failed ? EXIT_FAILURE : EXIT_SUCCESS);
+        case po_version_message:
+            print_version_message(rank);
+            MPI_Finalize();
+            exit(EXIT_SUCCESS);
+        case po_okay:
+            break;
+    }
+
+    if (NULL == (text = read_trace(argv[optind], rank))) {
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    /* the lowest rank with an error reports it */
+    failed = parse_trace(text, rank, numprocs, &trace) ? rank : numprocs;
+    MPI_Allreduce(MPI_IN_PLACE, &failed, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+    free(text);
+
+    if (failed < numprocs) {
+        if (rank == failed) {
+            fprintf(stderr, "Error in trace `%s', %s\n", argv[optind],
+                    error_message);
+        }
+
+        MPI_Finalize();
+        exit(EXIT_FAILURE);
+    }
+
+    layout_trace(&trace, numprocs);
+    requests = malloc(trace.max_requests * sizeof(MPI_Request));
+
+    if (NULL == requests || allocate_buffer((void **)&sendbuf,
+                trace.send_size + buffer_pool_size(), options.accel)
+            || allocate_buffer((void **)&recvbuf,
+                trace.recv_size + buffer_pool_size(), options.accel)) {
+        fprintf(stderr, "Could Not Allocate Memory [rank %d]\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, EXIT_FAILURE);
+    }
+
+    set_buffer(sendbuf, options.accel, 1, trace.send_size + buffer_pool_size());
+    set_buffer(recvbuf, options.accel, 0, trace.recv_size + buffer_pool_size());
+
+    print_preamble(rank);
+
+    while (next_algorithm(&comm)) {
+        options.skip = options.skip_large;
+        options.iterations = options.iterations_large;
+        timer = 0.0;
+        schedule_iterations();
+        pvars_begin();
+
+        for(i=0; i < options.iterations + options.skip ; i++) {
+            if(i == options.skip) {
+                counters_reset();
+                memset(phase_time, 0, sizeof(phase_time));
+            }
+            if(i >= options.skip) counters_start();
+            t_start = MPI_Wtime();
+            replay(&trace, comm, cycle_buffer(sendbuf, i, trace.send_size),
+                    cycle_buffer(recvbuf, i, trace.recv_size), requests,
+                    phase_time);
+            t_stop = MPI_Wtime();
+            counters_stop();
+
+            if(i>=options.skip){
+                timer+=t_stop-t_start;
+            }
+
+            finish_iteration(i >= options.skip, t_start, t_stop);
+        }
+
+        latency = (timer * 1e6) / options.iterations;
+
+        MPI_Reduce(&latency, &min_time, 1, MPI_DOUBLE, MPI_MIN, 0,
+                    MPI_COMM_WORLD);
+        MPI_Reduce(&latency, &max_time, 1, MPI_DOUBLE, MPI_MAX, 0,
+                    MPI_COMM_WORLD);
+        MPI_Reduce(&latency, &avg_time, 1, MPI_DOUBLE, MPI_SUM, 0,
+                    MPI_COMM_WORLD);
+        avg_time = avg_time/numprocs;
+
+        if (options.global_sync) {
+            get_completion_stats(&avg_time, &min_time, &max_time);
+        }
+
+        counters_reduce(options.iterations, MPI_COMM_WORLD);
+
+        pvars_end(MPI_COMM_WORLD);
+        print_stats(rank, 0, avg_time, min_time, max_time);
+        print_phases(rank, numprocs, &trace, phase_time, avg_time);
+    }
+
+    free_buffer(sendbuf, options.accel);
+    free_buffer(recvbuf, options.accel);
+    free(requests);
+    free(trace.ops);
+
+    MPI_Finalize();
+
+    if (none != options.accel) {
+        if (cleanup_accel()) {
+            fprintf(stderr, "Error cleaning up device\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,610 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include <mpi.h>
+#include <dirent.h>
+#include <dlfcn.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef PACKAGE_VERSION
+#   define HEADER "# OSU MPI Benchmark Suite v" PACKAGE_VERSION "\n"
+#else
+#   define HEADER "# OSU MPI Benchmark Suite\n"
+#endif
+
+#ifndef FIELD_WIDTH
+#   define FIELD_WIDTH 20
+#endif
+
+#ifndef FLOAT_PRECISION
+#   define FLOAT_PRECISION 2
+#endif
+
+#ifndef SUITE_MODULE_DIR
+#   define SUITE_MODULE_DIR "."
+#endif
+
+#define MODULE_SUFFIX       ".so"
+#define MAX_SEARCH_DIRS     4
+#define MAX_LINE_LEN        4096
+#define STATUS_NOT_FOUND    (-1)
+
+/*
+ * Every benchmark is built unmodified as a loadable module and run by
+ * calling its main function.  Loading a fresh copy of the module for every
+ * run gives it the same static state it would have as a separate program.
+ */
+typedef int (*benchmark_main) (int, char **);
+
+struct benchmark {
+    int argc;
+    char ** argv;
+    int status;
+    double time;
+};
+
+static struct benchmark * benchmarks = NULL;
+static int num_benchmarks = 0;
+static char const * output_spec = NULL;
+static char * search_dirs[MAX_SEARCH_DIRS];
+static int num_search_dirs = 0;
+static int rank = 0;
+static int running = 0;
+static jmp_buf benchmark_exit;
+
+/*
+ * MPI is initialized once by the suite and finalized when it exits, so the
+ * calls the benchmarks make are intercepted here through the profiling
+ * interface.
+ */
+int
+MPI_Init (int * argc, char *** argv)
+{
+    return MPI_SUCCESS;
+}
+
+int
+MPI_Init_thread (int * argc, char *** argv, int required, int * provided)
+{
+    return PMPI_Query_thread(provided);
+}
+
+int
+MPI_Finalize (void)
+{
+    return MPI_SUCCESS;
+}
+
+/*
+ * A benchmark that exits, e.g. because it needs a different number of
+ * processes, returns to run_benchmark() with its exit status instead of
+ * ending the suite.  MPI_Abort still takes down the whole job.
+ */
+void
+exit (int status)
+{
+    void (*libc_exit) (int);
+
+    if (running) {
+        running = 0;
+        longjmp(benchmark_exit, (status & 0xff) | 0x100);
+    }
+
+    if ((libc_exit = (void (*) (int))dlsym(RTLD_NEXT, "exit"))) {
+        libc_exit(status);
+    }
+
+    _exit(status);
+}
+
+int
+MPI_Abort (MPI_Comm comm, int errorcode)
+{
+    running = 0;
+
+    return PMPI_Abort(comm, errorcode);
+}
+
+/*
+ * Also called when the suite exits on an error path.
+ */
+static void
+finalize (void)
+{
+    int flag;
+
+    PMPI_Finalized(&flag);
+
+    if (!flag) {
+        PMPI_Finalize();
+    }
+}
+
+static void
+usage (char const * name)
+{
+    printf("Usage: %s [options] BENCHMARK [OPTIONS] [-- BENCHMARK [OPTIONS]]...\n\n",
+            name);
+    printf("Run several benchmarks back to back in a single MPI job.  Each\n"
+           "BENCHMARK is the name of a test, e.g. osu_latency, followed by its\n"
+           "own options.\n\n");
+    printf("options:\n");
+    printf("  -F FILE       read additional benchmarks from FILE, one per line\n"
+           "                with its options (`#' starts a comment)\n");
+    printf("  -o FORMAT[:FILE]\n"
+           "                pass `-o FORMAT[:FILE]' to every benchmark that writes\n"
+           "                machine readable records\n");
+    printf("  -l            list the available benchmarks\n");
+    printf("  -h            print this help message\n");
+    fflush(stdout);
+}
+
+static int
+add_benchmark (int argc, char * argv[])
+{
+    struct benchmark * b;
+    int i;
+
+    b = realloc(benchmarks, (num_benchmarks + 1) * sizeof(struct benchmark));
+
+    if (NULL == b) {
+        return 1;
+    }
+
+    benchmarks = b;
+    b = &benchmarks[num_benchmarks];
+    b->argc = argc;
+    b->argv = malloc((argc + 1) * sizeof(char *));
+    b->status = STATUS_NOT_FOUND;
+    b->time = 0.0;
+
+    if (NULL == b->argv) {
+        return 1;
+    }
+
+    for (i = 0; i < argc; i++) {
+        b->argv[i] = strdup(argv[i]);
+    }
+
+    b->argv[argc] = NULL;
+    num_benchmarks++;
+
+    return 0;
+}
+
+/*
+ * Splits the remaining command line into benchmarks separated by `--'.  A
+ * `:' would be taken by mpirun as the separator of an MPMD launch.
+ */
+static int
+add_benchmarks (int argc, char * argv[])
+{
+    int first = 0, i;
+
+    for (i = 0; i <= argc; i++) {
+        if (i < argc && strcmp(argv[i], "--")) {
+            continue;
+        }
+
+        if (i == first || add_benchmark(i - first, argv + first)) {
+            return 1;
+        }
+
+        first = i + 1;
+    }
+
+    return 0;
+}
+
+static int
+read_benchmarks (char const * filename)
+{
+    char line[MAX_LINE_LEN];
+    char * tokens[MAX_LINE_LEN / 2];
+    char * token, * saveptr;
+    int count;
+    FILE * fp = fopen(filename, "r");
+
+    if (NULL == fp) {
+        fprintf(stderr, "Error opening benchmark list `%s'\n", filename);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), fp)) {
+        count = 0;
+
+        for (token = strtok_r(line, " \t\r\n", &saveptr);
+                token && '#' != *token;
+                token = strtok_r(NULL, " \t\r\n", &saveptr)) {
+            tokens[count++] = token;
+        }
+
+        if (count && add_benchmark(count, tokens)) {
+            fclose(fp);
+            return 1;
+        }
+    }
+
+    fclose(fp);
+
+    return 0;
+}
+
+/*
+ * Modules are looked up in $OSU_SUITE_PATH, next to the suite (and in the
+ * libtool object directory when run from the build tree), and finally in the
+ * directory they are installed to.
+ */
+static void
+set_search_dirs (char const * program)
+{
+    char const * env = getenv("OSU_SUITE_PATH");
+    char const * slash = strrchr(program, '/');
+    size_t length = slash ? (size_t)(slash - program) : 1;
+    char * dir;
+
+    if (env && *env) {
+        search_dirs[num_search_dirs++] = strdup(env);
+    }
+
+    if ((dir = malloc(length + sizeof("/.libs")))) {
+        memcpy(dir, slash ? program : ".", length);
+        dir[length] = '\0';
+        search_dirs[num_search_dirs++] = dir;
+    }
+
+    if ((dir = malloc(length + sizeof("/.libs")))) {
+        sprintf(dir, "%s/.libs", search_dirs[num_search_dirs - 1]);
+        search_dirs[num_search_dirs++] = dir;
+    }
+
+    search_dirs[num_search_dirs++] = strdup(SUITE_MODULE_DIR);
+}
+
+static void *
+open_benchmark (char const * name)
+{
+    char path[MAX_LINE_LEN];
+    void * handle;
+    int i;
+
+    if (strchr(name, '/')) {
+        return NULL;
+    }
+
+    for (i = 0; i < num_search_dirs; i++) {
+        if (NULL == search_dirs[i]) {
+            continue;
+        }
+
+        snprintf(path, sizeof(path), "%s/%s" MODULE_SUFFIX, search_dirs[i],
+                name);
+
+        if (access(path, F_OK)) {
+            continue;
+        }
+
+        if (NULL == (handle = dlopen(path, RTLD_NOW | RTLD_LOCAL))) {
+            fprintf(stderr, "Error loading %s: %s\n", path, dlerror());
+        }
+
+        return handle;
+    }
+
+    return NULL;
+}
+
+static void
+list_benchmarks (void)
+{
+    size_t suffix = strlen(MODULE_SUFFIX);
+    struct dirent * entry;
+    DIR * dir;
+    int i, count = 0;
+
+    /* list the first directory that has any benchmarks in it */
+    for (i = 0; i < num_search_dirs && 0 == count; i++) {
+        if (NULL == search_dirs[i]
+                || NULL == (dir = opendir(search_dirs[i]))) {
+            continue;
+        }
+
+        while ((entry = readdir(dir))) {
+            size_t length = strlen(entry->d_name);
+
+            if (0 == strncmp(entry->d_name, "osu_", 4) && length > suffix
+                    && 0 == strcmp(entry->d_name + length - suffix,
+                        MODULE_SUFFIX)) {
+                printf("%.*s\n", (int)(length - suffix), entry->d_name);
+                count++;
+            }
+        }
+
+        closedir(dir);
+    }
+
+    if (0 == count) {
+        fprintf(stderr, "No benchmarks found\n");
+    }
+
+    fflush(stdout);
+}
+
+static void
+free_arguments (char ** argv, int argc)
+{
+    int i;
+
+    for (i = 0; i < argc; i++) {
+        free(argv[i]);
+    }
+
+    free(argv);
+}
+
+/*
+ * Returns a copy of the command line of the benchmark, with `-o SPEC'
+ * inserted after the benchmark name when output is forwarded.  Benchmarks
+ * tokenize their option arguments in place, so every run gets its own
+ * strings and the summary still shows the original command line.
+ */
+static char **
+copy_arguments (struct benchmark const * b, int forward, int * argc)
+{
+    char ** argv = malloc((b->argc + 3) * sizeof(char *));
+    int i, n = 0;
+
+    if (NULL == argv) {
+        return NULL;
+    }
+
+    argv[n++] = strdup(b->argv[0]);
+
+    if (forward) {
+        argv[n++] = strdup("-o");
+        argv[n++] = strdup(output_spec);
+    }
+
+    for (i = 1; i < b->argc; i++) {
+        argv[n++] = strdup(b->argv[i]);
+    }
+
+    argv[n] = NULL;
+    *argc = n;
+
+    for (i = 0; i < n; i++) {
+        if (NULL == argv[i]) {
+            free_arguments(argv, n);
+            return NULL;
+        }
+    }
+
+    return argv;
+}
+
+static void
+run_benchmark (struct benchmark * b)
+{
+    void * handle = open_benchmark(b->argv[0]);
+    benchmark_main volatile entry = NULL;
+    char ** volatile argv = NULL;
+    int argc = 0;
+    int loaded, status;
+    double t_start;
+
+    if (handle) {
+        entry = (benchmark_main)dlsym(handle, "main");
+    }
+
+    if (entry) {
+        argv = copy_arguments(b, output_spec && dlsym(handle, "set_output"),
+                &argc);
+    }
+
+    /* every rank has to run the benchmark or none at all */
+    loaded = NULL != argv;
+    MPI_Allreduce(MPI_IN_PLACE, &loaded, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+
+    if (!loaded) {
+        if (0 == rank) {
+            fprintf(stderr, "Benchmark `%s' not found\n", b->argv[0]);
+        }
+
+        if (argv) {
+            free_arguments(argv, argc);
+        }
+
+        if (handle) {
+            dlclose(handle);
+        }
+
+        b->status = STATUS_NOT_FOUND;
+        return;
+    }
+
+    /*
+     * The benchmarks parse their options with getopt from the start.  0
+     * rather than 1 also drops the position getopt kept within the freed
+     * arguments of the previous benchmark.
+     */
+    optind = 0;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    t_start = MPI_Wtime();
+
+    if (0 == (status = setjmp(benchmark_exit))) {
+        running = 1;
+        b->status = entry(argc, argv);
+        running = 0;
+    }
+
+    else {
+        b->status = status & 0xff;
+    }
+
+    b->time = MPI_Wtime() - t_start;
+    fflush(stdout);
+    fflush(stderr);
+
+    MPI_Allreduce(MPI_IN_PLACE, &b->status, 1, MPI_INT, MPI_MAX,
+            MPI_COMM_WORLD);
+
+    free_arguments(argv, argc);
+    dlclose(handle);
+}
+
+static void
+print_summary (void)
+{
+    char command[MAX_LINE_LEN];
+    char status[32];
+    size_t length;
+    int i, j;
+
+    printf("\n# Summary\n");
+    printf("%-*s%*s%*s\n", 40, "# Benchmark", 12, "Status", FIELD_WIDTH,
+            "Time (s)");
+
+    for (i = 0; i < num_benchmarks; i++) {
+        struct benchmark const * b = &benchmarks[i];
+
+        command[0] = '\0';
+
+        for (j = 0, length = 0; j < b->argc && length < sizeof(command); j++) {
+            length += snprintf(command + length, sizeof(command) - length,
+                    j ? " %s" : "%s", b->argv[j]);
+        }
+
+        if (STATUS_NOT_FOUND == b->status) {
+            snprintf(status, sizeof(status), "not found");
+        }
+
+        else if (b->status) {
+            snprintf(status, sizeof(status), "failed (%d)", b->status);
+        }
+
+        else {
+            snprintf(status, sizeof(status), "ok");
+        }
+
+        printf("%-*s%*s%*.*f\n", 40, command, 12, status, FIELD_WIDTH,
+                FLOAT_PRECISION, b->time);
+    }
+
+    fflush(stdout);
+}
+
+int
+main (int argc, char * argv[])
+{
+    extern char * optarg;
+    extern int optind;
+
+    int c, i, j, provided, failed = 0, list = 0, bad_usage = 0;
+    int quiet, required = MPI_THREAD_SINGLE;
+
+    while ((c = getopt(argc, argv, "+F:o:lh")) != -1) {
+        switch (c) {
+            case 'F':
+                bad_usage |= read_benchmarks(optarg);
+                break;
+            case 'o':
+                output_spec = optarg;
+                break;
+            case 'l':
+                list = 1;
+                break;
+            default:
+                bad_usage = 1;
+                break;
+        }
+    }
+
+    if (add_benchmarks(argc - optind, argv + optind) && optind < argc) {
+        bad_usage = 1;
+    }
+
+    /*
+     * osu_latency_mt and osu_partitioned need MPI_THREAD_MULTIPLE to be
+     * requested up front
+     */
+    for (i = 0; i < num_benchmarks; i++) {
+        if (0 == strcmp(benchmarks[i].argv[0], "osu_latency_mt")
+                || 0 == strcmp(benchmarks[i].argv[0], "osu_partitioned")) {
+            required = MPI_THREAD_MULTIPLE;
+        }
+    }
+
+    PMPI_Init_thread(&argc, &argv, required, &provided);
+    atexit(finalize);
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    set_search_dirs(argv[0]);
+
+    if (list || bad_usage || 0 == num_benchmarks) {
+        if (0 == rank) {
+            if (list) {
+                list_benchmarks();
+            }
+
+            else {
+                usage("osu_suite");
+            }
+        }
+
+        return list && !bad_usage ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    /* keep stdout parseable when the records replace the text tables */
+    quiet = output_spec && NULL == strchr(output_spec, ':')
+        && strcmp(output_spec, "text");
+
+    if (0 == rank && !quiet) {
+        printf(HEADER);
+        fflush(stdout);
+    }
+
+    for (i = 0; i < num_benchmarks; i++) {
+        if (0 == rank && !quiet) {
+            printf("\n# [%d/%d]", i + 1, num_benchmarks);
+
+            for (j = 0; j < benchmarks[i].argc; j++) {
+                printf(" %s", benchmarks[i].argv[j]);
+            }
+
+            printf("\n");
+            fflush(stdout);
+        }
+
+        run_benchmark(&benchmarks[i]);
+        failed |= 0 != benchmarks[i].status;
+    }
+
+    if (0 == rank && !quiet) {
+        print_summary();
+    }
+
+    for (i = 0; i < num_benchmarks; i++) {
+        free_arguments(benchmarks[i].argv, benchmarks[i].argc);
+    }
+
+    free(benchmarks);
+
+    for (i = 0; i < num_search_dirs; i++) {
+        free(search_dirs[i]);
+    }
+
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -109,7 +109,9 @@ int main(int argc, char *argv[])
     memset(recvbuff, 1, max_msg_size*numprocs);
     memset(sendbuff, 0, max_msg_size);
 
-    for(size=1; size <= max_msg_size/sizeof(uint32_t); size *= 2) {
+    for(size=first_count(1, max_msg_size, sizeof(uint32_t));
+            size <= max_msg_size/sizeof(uint32_t);
+            size = next_count(size, max_msg_size, sizeof(uint32_t))) {
 
         if(size > LARGE_MESSAGE_SIZE) {
             skip = SKIP_LARGE;
@@ -102,7 +102,9 @@ int main(int argc, char *argv[])
     memset(sendbuf, 1, max_msg_size);
     memset(recvbuf, 0, max_msg_size);
 
-    for(size=1; size*sizeof(float)<= max_msg_size; size *= 2) {
+    for(size=first_count(1, max_msg_size, sizeof(float));
+            size*sizeof(float)<= max_msg_size;
+            size = next_count(size, max_msg_size, sizeof(float))) {
 
         if(size > LARGE_MESSAGE_SIZE) {
             skip = SKIP_LARGE;
@@ -17,6 +17,8 @@
 #include <string.h>
 #include <stdint.h>
 
+#include "osu_sizes.h"
+
 #ifndef DEFAULT_MAX_MESSAGE_SIZE
 #define DEFAULT_MAX_MESSAGE_SIZE (1 << 20)
 #endif
@@ -50,7 +52,7 @@ static void print_usage(int rank, const char * prog, int has_size)
 {
     if (rank == 0) {
         if (has_size) {
-            fprintf(stdout, " USAGE : %s [-m SIZE] [-i ITER] [-f] [-hv] [-M SIZE]\n", prog);
+            fprintf(stdout, " USAGE : %s [-m SIZE] [-S SIZES] [-i ITER] [-f] [-hv] [-M SIZE]\n", prog);
             fprintf(stdout, "  -m : Set maximum message size to SIZE.\n");
             fprintf(stdout, "       By default, the value of SIZE is 1MB.\n");
             fprintf(stdout, "  -i : Set number of iterations per message size to ITER.\n");
@@ -58,6 +60,7 @@ static void print_usage(int rank, const char * prog, int has_size)
             fprintf(stdout, "       and 100 for large messages.\n");
             fprintf(stdout, "  -M : Set maximum memory consumption (per process) to SIZE. \n"); 
             fprintf(stdout, "       By default, the value of SIZE is 512MB.\n");
+            fprintf(stdout, SIZES_HELP_STRING);
         }
 
         else {
@@ -91,7 +94,7 @@ static int process_args (int argc, char *argv[], int rank, int * size, int * ful
         print_size = 1;
     }
 
-    while ((c = getopt(argc, argv, ":hvfm:i:M:")) != -1) {
+    while ((c = getopt(argc, argv, ":hvfm:S:i:M:")) != -1) {
         switch (c) {
             case 'h':
                 print_usage(rank, argv[0], size != NULL);
@@ -119,6 +122,13 @@ static int process_args (int argc, char *argv[], int rank, int * size, int * ful
                 }
                 break;
 
+            case 'S':
+                if (size == NULL || set_sizes(optarg)) {
+                    print_usage(rank, argv[0], size != NULL);
+                    return -1;
+                }
+                break;
+
             case 'i':
                 iterations_large = atoi(optarg);
                 iterations = iterations_large;
@@ -151,6 +161,10 @@ static int process_args (int argc, char *argv[], int rank, int * size, int * ful
         }
     }
 
+    if (size && sizes_enabled()) {
+        *size = sizes_max(*size);
+    }
+
     return 0;
 }
 
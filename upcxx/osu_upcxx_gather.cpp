@@ -69,7 +69,8 @@ main (int argc, char *argv[])
 
     print_header(HEADER, myrank(), full);
 
-    for (size=1; size <=max_msg_size; size *= 2) {
+    for (size=first_size(1, max_msg_size); size <=max_msg_size;
+            size = next_size(size, max_msg_size)) {
         if (size > LARGE_MESSAGE_SIZE) {
             skip = SKIP_LARGE;
             iterations = iterations_large;
@@ -0,0 +1,202 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include "osu_adaptive.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+/* two-sided 95% quantiles of Student's t distribution, by degrees of freedom */
+static double const t95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+static double target_width = 0.0;
+static double budget = ADAPTIVE_DEFAULT_BUDGET;
+
+static struct {
+    enum adaptive_phase phase;
+    int count;
+    int warmup;
+    int batches;
+    double t_begin;
+    double batch_sum;
+    double last_batch;
+    double elapsed;
+    double mean;
+    double m2;
+} state;
+
+/*
+ * Parses "WIDTH[:SECONDS]".  Returns 0 on success.
+ */
+int
+set_adaptive (char const * spec)
+{
+    char * end;
+
+    target_width = strtod(spec, &end);
+
+    if (end == spec || target_width <= 0.0) {
+        return 1;
+    }
+
+    if (':' == *end) {
+        spec = end + 1;
+        budget = strtod(spec, &end);
+
+        if (end == spec || budget <= 0.0) {
+            return 1;
+        }
+    }
+
+    return '\0' != *end;
+}
+
+int
+adaptive_enabled (void)
+{
+    return target_width > 0.0;
+}
+
+/*
+ * Called before the first iteration of every message size.
+ */
+void
+adaptive_reset (void)
+{
+    state.phase = adaptive_warmup;
+    state.count = 0;
+    state.warmup = 0;
+    state.batches = 0;
+    state.t_begin = MPI_Wtime();
+    state.batch_sum = 0.0;
+    state.last_batch = 0.0;
+    state.elapsed = 0.0;
+    state.mean = 0.0;
+    state.m2 = 0.0;
+}
+
+double
+adaptive_half_width (void)
+{
+    int df = state.batches - 1;
+
+    if (df < 1) {
+        return HUGE_VAL;
+    }
+
+    return (df <= (int)(sizeof(t95) / sizeof(t95[0])) ? t95[df - 1] : 1.96)
+        * sqrt(state.m2 / df / state.batches);
+}
+
+/*
+ * Records the duration of one iteration and returns the phase the next
+ * iteration belongs to.  Collective over comm at the end of every batch.
+ */
+enum adaptive_phase
+adaptive_record (double time, MPI_Comm comm)
+{
+    double batch[2], delta;
+    int more, nprocs;
+
+    state.count++;
+    state.batch_sum += time;
+
+    if (adaptive_timing == state.phase) {
+        state.elapsed += time;
+    }
+
+    if (state.count % ADAPTIVE_BATCH) {
+        return state.phase;
+    }
+
+    /*
+     * Decide on the batch mean averaged over all ranks, so that every rank
+     * takes the same decision even when the ranks see different timings.
+     */
+    batch[0] = state.batch_sum / ADAPTIVE_BATCH;
+    batch[1] = MPI_Wtime() - state.t_begin > budget;
+    state.batch_sum = 0.0;
+
+    MPI_Comm_size(comm, &nprocs);
+    MPI_Allreduce(MPI_IN_PLACE, batch, 2, MPI_DOUBLE, MPI_SUM, comm);
+    batch[0] /= nprocs;
+
+    if (adaptive_warmup == state.phase) {
+        more = state.count < 2 * ADAPTIVE_BATCH
+            || batch[0] < state.last_batch * (1.0 - ADAPTIVE_WARMUP_TOLERANCE);
+        state.last_batch = batch[0];
+
+        if (!more || batch[1] > 0.0
+                || state.count >= ADAPTIVE_MAX_WARMUP_BATCHES * ADAPTIVE_BATCH) {
+            state.phase = adaptive_timing;
+            state.warmup = state.count;
+        }
+
+        return state.phase;
+    }
+
+    state.batches++;
+    delta = batch[0] - state.mean;
+    state.mean += delta / state.batches;
+    state.m2 += delta * (batch[0] - state.mean);
+
+    more = state.batches < ADAPTIVE_MIN_BATCHES
+        || adaptive_half_width() > target_width * state.mean;
+
+    if (!more || batch[1] > 0.0
+            || state.count - state.warmup >= ADAPTIVE_MAX_ITERATIONS) {
+        state.phase = adaptive_done;
+    }
+
+    return state.phase;
+}
+
+int
+adaptive_warmup_iterations (void)
+{
+    return adaptive_warmup == state.phase ? state.count : state.warmup;
+}
+
+int
+adaptive_timed_iterations (void)
+{
+    return adaptive_warmup == state.phase ? 0 : state.count - state.warmup;
+}
+
+/*
+ * Sum of the durations of all timed iterations.
+ */
+double
+adaptive_elapsed (void)
+{
+    return state.elapsed;
+}
+
+/*
+ * Bounds for timing loops that run while i < skip + iterations.  They allow
+ * one more iteration than has been recorded until the engine is satisfied,
+ * so the loop stops right after the iteration that satisfies it.
+ */
+int
+adaptive_loop_skip (void)
+{
+    return adaptive_warmup == state.phase ? state.count + 1 : state.warmup;
+}
+
+int
+adaptive_loop_iterations (void)
+{
+    return adaptive_timed_iterations() + (adaptive_timing == state.phase);
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
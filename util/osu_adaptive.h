@@ -0,0 +1,68 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#ifndef OSU_ADAPTIVE_H
+#define OSU_ADAPTIVE_H 1
+
+#include <mpi.h>
+
+/*
+ * Adaptive sampling engine.
+ *
+ * Instead of running a fixed number of warmup and timed iterations, the
+ * benchmark reports the duration of every iteration and the engine decides
+ * when the warmup is over and when enough samples have been taken.
+ *
+ * Iterations are grouped in batches of ADAPTIVE_BATCH.  The warmup ends once
+ * the mean of a batch no longer drops by more than ADAPTIVE_WARMUP_TOLERANCE
+ * compared to the previous one.  Timing then continues until the 95%
+ * confidence interval of the batch means is within the requested relative
+ * half-width of their mean, or until the time budget for the message size is
+ * used up.  Using batch means rather than single iterations keeps the
+ * interval honest when consecutive iterations are correlated.
+ *
+ * The decision is taken collectively at the end of every batch on the batch
+ * means averaged over all ranks, so every rank of the communicator has to
+ * report the same number of iterations.
+ */
+#define ADAPTIVE_BATCH              16
+#define ADAPTIVE_MIN_BATCHES        5
+#define ADAPTIVE_MAX_WARMUP_BATCHES 64
+#define ADAPTIVE_MAX_ITERATIONS     (1 << 20)
+#define ADAPTIVE_WARMUP_TOLERANCE   0.02
+#define ADAPTIVE_DEFAULT_BUDGET     5.0
+
+#define ADAPTIVE_HELP_STRING \
+    "  -C WIDTH[:SECONDS]\n" \
+    "                choose the number of warmup and timed iterations for each\n" \
+    "                message size automatically, sampling until the 95%%\n" \
+    "                confidence interval is within +/- WIDTH (e.g. 0.01 for\n" \
+    "                1%%) of the mean or SECONDS have passed (default 5)\n"
+
+enum adaptive_phase {
+    adaptive_warmup,
+    adaptive_timing,
+    adaptive_done
+};
+
+int set_adaptive (char const * spec);
+int adaptive_enabled (void);
+
+void adaptive_reset (void);
+enum adaptive_phase adaptive_record (double time, MPI_Comm comm);
+
+int adaptive_warmup_iterations (void);
+int adaptive_timed_iterations (void);
+double adaptive_elapsed (void);
+double adaptive_half_width (void);
+
+int adaptive_loop_skip (void);
+int adaptive_loop_iterations (void);
+
+#endif /* OSU_ADAPTIVE_H */
@@ -0,0 +1,680 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include "osu_algorithms.h"
+#include "osu_output.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef FIELD_WIDTH
+#   define FIELD_WIDTH 20
+#endif
+
+#ifndef FLOAT_PRECISION
+#   define FLOAT_PRECISION 2
+#endif
+
+#define MAX_CVAR_NAME_LEN       256
+#define MAX_CVAR_DESC_LEN       4096
+#define MAX_ALGORITHM_NAME_LEN  64
+#define MAX_ALGORITHMS          32
+#define MAX_SIZES               64
+
+struct algorithm {
+    char name[MAX_ALGORITHM_NAME_LEN];
+    int value;
+};
+
+/* collective ids of the Open MPI coll_tuned dynamic rules file */
+static char const * const open_mpi_collectives[] = {
+    "allgather", "allgatherv", "allreduce", "alltoall", "alltoallv",
+    "alltoallw", "barrier", "bcast", "exscan", "gather", "gatherv", "reduce",
+    "reduce_scatter", "reduce_scatter_block", "scan", "scatter", "scatterv",
+};
+
+static char * selection = NULL;
+static char * filename = NULL;
+
+static char collective_name[MAX_ALGORITHM_NAME_LEN];
+static char cvar_name[MAX_CVAR_NAME_LEN];
+static char cvar_desc[MAX_CVAR_DESC_LEN];
+static int cvar_is_string = 0;
+static MPI_T_cvar_handle handle;
+static int original_value = 0;
+static char * original_string = NULL;
+static int initialized = 0;
+
+static struct algorithm algorithms[MAX_ALGORITHMS];
+static int num_algorithms = 0;
+static int current = -1;
+static int started = 0;
+
+static MPI_Comm base_comm;
+static MPI_Comm sweep_comm = MPI_COMM_NULL;
+
+/* average latency of every algorithm, negative if it was not measured */
+static int sizes[MAX_SIZES];
+static double latencies[MAX_ALGORITHMS][MAX_SIZES];
+static int num_sizes = 0;
+
+/*
+ * Parses ALGS[:FILE], where ALGS is a comma separated list of algorithm names
+ * or "all".  Returns 0 on success.
+ */
+int
+set_algorithms (char const * spec)
+{
+    size_t length = strcspn(spec, ":");
+
+    if (0 == length || ',' == spec[0]) {
+        return 1;
+    }
+
+    free(selection);
+    free(filename);
+    filename = NULL;
+
+    if (NULL == (selection = malloc(length + 1))) {
+        return 1;
+    }
+
+    memcpy(selection, spec, length);
+    selection[length] = '\0';
+
+    if (':' == spec[length]) {
+        if ('\0' == spec[length + 1]) {
+            return 1;
+        }
+
+        filename = strdup(spec + length + 1);
+
+        return NULL == filename;
+    }
+
+    return 0;
+}
+
+int
+algorithms_enabled (void)
+{
+    return NULL != selection;
+}
+
+static int
+selected (char const * name)
+{
+    char const * p = selection;
+    size_t length;
+
+    while (*p) {
+        length = strcspn(p, ",");
+
+        if ((3 == length && 0 == strncmp(p, "all", length))
+                || (strlen(name) == length && 0 == strncmp(p, name, length))) {
+            return 1;
+        }
+
+        p += length + (',' == p[length]);
+    }
+
+    return 0;
+}
+
+static void
+add_algorithm (char const * name, int length, int value)
+{
+    struct algorithm * algorithm = &algorithms[num_algorithms];
+
+    if (MAX_ALGORITHMS == num_algorithms || length < 1
+            || length >= MAX_ALGORITHM_NAME_LEN) {
+        return;
+    }
+
+    memcpy(algorithm->name, name, length);
+    algorithm->name[length] = '\0';
+    algorithm->value = value;
+
+    if (selected(algorithm->name)) {
+        num_algorithms++;
+    }
+}
+
+/*
+ * Matches the names of the variables selecting the algorithm of the
+ * collective on intracommunicators, e.g. MPIR_CVAR_BCAST_INTRA_ALGORITHM or
+ * coll_tuned_bcast_algorithm, but not the ones of iallreduce or
+ * reduce_scatter when looking for allreduce or reduce.
+ */
+static int
+algorithm_variable (char const * name)
+{
+    char lower[MAX_CVAR_NAME_LEN];
+    char const * p;
+    size_t length = strlen(collective_name), i;
+
+    for (i = 0; name[i] && i < sizeof(lower) - 1; i++) {
+        lower[i] = tolower((unsigned char)name[i]);
+    }
+
+    lower[i] = '\0';
+
+    for (p = strstr(lower, collective_name); p;
+            p = strstr(p + 1, collective_name)) {
+        if (p != lower && '_' != p[-1]) {
+            continue;
+        }
+
+        if (0 == strcmp(p + length, "_algorithm")
+                || 0 == strcmp(p + length, "_intra_algorithm")) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * String variables list their values in the description, one per line in
+ * the form "name - explanation".
+ */
+static void
+parse_description (char const * desc)
+{
+    char const * line, * p;
+    int length;
+
+    for (line = desc; *line; line += strcspn(line, "\n")
+            + ('\n' == line[strcspn(line, "\n")])) {
+        for (p = line; ' ' == *p || '\t' == *p; p++);
+
+        for (length = 0; isalnum((unsigned char)p[length])
+                || '_' == p[length]; length++);
+
+        if (length && '-' == p[length + strspn(p + length, " \t")]) {
+            add_algorithm(p, length, 0);
+        }
+    }
+}
+
+static void
+add_enum_items (MPI_T_enum enumtype)
+{
+    char name[MAX_ALGORITHM_NAME_LEN];
+    int num_items, name_len = sizeof(name), value, i;
+
+    if (MPI_SUCCESS != MPI_T_enum_get_info(enumtype, &num_items, name,
+                &name_len)) {
+        return;
+    }
+
+    for (i = 0; i < num_items; i++) {
+        name_len = sizeof(name);
+
+        if (MPI_SUCCESS == MPI_T_enum_get_item(enumtype, i, &value, name,
+                    &name_len)) {
+            add_algorithm(name, strlen(name), value);
+        }
+    }
+}
+
+/*
+ * Returns the index of the variable selecting the algorithm of the
+ * collective, or -1.
+ */
+static int
+find_variable (void)
+{
+    int num, i, name_len, desc_len, verbosity, bind, scope;
+    MPI_Datatype datatype;
+    MPI_T_enum enumtype;
+
+    if (MPI_SUCCESS != MPI_T_cvar_get_num(&num)) {
+        return -1;
+    }
+
+    for (i = 0; i < num; i++) {
+        name_len = sizeof(cvar_name);
+        desc_len = sizeof(cvar_desc);
+
+        if (MPI_SUCCESS != MPI_T_cvar_get_info(i, cvar_name, &name_len,
+                    &verbosity, &datatype, &enumtype, cvar_desc, &desc_len,
+                    &bind, &scope) || MPI_T_BIND_NO_OBJECT != bind
+                || !algorithm_variable(cvar_name)) {
+            continue;
+        }
+
+        if (MPI_INT == datatype && MPI_T_ENUM_NULL != enumtype) {
+            add_enum_items(enumtype);
+        }
+
+        else if (MPI_CHAR == datatype) {
+            cvar_is_string = 1;
+            parse_description(cvar_desc);
+        }
+
+        else {
+            continue;
+        }
+
+        return i;
+    }
+
+    return -1;
+}
+
+/*
+ * Open MPI only honors coll_tuned_*_algorithm with dynamic rules enabled.
+ */
+static void
+check_dynamic_rules (void)
+{
+    char name[MAX_CVAR_NAME_LEN];
+    int num, i, name_len, desc_len, verbosity, bind, scope, count;
+    long long value = 0;
+    MPI_Datatype datatype;
+    MPI_T_enum enumtype;
+    MPI_T_cvar_handle rules;
+
+    if (strncmp(cvar_name, "coll_tuned_", 11)
+            || MPI_SUCCESS != MPI_T_cvar_get_num(&num)) {
+        return;
+    }
+
+    for (i = 0; i < num; i++) {
+        name_len = sizeof(name);
+        desc_len = 0;
+
+        if (MPI_SUCCESS != MPI_T_cvar_get_info(i, name, &name_len,
+                    &verbosity, &datatype, &enumtype, NULL, &desc_len, &bind,
+                    &scope) || strcmp(name, "coll_tuned_use_dynamic_rules")) {
+            continue;
+        }
+
+        if (MPI_SUCCESS == MPI_T_cvar_handle_alloc(i, NULL, &rules, &count)) {
+            MPI_T_cvar_read(rules, &value);
+            MPI_T_cvar_handle_free(&rules);
+        }
+
+        if (!value) {
+            fprintf(stderr, "Open MPI ignores %s unless dynamic rules are "
+                    "enabled, e.g. with --mca coll_tuned_use_dynamic_rules "
+                    "1\n", cvar_name);
+        }
+
+        return;
+    }
+}
+
+static void
+warn_unknown_algorithms (void)
+{
+    char const * p = selection;
+    size_t length;
+    int i;
+
+    while (*p) {
+        length = strcspn(p, ",");
+
+        for (i = 0; i < num_algorithms; i++) {
+            if (strlen(algorithms[i].name) == length
+                    && 0 == strncmp(p, algorithms[i].name, length)) {
+                break;
+            }
+        }
+
+        if (i == num_algorithms && !(3 == length && 0 == strncmp(p, "all",
+                        length))) {
+            fprintf(stderr, "Algorithm `%.*s' is not offered by %s\n",
+                    (int)length, p, cvar_name);
+        }
+
+        p += length + (',' == p[length]);
+    }
+}
+
+/*
+ * Finds the variable selecting the algorithm of the collective and the
+ * algorithms to run.  Collective over comm.
+ */
+void
+algorithms_init (char const * collective, MPI_Comm comm)
+{
+    int provided, rank, index = -1, count, range[2], i;
+
+    base_comm = comm;
+
+    if (!algorithms_enabled() || initialized) {
+        return;
+    }
+
+    initialized = 1;
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Query_thread(&provided);
+
+    for (i = 0; collective[i] && i < MAX_ALGORITHM_NAME_LEN - 1; i++) {
+        collective_name[i] = tolower((unsigned char)collective[i]);
+    }
+
+    collective_name[i] = '\0';
+
+    if (MPI_SUCCESS == MPI_T_init_thread(provided, &provided)
+            && (index = find_variable()) < 0) {
+        MPI_T_finalize();
+    }
+
+    if (index >= 0 && num_algorithms && MPI_SUCCESS
+            == MPI_T_cvar_handle_alloc(index, NULL, &handle, &count)) {
+        if (cvar_is_string) {
+            original_string = calloc(count + 1, 1);
+        }
+
+        if (cvar_is_string ? NULL == original_string || MPI_SUCCESS
+                != MPI_T_cvar_read(handle, original_string) : MPI_SUCCESS
+                != MPI_T_cvar_read(handle, &original_value)) {
+            MPI_T_cvar_handle_free(&handle);
+            num_algorithms = 0;
+        }
+    }
+
+    else {
+        num_algorithms = 0;
+    }
+
+    /* all ranks have to run the same algorithms */
+    range[0] = -num_algorithms;
+    range[1] = num_algorithms;
+    MPI_Allreduce(MPI_IN_PLACE, range, 2, MPI_INT, MPI_MAX, comm);
+
+    if (0 == rank) {
+        if (index < 0) {
+            fprintf(stderr, "No MPI_T control variable selects the %s "
+                    "algorithm, running the default algorithm only\n",
+                    collective_name);
+        }
+
+        else if (-range[0] != range[1]) {
+            fprintf(stderr, "The algorithms offered by %s differ between "
+                    "ranks, running the default algorithm only\n", cvar_name);
+        }
+
+        else {
+            warn_unknown_algorithms();
+
+            if (range[1]) {
+                check_dynamic_rules();
+            }
+        }
+    }
+
+    if (-range[0] != range[1] || 0 == range[1]) {
+        if (num_algorithms) {
+            MPI_T_cvar_handle_free(&handle);
+            num_algorithms = 0;
+        }
+
+        if (index >= 0) {
+            MPI_T_finalize();
+        }
+    }
+}
+
+static int
+write_value (char const * string, int const * value)
+{
+    return MPI_SUCCESS != MPI_T_cvar_write(handle, cvar_is_string ?
+            (void const *)string : (void const *)value);
+}
+
+static int
+column_width (char const * name)
+{
+    int width = strlen(name) + 2;
+
+    return width > FIELD_WIDTH ? width : FIELD_WIDTH;
+}
+
+static int
+fastest (int s)
+{
+    int best = -1, i;
+
+    for (i = 0; i < num_algorithms; i++) {
+        if (latencies[i][s] >= 0.0 && (best < 0 || latencies[i][s]
+                    < latencies[best][s])) {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+static void
+print_summary (void)
+{
+    int width = FIELD_WIDTH, best, i, s;
+
+    if (!output_text() || !num_sizes) {
+        return;
+    }
+
+    fprintf(stdout, "\n# Average latency(us) of every %s algorithm\n",
+            collective_name);
+    fprintf(stdout, "%-*s", 10, "# Size");
+
+    for (i = 0; i < num_algorithms; i++) {
+        fprintf(stdout, "%*s", column_width(algorithms[i].name),
+                algorithms[i].name);
+
+        if (column_width(algorithms[i].name) > width) {
+            width = column_width(algorithms[i].name);
+        }
+    }
+
+    fprintf(stdout, "%*s\n", width, "Fastest");
+
+    for (s = 0; s < num_sizes; s++) {
+        fprintf(stdout, "%-*d", 10, sizes[s]);
+
+        for (i = 0; i < num_algorithms; i++) {
+            if (latencies[i][s] < 0.0) {
+                fprintf(stdout, "%*s", column_width(algorithms[i].name), "-");
+            }
+
+            else {
+                fprintf(stdout, "%*.*f", column_width(algorithms[i].name),
+                        FLOAT_PRECISION, latencies[i][s]);
+            }
+        }
+
+        best = fastest(s);
+        fprintf(stdout, "%*s\n", width, best < 0 ? "-" : algorithms[best].name);
+    }
+
+    fflush(stdout);
+}
+
+/*
+ * Writes the message sizes at which the fastest algorithm changes, each
+ * algorithm applies from its size up to the next one.
+ */
+static void
+write_tuning_file (void)
+{
+    char library[MPI_MAX_LIBRARY_VERSION_STRING];
+    int starts[MAX_SIZES], choices[MAX_SIZES];
+    int num_ranges = 0, nprocs, length, id, best, s;
+    FILE * file;
+
+    if (NULL == filename) {
+        return;
+    }
+
+    for (s = 0; s < num_sizes; s++) {
+        if ((best = fastest(s)) >= 0 && (0 == num_ranges
+                    || best != choices[num_ranges - 1])) {
+            starts[num_ranges] = num_ranges ? sizes[s] : 0;
+            choices[num_ranges++] = best;
+        }
+    }
+
+    if (NULL == (file = fopen(filename, "w"))) {
+        fprintf(stderr, "Could not open tuning file `%s': %s\n", filename,
+                strerror(errno));
+        return;
+    }
+
+    MPI_Comm_size(base_comm, &nprocs);
+
+    for (id = 0; 0 == strncmp(cvar_name, "coll_tuned_", 11) && id < (int)
+            (sizeof(open_mpi_collectives) / sizeof(open_mpi_collectives[0]));
+            id++) {
+        if (0 == strcmp(open_mpi_collectives[id], collective_name)) {
+            break;
+        }
+    }
+
+    if (id < (int)(sizeof(open_mpi_collectives)
+                / sizeof(open_mpi_collectives[0]))) {
+        fprintf(file, "1 # number of collectives\n");
+        fprintf(file, "%d # collective id (%s)\n", id, collective_name);
+        fprintf(file, "1 # number of communicator sizes\n");
+        fprintf(file, "%d # communicator size\n", nprocs);
+        fprintf(file, "%d # number of message sizes\n", num_ranges);
+
+        for (s = 0; s < num_ranges; s++) {
+            fprintf(file, "%d %d 0 0 # message size, algorithm (%s), "
+                    "fan in/out, segment size\n", starts[s],
+                    algorithms[choices[s]].value, algorithms[choices[s]].name);
+        }
+    }
+
+    else {
+        MPI_Get_library_version(library, &length);
+        library[strcspn(library, "\n")] = '\0';
+
+        fprintf(file, "# Fastest %s algorithms for %d ranks selected with "
+                "%s\n", collective_name, nprocs, cvar_name);
+        fprintf(file, "# %s\n", library);
+        fprintf(file, "# Each algorithm applies from its message size up to "
+                "the next one\n");
+
+        for (s = 0; s < num_ranges; s++) {
+            fprintf(file, "%-12d%s\n", starts[s], algorithms[choices[s]].name);
+        }
+    }
+
+    fclose(file);
+}
+
+/*
+ * Selects the next algorithm and returns the communicator to run it on, or
+ * 0 after the last one.  Collective over the communicator given to
+ * algorithms_init().
+ */
+int
+algorithms_next (MPI_Comm * comm)
+{
+    int rank, error;
+
+    *comm = base_comm;
+
+    if (MPI_COMM_NULL != sweep_comm) {
+        MPI_Comm_free(&sweep_comm);
+    }
+
+    if (!num_algorithms) {
+        return 0 == started++;
+    }
+
+    MPI_Comm_rank(base_comm, &rank);
+
+    while (++current < num_algorithms) {
+        struct algorithm const * algorithm = &algorithms[current];
+
+        error = write_value(algorithm->name, &algorithm->value);
+        MPI_Allreduce(MPI_IN_PLACE, &error, 1, MPI_INT, MPI_MAX, base_comm);
+
+        if (!error) {
+            MPI_Comm_dup(base_comm, &sweep_comm);
+            *comm = sweep_comm;
+
+            if (0 == rank && output_text()) {
+                fprintf(stdout, "\n# %s = %s\n", cvar_name, algorithm->name);
+                fflush(stdout);
+            }
+
+            return 1;
+        }
+
+        if (0 == rank) {
+            fprintf(stderr, "Could not set %s to `%s', skipping it\n",
+                    cvar_name, algorithm->name);
+        }
+    }
+
+    write_value(original_string, &original_value);
+    MPI_T_cvar_handle_free(&handle);
+
+    if (0 == rank) {
+        print_summary();
+        write_tuning_file();
+    }
+
+    num_algorithms = 0;
+    started = 1;
+    MPI_T_finalize();
+
+    return 0;
+}
+
+/*
+ * The algorithm running now, or NULL without a sweep.
+ */
+char const *
+algorithms_current (void)
+{
+    return current >= 0 && current < num_algorithms ?
+        algorithms[current].name : NULL;
+}
+
+/*
+ * Remembers the average latency of the running algorithm for a message size.
+ */
+void
+algorithms_record (int size, double latency)
+{
+    int s, i;
+
+    if (NULL == algorithms_current()) {
+        return;
+    }
+
+    for (s = 0; s < num_sizes && sizes[s] != size; s++);
+
+    if (s == num_sizes) {
+        if (MAX_SIZES == num_sizes) {
+            return;
+        }
+
+        sizes[num_sizes++] = size;
+
+        for (i = 0; i < MAX_ALGORITHMS; i++) {
+            latencies[i][s] = -1.0;
+        }
+    }
+
+    latencies[current][s] = latency;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
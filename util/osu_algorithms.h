@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#ifndef OSU_ALGORITHMS_H
+#define OSU_ALGORITHMS_H 1
+
+#include <mpi.h>
+
+/*
+ * Collective algorithm sweep through MPI_T control variables.
+ *
+ * algorithms_init() looks for the control variable that selects the
+ * algorithm of a collective, e.g. MPIR_CVAR_ALLREDUCE_INTRA_ALGORITHM in
+ * MPICH or coll_tuned_allreduce_algorithm in Open MPI, and the algorithms it
+ * accepts: the items of its enumeration, or for string variables the values
+ * listed in its description.
+ *
+ * The benchmark runs all message sizes once per call of algorithms_next(),
+ * which writes the next algorithm to the variable and returns a duplicate of
+ * the communicator, since some libraries only select the algorithm when a
+ * communicator is created.  Once every algorithm has run it restores the
+ * variable, prints the fastest algorithm per message size and writes the
+ * tuning file.  Without a sweep algorithms_next() returns the communicator
+ * once.
+ *
+ * The tuning file is an Open MPI dynamic rules file for the coll_tuned
+ * variables and a list of message size ranges and algorithms otherwise.
+ */
+#define ALGORITHMS_HELP_STRING \
+    "  -A ALGS[:FILE]\n" \
+    "                run every message size once with each of the comma separated\n" \
+    "                ALGS, or `all' algorithms the MPI library offers through\n" \
+    "                MPI_T control variables, print the fastest algorithm per\n" \
+    "                message size and write it as a tuning file to FILE\n"
+
+int set_algorithms (char const * spec);
+int algorithms_enabled (void);
+void algorithms_init (char const * collective, MPI_Comm comm);
+
+int algorithms_next (MPI_Comm * comm);
+char const * algorithms_current (void);
+void algorithms_record (int size, double latency);
+
+#endif /* OSU_ALGORITHMS_H */
@@ -0,0 +1,456 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include "osu_alloc.h"
+#include "osu_sizes.h"
+
+#include <mpi.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+#ifndef MAP_ANONYMOUS
+#   define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#if defined(MAP_HUGETLB) && !defined(MAP_HUGE_SHIFT)
+#   define MAP_HUGE_SHIFT 26
+#endif
+
+/* values from <linux/mempolicy.h>, which libc does not export */
+#define OSU_MPOL_BIND       2
+#define OSU_MPOL_MF_STRICT  (1 << 0)
+#define OSU_MPOL_MF_MOVE    (1 << 1)
+
+#define MAX_NUMA_NODES      1024
+#define BITS_PER_LONG       (8 * sizeof(unsigned long))
+
+enum alloc_backend {
+    BACKEND_DEFAULT,
+    BACKEND_4K,
+    BACKEND_2M,
+    BACKEND_1G,
+    BACKEND_MPI
+};
+
+struct alloc_policy {
+    enum alloc_backend backend;
+    int node;
+};
+
+struct alloc_record {
+    void * ptr;
+    size_t length;
+    enum alloc_backend backend;
+    struct alloc_record * next;
+};
+
+static char * spec_string = NULL;
+static struct alloc_policy * policies = NULL;
+static int num_policies = 0;
+static struct alloc_record * records = NULL;
+static size_t pool_size = 0;
+static size_t pool_stride = 0;
+
+static int
+parse_policy (char * token, struct alloc_policy * policy)
+{
+    char * node = strchr(token, ':');
+    char * end;
+
+    if (node) {
+        *node++ = '\0';
+    }
+
+    if (0 == strcmp(token, "default")) {
+        policy->backend = BACKEND_DEFAULT;
+    }
+
+    else if (0 == strcmp(token, "4k")) {
+        policy->backend = BACKEND_4K;
+    }
+
+    else if (0 == strcmp(token, "2m")) {
+        policy->backend = BACKEND_2M;
+    }
+
+    else if (0 == strcmp(token, "1g")) {
+        policy->backend = BACKEND_1G;
+    }
+
+    else if (0 == strcmp(token, "mpi")) {
+        policy->backend = BACKEND_MPI;
+    }
+
+    else {
+        fprintf(stderr, "Unknown allocator backend `%s'\n", token);
+        return 1;
+    }
+
+    policy->node = -1;
+
+    if (node) {
+        if (BACKEND_DEFAULT == policy->backend
+                || BACKEND_MPI == policy->backend) {
+            fprintf(stderr, "Allocator backend `%s' cannot be bound to a "
+                    "NUMA node\n", token);
+            return 1;
+        }
+
+        policy->node = strtol(node, &end, 10);
+
+        if (end == node || *end || policy->node < 0
+                || policy->node >= MAX_NUMA_NODES) {
+            fprintf(stderr, "Invalid NUMA node `%s'\n", node);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Parses the allocator specification given on the command line.  This is
+ * called while processing options, possibly before MPI_Init, so the rank
+ * specific entry is only picked when memory is allocated.
+ */
+int
+set_allocator (char const * spec)
+{
+    char * copy, * token, * saveptr = NULL;
+    int count = 1;
+    char const * p;
+
+    for (p = spec; *p; p++) {
+        count += ',' == *p;
+    }
+
+    free(spec_string);
+    free(policies);
+    num_policies = 0;
+
+    spec_string = strdup(spec);
+    copy = strdup(spec);
+    policies = malloc(count * sizeof(struct alloc_policy));
+
+    if (NULL == spec_string || NULL == copy || NULL == policies) {
+        free(copy);
+        return 1;
+    }
+
+    for (token = strtok_r(copy, ",", &saveptr); token;
+            token = strtok_r(NULL, ",", &saveptr)) {
+        if (parse_policy(token, &policies[num_policies++])) {
+            free(copy);
+            return 1;
+        }
+    }
+
+    free(copy);
+
+    return 0 == num_policies;
+}
+
+int
+allocator_selected (void)
+{
+    return num_policies > 0;
+}
+
+char const *
+allocator_spec (void)
+{
+    return spec_string ? spec_string : "default";
+}
+
+static struct alloc_policy const *
+get_policy (void)
+{
+    static struct alloc_policy const fallback = {BACKEND_DEFAULT, -1};
+    int rank;
+
+    if (!num_policies) {
+        return &fallback;
+    }
+
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    return &policies[rank < num_policies ? rank : num_policies - 1];
+}
+
+static int
+bind_to_node (void * ptr, size_t length, int node)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+    unsigned long mask[MAX_NUMA_NODES / BITS_PER_LONG];
+
+    memset(mask, 0, sizeof(mask));
+    mask[node / BITS_PER_LONG] = 1UL << (node % BITS_PER_LONG);
+
+    /* the kernel expects one more than the number of bits in the mask */
+    if (syscall(SYS_mbind, ptr, length, OSU_MPOL_BIND, mask,
+                MAX_NUMA_NODES + 1, OSU_MPOL_MF_STRICT | OSU_MPOL_MF_MOVE)) {
+        fprintf(stderr, "Error binding memory to NUMA node %d: %s\n", node,
+                strerror(errno));
+        return 1;
+    }
+
+    return 0;
+#else
+    fprintf(stderr, "NUMA binding is not supported on this platform\n");
+    return 1;
+#endif
+}
+
+static void *
+map_pages (size_t * length, enum alloc_backend backend, int node)
+{
+    size_t page = sysconf(_SC_PAGESIZE);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void * ptr;
+
+    switch (backend) {
+        case BACKEND_2M:
+        case BACKEND_1G:
+#ifdef MAP_HUGETLB
+            page = BACKEND_2M == backend ? 1UL << 21 : 1UL << 30;
+            flags |= MAP_HUGETLB | (BACKEND_2M == backend ? 21 : 30)
+                << MAP_HUGE_SHIFT;
+            break;
+#else
+            fprintf(stderr, "Hugepages are not supported on this platform\n");
+            return NULL;
+#endif
+        default:
+            break;
+    }
+
+    *length = (*length + page - 1) / page * page;
+    ptr = mmap(NULL, *length, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+    if (MAP_FAILED == ptr) {
+        fprintf(stderr, "Error mapping %lu bytes: %s\n",
+                (unsigned long)*length, strerror(errno));
+
+        if (BACKEND_4K != backend) {
+            fprintf(stderr, "Check that enough hugepages of this size are "
+                    "reserved (see /sys/kernel/mm/hugepages)\n");
+        }
+
+        return NULL;
+    }
+
+#ifdef MADV_NOHUGEPAGE
+    if (BACKEND_4K == backend) {
+        madvise(ptr, *length, MADV_NOHUGEPAGE);
+    }
+#endif
+
+    if (node >= 0 && bind_to_node(ptr, *length, node)) {
+        munmap(ptr, *length);
+        return NULL;
+    }
+
+    return ptr;
+}
+
+/*
+ * Allocates a page aligned host buffer from the backend selected for this
+ * rank.  Returns NULL, after printing the reason, if the allocation failed.
+ */
+void *
+osu_malloc (size_t size)
+{
+    struct alloc_policy const * policy = get_policy();
+    struct alloc_record * record;
+    size_t length = size ? size : 1;
+    void * ptr = NULL;
+
+    switch (policy->backend) {
+        case BACKEND_DEFAULT:
+            if (posix_memalign(&ptr, sysconf(_SC_PAGESIZE), length)) {
+                ptr = NULL;
+            }
+            break;
+        case BACKEND_MPI:
+            if (MPI_SUCCESS != MPI_Alloc_mem(length, MPI_INFO_NULL, &ptr)) {
+                fprintf(stderr, "Error in MPI_Alloc_mem\n");
+                ptr = NULL;
+            }
+            break;
+        default:
+            ptr = map_pages(&length, policy->backend, policy->node);
+            break;
+    }
+
+    if (NULL == ptr || BACKEND_DEFAULT == policy->backend) {
+        return ptr;
+    }
+
+    record = malloc(sizeof(struct alloc_record));
+
+    if (NULL == record) {
+        if (BACKEND_MPI == policy->backend) {
+            MPI_Free_mem(ptr);
+        }
+
+        else {
+            munmap(ptr, length);
+        }
+
+        return NULL;
+    }
+
+    record->ptr = ptr;
+    record->length = length;
+    record->backend = policy->backend;
+    record->next = records;
+    records = record;
+
+    return ptr;
+}
+
+void
+osu_free (void * ptr)
+{
+    struct alloc_record ** link = &records;
+    struct alloc_record * record;
+
+    if (NULL == ptr) {
+        return;
+    }
+
+    while (*link && (*link)->ptr != ptr) {
+        link = &(*link)->next;
+    }
+
+    /* buffers that were not recorded came from posix_memalign */
+    if (NULL == *link) {
+        free(ptr);
+        return;
+    }
+
+    record = *link;
+    *link = record->next;
+
+    if (BACKEND_MPI == record->backend) {
+        MPI_Free_mem(ptr);
+    }
+
+    else {
+        munmap(ptr, record->length);
+    }
+
+    free(record);
+}
+
+static size_t
+page_size (void)
+{
+    static size_t size = 0;
+
+    if (!size) {
+        size = sysconf(_SC_PAGESIZE);
+    }
+
+    return size;
+}
+
+/*
+ * Parses POOL[:STRIDE] for -c.  The pool has to hold at least two strides,
+ * or every iteration would use the same buffer.  Returns 0 on success.
+ */
+int
+set_buffer_pool (char const * spec)
+{
+    char * copy = strdup(spec), * stride;
+    size_t size = 0, step = 0;
+    int retval;
+
+    if (NULL == copy) {
+        return 1;
+    }
+
+    if ((stride = strchr(copy, ':'))) {
+        *stride++ = '\0';
+    }
+
+    retval = sizes_parse(copy, &size) || (stride && (sizes_parse(stride,
+                    &step) || 0 == step)) || size < 2 * (step ? step :
+                page_size());
+    free(copy);
+
+    if (0 == retval) {
+        pool_size = size;
+        pool_stride = step;
+    }
+
+    return retval;
+}
+
+size_t
+buffer_pool_size (void)
+{
+    return pool_size;
+}
+
+void
+print_buffer_pool (void)
+{
+    if (!pool_size) {
+        return;
+    }
+
+    printf("# Buffer pool: %lu bytes, stride: ", (unsigned long)pool_size);
+
+    if (pool_stride) {
+        printf("%lu bytes\n", (unsigned long)pool_stride);
+    }
+
+    else {
+        printf("message size rounded up to a page\n");
+        printf("# Messages above %lu bytes reuse a single buffer\n",
+                (unsigned long)(pool_size / 2 / page_size() * page_size()));
+    }
+}
+
+/*
+ * Returns the buffer to use for a given iteration.  Buffers used with -c are
+ * allocated with buffer_pool_size() extra bytes and consecutive iterations
+ * walk through them so that data is not reused while it is still cached.
+ */
+void *
+cycle_buffer (void * buffer, int iteration, size_t size)
+{
+    size_t stride = pool_stride;
+
+    if (!pool_size || NULL == buffer) {
+        return buffer;
+    }
+
+    if (!stride) {
+        stride = size ? (size + page_size() - 1) / page_size() * page_size()
+            : page_size();
+    }
+
+    if (2 * stride > pool_size) {
+        return buffer;
+    }
+
+    return (char *)buffer + ((size_t)iteration * stride) % pool_size;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#ifndef OSU_ALLOC_H
+#define OSU_ALLOC_H 1
+
+#include <stddef.h>
+
+/*
+ * Host buffer allocator shared by the MPI benchmarks.
+ *
+ * The allocator is selected with a comma separated list of backends, one
+ * per rank; ranks beyond the end of the list use the last entry.  The mmap
+ * based backends may be followed by ":NODE" to bind the memory to a NUMA
+ * node with mbind.
+ *
+ *   default    posix_memalign (the historical behavior)
+ *   4k         anonymous mmap with transparent hugepages disabled
+ *   2m         mmap(MAP_HUGETLB) with 2 MB pages
+ *   1g         mmap(MAP_HUGETLB) with 1 GB pages
+ *   mpi        MPI_Alloc_mem
+ */
+#define ALLOC_HELP_STRING \
+    "  -a SPEC[,SPEC...]\n" \
+    "                allocate host buffers with the given backend, one SPEC\n" \
+    "                per rank with the last one repeating: default, 4k, 2m,\n" \
+    "                1g or mpi; 4k, 2m and 1g may be followed by :NODE to\n" \
+    "                bind the memory to a NUMA node\n"
+
+/*
+ * Buffer pool for cache-cold buffers.
+ *
+ * With "-c POOL[:STRIDE]" the benchmarks allocate their buffers with
+ * buffer_pool_size() extra bytes, and cycle_buffer() advances by STRIDE
+ * bytes, or by the message size rounded up to a page, for every iteration
+ * and wraps around at the end of the pool.  Messages whose stride does not
+ * fit into the pool twice use the start of the buffer every time.
+ */
+#define POOL_HELP_STRING \
+    "  -c POOL[:STRIDE]\n" \
+    "                rotate through a buffer pool of POOL bytes, advancing\n" \
+    "                STRIDE bytes every iteration (default: message size\n" \
+    "                rounded up to a page), to measure with cache-cold\n" \
+    "                buffers; sizes take the suffixes k, m and g\n"
+
+int set_allocator (char const * spec);
+int allocator_selected (void);
+char const * allocator_spec (void);
+
+void * osu_malloc (size_t size);
+void osu_free (void * ptr);
+
+int set_buffer_pool (char const * spec);
+size_t buffer_pool_size (void);
+void print_buffer_pool (void);
+void * cycle_buffer (void * buffer, int iteration, size_t size);
+
+#endif /* OSU_ALLOC_H */
@@ -0,0 +1,361 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include "osu_counters.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#if defined(__linux__) && defined(SYS_perf_event_open)
+#   define PERF_EVENTS_AVAILABLE 1
+#else
+#   define PERF_EVENTS_AVAILABLE 0
+#endif
+
+#define NUM_EVENTS (sizeof(events) / sizeof(events[0]))
+
+#if PERF_EVENTS_AVAILABLE
+#   define CACHE_READ_MISS(cache) ((cache) \
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8) \
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+#endif
+
+struct event {
+    char const * name;
+    char const * label;
+    char const * field;
+#if PERF_EVENTS_AVAILABLE
+    uint32_t type;
+    uint64_t config;
+#endif
+};
+
+#if PERF_EVENTS_AVAILABLE
+#   define EVENT(name, label, field, type, config) \
+        {name, label, field, type, config}
+#else
+#   define EVENT(name, label, field, type, config) {name, label, field}
+#endif
+
+static struct event const events[] = {
+    EVENT("cycles", "Cycles", "cycles", PERF_TYPE_HARDWARE,
+            PERF_COUNT_HW_CPU_CYCLES),
+    EVENT("instructions", "Instructions", "instructions", PERF_TYPE_HARDWARE,
+            PERF_COUNT_HW_INSTRUCTIONS),
+    EVENT("llc-misses", "LLC misses", "llc_misses", PERF_TYPE_HW_CACHE,
+            CACHE_READ_MISS(PERF_COUNT_HW_CACHE_LL)),
+    EVENT("dtlb-misses", "dTLB misses", "dtlb_misses", PERF_TYPE_HW_CACHE,
+            CACHE_READ_MISS(PERF_COUNT_HW_CACHE_DTLB)),
+    EVENT("context-switches", "Ctx switches", "context_switches",
+            PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES),
+};
+
+static int selected[NUM_EVENTS];
+static int num_selected = 0;
+
+/* events that could be opened on every rank */
+static int active[NUM_EVENTS];
+static int fds[NUM_EVENTS];
+static double values[NUM_EVENTS];
+static int num_active = 0;
+
+/*
+ * Parses a comma separated list of event names, or "all".  Returns 0 on
+ * success.
+ */
+int
+set_counters (char const * spec)
+{
+    char const * p = spec;
+    size_t i, length;
+
+    memset(selected, 0, sizeof(selected));
+    num_selected = 0;
+
+    while (*p) {
+        length = strcspn(p, ",");
+
+        if (3 == length && 0 == strncmp(p, "all", length)) {
+            for (i = 0; i < NUM_EVENTS; i++) {
+                selected[i] = 1;
+            }
+        }
+
+        else {
+            for (i = 0; i < NUM_EVENTS; i++) {
+                if (strlen(events[i].name) == length
+                        && 0 == strncmp(p, events[i].name, length)) {
+                    selected[i] = 1;
+                    break;
+                }
+            }
+
+            if (NUM_EVENTS == i) {
+                return 1;
+            }
+        }
+
+        p += length + (',' == p[length]);
+    }
+
+    for (i = 0; i < NUM_EVENTS; i++) {
+        num_selected += selected[i];
+    }
+
+    return 0 == num_selected;
+}
+
+int
+counters_enabled (void)
+{
+    return num_selected > 0;
+}
+
+#if PERF_EVENTS_AVAILABLE
+static int
+open_event (struct event const * event)
+{
+    struct perf_event_attr attr;
+    int fd;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = event->type;
+    attr.config = event->config;
+    attr.disabled = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED
+        | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+
+    /* unprivileged users may only count user space events */
+    if (fd < 0 && (EACCES == errno || EPERM == errno)) {
+        attr.exclude_kernel = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+
+    return fd;
+}
+#endif
+
+/*
+ * Opens the selected events.  Events that cannot be counted on some rank are
+ * dropped with a warning.  Collective over comm.
+ */
+void
+counters_init (MPI_Comm comm)
+{
+    int error[NUM_EVENTS];
+    int rank;
+    size_t i;
+
+    if (!counters_enabled()) {
+        return;
+    }
+
+    MPI_Comm_rank(comm, &rank);
+    num_active = 0;
+
+    for (i = 0; i < NUM_EVENTS; i++) {
+        fds[i] = -1;
+        error[i] = 0;
+        active[i] = 0;
+
+        if (!selected[i]) {
+            continue;
+        }
+
+#if PERF_EVENTS_AVAILABLE
+        if ((fds[i] = open_event(&events[i])) < 0) {
+            error[i] = errno;
+        }
+#else
+        error[i] = ENOSYS;
+#endif
+        active[i] = fds[i] >= 0;
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, active, NUM_EVENTS, MPI_INT, MPI_MIN, comm);
+
+    for (i = 0; i < NUM_EVENTS; i++) {
+        if (active[i]) {
+            num_active++;
+            continue;
+        }
+
+        if (fds[i] >= 0) {
+            close(fds[i]);
+            fds[i] = -1;
+        }
+
+        if (!selected[i] || rank) {
+            continue;
+        }
+
+        if (ENOENT == error[i] || EOPNOTSUPP == error[i]) {
+            fprintf(stderr, "Counter `%s' is not supported by this "
+                    "processor\n", events[i].name);
+        }
+
+        else {
+            fprintf(stderr, "Counter `%s' is not available%s%s\n",
+                    events[i].name, error[i] ? ": " : " on every rank",
+                    error[i] ? strerror(error[i]) : "");
+        }
+    }
+}
+
+#if PERF_EVENTS_AVAILABLE
+static void
+control (unsigned long request)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_EVENTS; i++) {
+        if (active[i]) {
+            ioctl(fds[i], request, 0);
+        }
+    }
+}
+#endif
+
+/*
+ * Clears the counts.  Counting resumes with counters_start().
+ */
+void
+counters_reset (void)
+{
+#if PERF_EVENTS_AVAILABLE
+    if (num_active) {
+        control(PERF_EVENT_IOC_RESET);
+    }
+#endif
+}
+
+void
+counters_start (void)
+{
+#if PERF_EVENTS_AVAILABLE
+    if (num_active) {
+        control(PERF_EVENT_IOC_ENABLE);
+    }
+#endif
+}
+
+void
+counters_stop (void)
+{
+#if PERF_EVENTS_AVAILABLE
+    if (num_active) {
+        control(PERF_EVENT_IOC_DISABLE);
+    }
+#endif
+}
+
+/*
+ * Reads the counts since the last reset and averages them per iteration over
+ * all ranks of comm.  The result is only valid on rank 0.  Collective over
+ * comm.
+ */
+void
+counters_reduce (int iterations, MPI_Comm comm)
+{
+    uint64_t data[3];
+    int rank, nprocs;
+    size_t i;
+
+    if (!num_active) {
+        return;
+    }
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &nprocs);
+
+    for (i = 0; i < NUM_EVENTS; i++) {
+        values[i] = 0.0;
+
+        if (!active[i] || sizeof(data) != read(fds[i], data, sizeof(data))) {
+            continue;
+        }
+
+        values[i] = data[0];
+
+        /* scale for the time the counter was multiplexed out */
+        if (data[2] && data[2] < data[1]) {
+            values[i] *= (double)data[1] / data[2];
+        }
+
+        values[i] /= iterations > 0 ? iterations : 1;
+    }
+
+    MPI_Reduce(0 == rank ? MPI_IN_PLACE : values, values, NUM_EVENTS,
+            MPI_DOUBLE, MPI_SUM, 0, comm);
+
+    for (i = 0; i < NUM_EVENTS; i++) {
+        values[i] /= nprocs;
+    }
+}
+
+int
+counters_count (void)
+{
+    return num_active;
+}
+
+static int
+event_index (int n)
+{
+    size_t i;
+
+    for (i = 0; i < NUM_EVENTS; i++) {
+        if (active[i] && 0 == n--) {
+            return i;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * The label used in the text table for the n-th reported event.
+ */
+char const *
+counters_label (int n)
+{
+    return events[event_index(n)].label;
+}
+
+/*
+ * The field name used in machine readable records for the n-th reported
+ * event.
+ */
+char const *
+counters_field (int n)
+{
+    return events[event_index(n)].field;
+}
+
+double
+counters_value (int n)
+{
+    return values[event_index(n)];
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
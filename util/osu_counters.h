@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#ifndef OSU_COUNTERS_H
+#define OSU_COUNTERS_H 1
+
+#include <mpi.h>
+
+/*
+ * Hardware and software performance counters read with perf_event_open.
+ *
+ * Each selected event is opened separately for the calling thread, so that
+ * events the processor or the kernel does not provide can be dropped without
+ * losing the others.  An event is only reported if it could be opened on
+ * every rank.  When the counters are multiplexed the counts are scaled by the
+ * fraction of time they were actually running.
+ *
+ * The benchmarks start and stop the counters around their timed code and
+ * report the counts per iteration, averaged over all ranks.
+ */
+#define COUNTERS_HELP_STRING \
+    "  -P EVENTS     count EVENTS during the timed iterations with\n" \
+    "                perf_event_open and report them per iteration: a comma\n" \
+    "                separated list of cycles, instructions, llc-misses,\n" \
+    "                dtlb-misses and context-switches, or `all'\n"
+
+int set_counters (char const * spec);
+int counters_enabled (void);
+void counters_init (MPI_Comm comm);
+
+void counters_reset (void);
+void counters_start (void);
+void counters_stop (void);
+void counters_reduce (int iterations, MPI_Comm comm);
+
+int counters_count (void);
+char const * counters_label (int i);
+char const * counters_field (int i);
+double counters_value (int i);
+
+#endif /* OSU_COUNTERS_H */
@@ -0,0 +1,480 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include "osu_output.h"
+
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_FIELDS      128
+#define MAX_NAME_LEN    64
+#define MAX_VALUE_LEN   72
+#define MAX_HEADER_LEN  (MAX_FIELDS * (MAX_NAME_LEN + 1) + 128)
+
+enum output_format {
+    output_format_text,
+    output_format_json,
+    output_format_csv
+};
+
+struct field {
+    char name[MAX_NAME_LEN];
+    char value[MAX_VALUE_LEN];
+};
+
+static enum output_format format = output_format_text;
+static char * filename = NULL;
+static FILE * stream = NULL;
+static char csv_header[MAX_HEADER_LEN];
+
+static char * program = NULL;
+static char * command = NULL;
+static char * hosts = NULL;
+static char library[MPI_MAX_LIBRARY_VERSION_STRING];
+static char start_time[32];
+static int num_ranks = 0;
+
+static struct field fields[MAX_FIELDS];
+static int num_fields = 0;
+static int record_size = 0;
+
+/*
+ * Parses "FORMAT[:FILE]".  Returns 0 on success.
+ */
+int
+set_output (char const * spec)
+{
+    char const * colon = strchr(spec, ':');
+    size_t length = colon ? (size_t)(colon - spec) : strlen(spec);
+
+    if (4 == length && 0 == strncmp(spec, "json", length)) {
+        format = output_format_json;
+    }
+
+    else if (3 == length && 0 == strncmp(spec, "csv", length)) {
+        format = output_format_csv;
+    }
+
+    else if (4 == length && 0 == strncmp(spec, "text", length)) {
+        format = output_format_text;
+    }
+
+    else {
+        return 1;
+    }
+
+    free(filename);
+    filename = NULL;
+
+    if (colon) {
+        if ('\0' == colon[1] || output_format_text == format) {
+            return 1;
+        }
+
+        filename = strdup(colon + 1);
+    }
+
+    return 0;
+}
+
+/*
+ * Remembers the program name and the options it was started with.  Must be
+ * called before MPI_Init gets a chance to modify argv.
+ */
+void
+output_set_command (int argc, char * argv[])
+{
+    char const * name = strrchr(argv[0], '/');
+    size_t length = 1;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        length += strlen(argv[i]) + 1;
+    }
+
+    free(program);
+    free(command);
+    program = strdup(name ? name + 1 : argv[0]);
+    command = malloc(length);
+
+    if (NULL == command) {
+        return;
+    }
+
+    command[0] = '\0';
+
+    for (i = 1; i < argc; i++) {
+        if (i > 1) {
+            strcat(command, " ");
+        }
+
+        strcat(command, argv[i]);
+    }
+}
+
+/*
+ * Whether the text table should be printed to stdout.
+ */
+int
+output_text (void)
+{
+    return output_format_text == format || NULL != filename;
+}
+
+/*
+ * Gathers the host names of all ranks into a comma separated list without
+ * duplicates on rank 0.
+ */
+static void
+gather_hosts (MPI_Comm comm, int rank)
+{
+    char name[MPI_MAX_PROCESSOR_NAME];
+    char * names = NULL;
+    int length, i, j;
+
+    memset(name, 0, sizeof(name));
+    MPI_Get_processor_name(name, &length);
+
+    if (0 == rank) {
+        names = malloc((size_t)num_ranks * MPI_MAX_PROCESSOR_NAME);
+        hosts = calloc((size_t)num_ranks, MPI_MAX_PROCESSOR_NAME + 1);
+
+        if (NULL == names || NULL == hosts) {
+            fprintf(stderr, "Error allocating memory for host names\n");
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+    }
+
+    MPI_Gather(name, MPI_MAX_PROCESSOR_NAME, MPI_CHAR, names,
+            MPI_MAX_PROCESSOR_NAME, MPI_CHAR, 0, comm);
+
+    if (rank) {
+        return;
+    }
+
+    for (i = 0; i < num_ranks; i++) {
+        char const * host = names + (size_t)i * MPI_MAX_PROCESSOR_NAME;
+
+        for (j = 0; j < i; j++) {
+            if (0 == strncmp(host, names + (size_t)j * MPI_MAX_PROCESSOR_NAME,
+                        MPI_MAX_PROCESSOR_NAME)) {
+                break;
+            }
+        }
+
+        if (j == i) {
+            if (hosts[0]) {
+                strcat(hosts, ",");
+            }
+
+            strncat(hosts, host, MPI_MAX_PROCESSOR_NAME);
+        }
+    }
+
+    free(names);
+}
+
+/*
+ * Remembers the last CSV header line already in the file, so that records
+ * with the same columns can be appended below it.
+ */
+static void
+find_csv_header (void)
+{
+    char line[MAX_HEADER_LEN];
+    int line_start = 1;
+
+    csv_header[0] = '\0';
+    rewind(stream);
+
+    while (fgets(line, sizeof(line), stream)) {
+        if (line_start && 0 == strncmp(line, "benchmark,size,", 15)) {
+            snprintf(csv_header, sizeof(csv_header), "%s", line);
+        }
+
+        line_start = NULL != strchr(line, '\n');
+    }
+
+    fseek(stream, 0, SEEK_END);
+}
+
+/*
+ * Collects the run metadata and opens the output file.  Collective over comm.
+ */
+void
+output_init (MPI_Comm comm)
+{
+    time_t now = time(NULL);
+    int rank, length;
+    char * end;
+
+    if (output_format_text == format) {
+        return;
+    }
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &num_ranks);
+
+    gather_hosts(comm, rank);
+
+    if (rank) {
+        return;
+    }
+
+    MPI_Get_library_version(library, &length);
+
+    /* some libraries end the version string with a newline */
+    for (end = library + strlen(library); end > library
+            && strchr(" \t\r\n", end[-1]); end--) {
+        end[-1] = '\0';
+    }
+
+    strftime(start_time, sizeof(start_time), "%Y-%m-%dT%H:%M:%SZ",
+            gmtime(&now));
+
+    stream = stdout;
+
+    if (filename) {
+        stream = fopen(filename, "a+");
+
+        if (NULL == stream) {
+            fprintf(stderr, "Error opening output file `%s': %s\n", filename,
+                    strerror(errno));
+            MPI_Abort(comm, EXIT_FAILURE);
+        }
+
+        if (output_format_csv == format) {
+            find_csv_header();
+        }
+    }
+}
+
+void
+output_begin (int size)
+{
+    record_size = size;
+    num_fields = 0;
+}
+
+static void
+add_field (char const * name, char const * value)
+{
+    if (MAX_FIELDS == num_fields) {
+        return;
+    }
+
+    snprintf(fields[num_fields].name, MAX_NAME_LEN, "%s", name);
+    snprintf(fields[num_fields].value, MAX_VALUE_LEN, "%s", value);
+    num_fields++;
+}
+
+void
+output_double (char const * name, double value)
+{
+    char buffer[MAX_VALUE_LEN] = "";
+
+    /* neither JSON nor CSV can represent infinities and NaN */
+    if (isfinite(value)) {
+        snprintf(buffer, sizeof(buffer), "%.12g", value);
+    }
+
+    else if (output_format_json == format) {
+        snprintf(buffer, sizeof(buffer), "null");
+    }
+
+    add_field(name, buffer);
+}
+
+void
+output_int (char const * name, long value)
+{
+    char buffer[MAX_VALUE_LEN];
+
+    snprintf(buffer, sizeof(buffer), "%ld", value);
+    add_field(name, buffer);
+}
+
+/*
+ * Adds a string field, quoted for the record format.  Only meant for short
+ * names without control characters.
+ */
+void
+output_string (char const * name, char const * value)
+{
+    char buffer[MAX_VALUE_LEN];
+    size_t length = 0;
+
+    buffer[length++] = '"';
+
+    for (; *value && length < sizeof(buffer) - 3; value++) {
+        if ('"' == *value) {
+            buffer[length++] = output_format_json == format ? '\\' : '"';
+        }
+
+        buffer[length++] = *value;
+    }
+
+    buffer[length++] = '"';
+    buffer[length] = '\0';
+    add_field(name, buffer);
+}
+
+static void
+print_json_string (char const * string)
+{
+    fputc('"', stream);
+
+    for (; string && *string; string++) {
+        unsigned char c = *string;
+
+        if ('"' == c || '\\' == c) {
+            fprintf(stream, "\\%c", c);
+        }
+
+        else if ('\n' == c) {
+            fprintf(stream, "\\n");
+        }
+
+        else if (c < 0x20) {
+            fprintf(stream, "\\u%04x", c);
+        }
+
+        else {
+            fputc(c, stream);
+        }
+    }
+
+    fputc('"', stream);
+}
+
+static void
+print_csv_string (char const * string)
+{
+    fputc('"', stream);
+
+    for (; string && *string; string++) {
+        if ('"' == *string) {
+            fputc('"', stream);
+        }
+
+        fputc(*string, stream);
+    }
+
+    fputc('"', stream);
+}
+
+static void
+print_json_record (void)
+{
+    char const * host;
+    int i;
+
+    fprintf(stream, "{\"benchmark\":");
+    print_json_string(program);
+    fprintf(stream, ",\"size\":%d", record_size);
+
+    for (i = 0; i < num_fields; i++) {
+        fprintf(stream, ",\"%s\":%s", fields[i].name, fields[i].value);
+    }
+
+    fprintf(stream, ",\"ranks\":%d,\"hosts\":[", num_ranks);
+
+    for (host = hosts; host && *host; host += strcspn(host, ",")) {
+        if (',' == *host) {
+            fputc(',', stream);
+            host++;
+        }
+
+        fprintf(stream, "\"%.*s\"", (int)strcspn(host, ","), host);
+    }
+
+    fprintf(stream, "],\"library\":");
+    print_json_string(library);
+#ifdef PACKAGE_VERSION
+    fprintf(stream, ",\"version\":\"%s\"", PACKAGE_VERSION);
+#endif
+    fprintf(stream, ",\"start_time\":\"%s\",\"options\":", start_time);
+    print_json_string(command);
+    fprintf(stream, "}\n");
+}
+
+static void
+print_csv_record (void)
+{
+    char header[MAX_HEADER_LEN];
+    size_t length;
+    int i;
+
+    length = snprintf(header, sizeof(header), "benchmark,size");
+
+    for (i = 0; i < num_fields; i++) {
+        length += snprintf(header + length, sizeof(header) - length, ",%s",
+                fields[i].name);
+    }
+
+    snprintf(header + length, sizeof(header) - length,
+            ",ranks,hosts,library,version,start_time,options\n");
+
+    /* a new header starts a new table whenever the columns change */
+    if (strcmp(header, csv_header)) {
+        fputs(header, stream);
+        strcpy(csv_header, header);
+    }
+
+    print_csv_string(program);
+    fprintf(stream, ",%d", record_size);
+
+    for (i = 0; i < num_fields; i++) {
+        fprintf(stream, ",%s", fields[i].value);
+    }
+
+    fprintf(stream, ",%d,", num_ranks);
+    print_csv_string(hosts);
+    fputc(',', stream);
+    print_csv_string(library);
+#ifdef PACKAGE_VERSION
+    fprintf(stream, ",%s", PACKAGE_VERSION);
+#else
+    fputc(',', stream);
+#endif
+    fprintf(stream, ",%s,", start_time);
+    print_csv_string(command);
+    fputc('\n', stream);
+}
+
+/*
+ * Writes the record started by output_begin().  Only has an effect on the
+ * rank that called output_init() as rank 0.
+ */
+void
+output_end (void)
+{
+    if (NULL == stream) {
+        return;
+    }
+
+    switch (format) {
+        case output_format_json:
+            print_json_record();
+            break;
+        case output_format_csv:
+            print_csv_record();
+            break;
+        default:
+            break;
+    }
+
+    fflush(stream);
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#ifndef OSU_OUTPUT_H
+#define OSU_OUTPUT_H 1
+
+#include <mpi.h>
+
+/*
+ * Machine readable result records.
+ *
+ * Every message size produces one record holding the benchmark name, the
+ * message size, the statistics the benchmark reports and the metadata of the
+ * run: number of ranks, MPI library version, host names, start time and the
+ * command line options.  Records are written as JSON Lines or CSV, either to
+ * stdout in place of the text table or appended to a file next to it.  A CSV
+ * header line is written whenever the columns differ from the last header in
+ * the file, e.g. when several benchmarks append to the same file.
+ *
+ * Only rank 0 writes records, but output_init() has to be called by every
+ * rank of the communicator since it gathers the host names.
+ */
+#define OUTPUT_HELP_STRING \
+    "  -o FORMAT[:FILE]\n" \
+    "                write one record per message size with the run metadata\n" \
+    "                as FORMAT `json' (JSON Lines) or `csv', to stdout instead\n" \
+    "                of the text table, or appended to FILE in addition to it\n"
+
+int set_output (char const * spec);
+void output_set_command (int argc, char * argv[]);
+int output_text (void);
+void output_init (MPI_Comm comm);
+
+void output_begin (int size);
+void output_double (char const * name, double value);
+void output_int (char const * name, long value);
+void output_string (char const * name, char const * value);
+void output_end (void);
+
+#endif /* OSU_OUTPUT_H */
@@ -0,0 +1,560 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include "osu_pvars.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#ifndef FIELD_WIDTH
+#   define FIELD_WIDTH 20
+#endif
+
+#ifndef FLOAT_PRECISION
+#   define FLOAT_PRECISION 2
+#endif
+
+#define MAX_PVAR_NAME_LEN   256
+
+struct pvar {
+    char name[MAX_PVAR_NAME_LEN];
+    int index;
+    int bound;
+    int var_class;
+    int continuous;
+    int readonly;
+    int count;
+    MPI_Datatype datatype;
+    MPI_T_pvar_handle handle;
+    double begin;
+    double value;
+};
+
+static char * patterns = NULL;
+static struct pvar * pvars = NULL;
+static int num_pvars = 0;
+static MPI_T_pvar_session session;
+
+/*
+ * Remembers the comma separated list of name patterns, or "all".  A pattern
+ * starting with `^' excludes the variables it matches.  Returns 0 on
+ * success.
+ */
+int
+set_pvars (char const * spec)
+{
+    if ('\0' == spec[0] || ',' == spec[0]) {
+        return 1;
+    }
+
+    free(patterns);
+    patterns = strdup(spec);
+
+    return NULL == patterns;
+}
+
+int
+pvars_enabled (void)
+{
+    return NULL != patterns;
+}
+
+static int
+matches (char const * name)
+{
+    char const * p = patterns;
+    char pattern[MAX_PVAR_NAME_LEN];
+    size_t length;
+    int included = 0;
+
+    while (*p) {
+        length = strcspn(p, ",");
+
+        if (length < sizeof(pattern)) {
+            memcpy(pattern, p, length);
+            pattern[length] = '\0';
+
+            if ('^' == pattern[0]) {
+                if (pattern[1] && strstr(name, pattern + 1)) {
+                    return 0;
+                }
+            }
+
+            else if (0 == strcmp(pattern, "all") || (length
+                        && strstr(name, pattern))) {
+                included = 1;
+            }
+        }
+
+        p += length + (',' == p[length]);
+    }
+
+    return included;
+}
+
+/*
+ * FNV-1a over the names of the variables in order, folded to a positive
+ * int so that it can be compared across ranks with MPI_MAX.
+ */
+static int
+names_hash (void)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    char const * c;
+    int i;
+
+    for (i = 0; i < num_pvars; i++) {
+        for (c = pvars[i].name; ; c++) {
+            hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+
+            if ('\0' == *c) {
+                break;
+            }
+        }
+    }
+
+    return (int)((hash ^ (hash >> 31)) & 0x3fffffff);
+}
+
+static int
+supported_datatype (MPI_Datatype datatype)
+{
+    return MPI_UNSIGNED == datatype || MPI_UNSIGNED_LONG == datatype
+        || MPI_UNSIGNED_LONG_LONG == datatype || MPI_COUNT == datatype
+        || MPI_INT == datatype || MPI_DOUBLE == datatype;
+}
+
+static int
+additive (struct pvar const * pvar)
+{
+    return MPI_T_PVAR_CLASS_COUNTER == pvar->var_class
+        || MPI_T_PVAR_CLASS_AGGREGATE == pvar->var_class
+        || MPI_T_PVAR_CLASS_TIMER == pvar->var_class;
+}
+
+/*
+ * Looks up the variable with index i and keeps it if it matches one of the
+ * patterns.  Returns 1 if it was added to pvars.
+ */
+static int
+add_pvar (int i)
+{
+    struct pvar * pvar = &pvars[num_pvars];
+    char desc[1];
+    int name_len = MAX_PVAR_NAME_LEN, desc_len = 1;
+    int verbosity, bind, atomic, j;
+    MPI_T_enum enumtype;
+
+    if (MPI_SUCCESS != MPI_T_pvar_get_info(i, pvar->name, &name_len,
+                &verbosity, &pvar->var_class, &pvar->datatype, &enumtype, desc,
+                &desc_len, &bind, &pvar->readonly, &pvar->continuous,
+                &atomic)) {
+        return 0;
+    }
+
+    if (!matches(pvar->name) || !supported_datatype(pvar->datatype)) {
+        return 0;
+    }
+
+    if (MPI_T_BIND_MPI_COMM != bind && MPI_T_BIND_NO_OBJECT != bind) {
+        return 0;
+    }
+
+    /* some libraries register the same variable once per component */
+    for (j = 0; j < num_pvars; j++) {
+        if (0 == strcmp(pvars[j].name, pvar->name)) {
+            return 0;
+        }
+    }
+
+    pvar->index = i;
+    pvar->bound = MPI_T_BIND_MPI_COMM == bind;
+
+    return 1;
+}
+
+/*
+ * Allocates the handle of a variable.  Returns 0 on success.
+ */
+static int
+open_pvar (struct pvar * pvar, MPI_Comm comm)
+{
+    return MPI_SUCCESS != MPI_T_pvar_handle_alloc(session, pvar->index,
+            pvar->bound ? &comm : NULL, &pvar->handle, &pvar->count)
+        || pvar->count < 1;
+}
+
+/*
+ * Allocates, starts, reads and stops a variable once.  Returns 0 if all of
+ * that succeeded.
+ */
+static int
+test_pvar (struct pvar * pvar, MPI_Comm comm)
+{
+    char * buffer;
+    int size, retval;
+
+    if (open_pvar(pvar, comm)) {
+        return 1;
+    }
+
+    MPI_Type_size(pvar->datatype, &size);
+
+    if (NULL == (buffer = malloc((size_t)pvar->count * size))) {
+        return 1;
+    }
+
+    retval = (!pvar->continuous && MPI_SUCCESS
+            != MPI_T_pvar_start(session, pvar->handle))
+        || MPI_SUCCESS != MPI_T_pvar_read(session, pvar->handle, buffer)
+        || (!pvar->continuous && MPI_SUCCESS
+                != MPI_T_pvar_stop(session, pvar->handle));
+    free(buffer);
+
+    return retval;
+}
+
+/*
+ * Some libraries register variables of components they loaded but did not
+ * select, and crash when those are read, e.g. Open MPI 4.1 with the psm2 MTL
+ * under the ob1 PML.  MPI_T does not tell which components are in use, so
+ * every variable is tested once in a child process instead.  The child
+ * reports a byte per variable; if it dies, the variable it was testing is
+ * left out and a new child carries on after it.  The parent only waits
+ * meanwhile.  Sets safe[i] for the variables that passed.
+ */
+static void
+probe_pvars (char * safe, MPI_Comm comm)
+{
+    int signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+    int fds[2], first = 0, i, j, status;
+    char result;
+    ssize_t length;
+    pid_t pid;
+
+    while (first < num_pvars) {
+        if (pipe(fds)) {
+            return;
+        }
+
+        if (0 > (pid = fork())) {
+            close(fds[0]);
+            close(fds[1]);
+            return;
+        }
+
+        if (0 == pid) {
+            close(fds[0]);
+
+            /* die quietly instead of in the library's crash handler */
+            for (j = 0; j < (int)(sizeof(signals) / sizeof(int)); j++) {
+                signal(signals[j], SIG_DFL);
+            }
+
+            for (i = first; i < num_pvars; i++) {
+                result = 0 == test_pvar(&pvars[i], comm);
+
+                if (1 != write(fds[1], &result, 1)) {
+                    break;
+                }
+            }
+
+            _exit(EXIT_SUCCESS);
+        }
+
+        close(fds[1]);
+
+        for (i = first; i < num_pvars; i++) {
+            while (-1 == (length = read(fds[0], &result, 1))
+                    && EINTR == errno);
+
+            if (1 != length) {
+                break;
+            }
+
+            safe[i] = result;
+        }
+
+        close(fds[0]);
+        waitpid(pid, &status, 0);
+
+        /* skip the variable the child died on */
+        first = i + 1;
+    }
+}
+
+/*
+ * Allocates a handle for every matching performance variable.  Collective
+ * over comm.
+ */
+void
+pvars_init (MPI_Comm comm)
+{
+    int provided, num, i, j, rank, range[4];
+    char * safe;
+
+    if (!pvars_enabled() || NULL != pvars) {
+        return;
+    }
+
+    MPI_Comm_rank(comm, &rank);
+    MPI_Query_thread(&provided);
+
+    if (MPI_SUCCESS != MPI_T_init_thread(provided, &provided)
+            || MPI_SUCCESS != MPI_T_pvar_get_num(&num)
+            || MPI_SUCCESS != MPI_T_pvar_session_create(&session)) {
+        num = 0;
+    }
+
+    pvars = calloc(num ? num : 1, sizeof(struct pvar));
+
+    for (i = 0; pvars && i < num; i++) {
+        num_pvars += add_pvar(i);
+    }
+
+    safe = calloc(num_pvars ? num_pvars : 1, 1);
+
+    if (NULL == safe) {
+        num_pvars = 0;
+    }
+
+    probe_pvars(safe, comm);
+
+    for (i = j = 0; i < num_pvars; i++) {
+        if (safe[i] && 0 == open_pvar(&pvars[i], comm)) {
+            pvars[j++] = pvars[i];
+        }
+    }
+
+    num_pvars = j;
+    free(safe);
+
+    /* all ranks have to report the same variables in the same order */
+    range[0] = -num_pvars;
+    range[1] = num_pvars;
+    range[2] = -names_hash();
+    range[3] = -range[2];
+    MPI_Allreduce(MPI_IN_PLACE, range, 4, MPI_INT, MPI_MAX, comm);
+
+    if (-range[0] != range[1] || -range[2] != range[3]) {
+        if (0 == rank) {
+            fprintf(stderr, "MPI_T performance variables differ between "
+                    "ranks, not sampling them\n");
+        }
+
+        num_pvars = 0;
+    }
+
+    else if (0 == num_pvars && 0 == rank) {
+        fprintf(stderr, "No supported MPI_T performance variable matches "
+                "`%s'\n", patterns);
+    }
+}
+
+static double
+read_pvar (struct pvar * pvar)
+{
+    double value = 0.0;
+    char * buffer;
+    int size, i;
+
+    MPI_Type_size(pvar->datatype, &size);
+    buffer = malloc((size_t)pvar->count * size);
+
+    if (NULL == buffer) {
+        return value;
+    }
+
+    if (MPI_SUCCESS == MPI_T_pvar_read(session, pvar->handle, buffer)) {
+        for (i = 0; i < pvar->count; i++) {
+            void * element = buffer + (size_t)i * size;
+
+            if (MPI_UNSIGNED == pvar->datatype) {
+                value += *(unsigned *)element;
+            }
+
+            else if (MPI_UNSIGNED_LONG == pvar->datatype) {
+                value += *(unsigned long *)element;
+            }
+
+            else if (MPI_UNSIGNED_LONG_LONG == pvar->datatype) {
+                value += *(unsigned long long *)element;
+            }
+
+            else if (MPI_COUNT == pvar->datatype) {
+                value += *(MPI_Count *)element;
+            }
+
+            else if (MPI_INT == pvar->datatype) {
+                value += *(int *)element;
+            }
+
+            else {
+                value += *(double *)element;
+            }
+        }
+    }
+
+    free(buffer);
+
+    return value;
+}
+
+/*
+ * Starts the variables and records their values before the iterations of a
+ * message size.
+ */
+void
+pvars_begin (void)
+{
+    int i;
+
+    for (i = 0; i < num_pvars; i++) {
+        struct pvar * pvar = &pvars[i];
+
+        if (!pvar->continuous) {
+            MPI_T_pvar_start(session, pvar->handle);
+        }
+
+        if (!pvar->readonly && (MPI_T_PVAR_CLASS_HIGHWATERMARK
+                    == pvar->var_class || MPI_T_PVAR_CLASS_LOWWATERMARK
+                    == pvar->var_class)) {
+            MPI_T_pvar_reset(session, pvar->handle);
+        }
+
+        pvar->begin = additive(pvar) ? read_pvar(pvar) : 0.0;
+    }
+}
+
+/*
+ * Stops the variables and combines the values of all ranks on rank 0.
+ * Collective over comm.
+ */
+void
+pvars_end (MPI_Comm comm)
+{
+    double * sum, * max;
+    int rank, i;
+
+    if (!num_pvars) {
+        return;
+    }
+
+    MPI_Comm_rank(comm, &rank);
+    sum = calloc(2 * num_pvars, sizeof(double));
+
+    if (NULL == sum) {
+        fprintf(stderr, "Error allocating memory for MPI_T values\n");
+        MPI_Abort(comm, EXIT_FAILURE);
+    }
+
+    max = sum + num_pvars;
+
+    for (i = 0; i < num_pvars; i++) {
+        struct pvar * pvar = &pvars[i];
+        double value = read_pvar(pvar);
+
+        if (!pvar->continuous) {
+            MPI_T_pvar_stop(session, pvar->handle);
+        }
+
+        if (additive(pvar)) {
+            sum[i] = value - pvar->begin;
+        }
+
+        /* the minimum is the negated maximum of the negated values */
+        else if (MPI_T_PVAR_CLASS_LOWWATERMARK == pvar->var_class) {
+            max[i] = -value;
+        }
+
+        else {
+            max[i] = value;
+        }
+    }
+
+    MPI_Reduce(0 == rank ? MPI_IN_PLACE : sum, sum, num_pvars, MPI_DOUBLE,
+            MPI_SUM, 0, comm);
+    MPI_Reduce(0 == rank ? MPI_IN_PLACE : max, max, num_pvars, MPI_DOUBLE,
+            MPI_MAX, 0, comm);
+
+    for (i = 0; i < num_pvars; i++) {
+        struct pvar * pvar = &pvars[i];
+
+        if (additive(pvar)) {
+            pvar->value = sum[i];
+        }
+
+        else if (MPI_T_PVAR_CLASS_LOWWATERMARK == pvar->var_class) {
+            pvar->value = -max[i];
+        }
+
+        else {
+            pvar->value = max[i];
+        }
+    }
+
+    free(sum);
+}
+
+int
+pvars_count (void)
+{
+    return num_pvars;
+}
+
+char const *
+pvars_name (int i)
+{
+    return pvars[i].name;
+}
+
+double
+pvars_value (int i)
+{
+    return pvars[i].value;
+}
+
+static int
+column_width (int i)
+{
+    int width = strlen(pvars[i].name) + 2;
+
+    return width > FIELD_WIDTH ? width : FIELD_WIDTH;
+}
+
+/*
+ * Prints one column header per variable, wide enough for its name.
+ */
+void
+pvars_print_labels (FILE * stream)
+{
+    int i;
+
+    for (i = 0; i < num_pvars; i++) {
+        fprintf(stream, "%*s", column_width(i), pvars[i].name);
+    }
+}
+
+void
+pvars_print_values (FILE * stream)
+{
+    int i;
+
+    for (i = 0; i < num_pvars; i++) {
+        fprintf(stream, "%*.*f", column_width(i), FLOAT_PRECISION,
+                pvars[i].value);
+    }
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
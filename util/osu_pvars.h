@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#ifndef OSU_PVARS_H
+#define OSU_PVARS_H 1
+
+#include <stdio.h>
+#include <mpi.h>
+
+/*
+ * MPI_T performance variables sampled around every message size.
+ *
+ * The variables whose names contain one of the requested patterns are
+ * allocated in one MPI_T session.  pvars_begin() starts them and records
+ * their values before the iterations of a message size, pvars_end() stops
+ * them and combines the values of all ranks on rank 0: counters, aggregates
+ * and timers as the sum of the changes, low watermarks as the minimum and all
+ * other classes (levels, sizes, high watermarks, ...) as the maximum of the
+ * final value.
+ *
+ * Only variables that are not bound to an object or bound to a communicator
+ * are supported, the latter are bound to the communicator given to
+ * pvars_init().  Each variable is read once in a child process first and
+ * left out if that fails or crashes.
+ */
+#define PVARS_HELP_STRING \
+    "  -T PVARS      sample the MPI_T performance variables whose names contain\n" \
+    "                one of the comma separated PVARS, or `all', around every\n" \
+    "                message size and report their changes next to the timing;\n" \
+    "                `^NAME' leaves out the variables whose names contain NAME\n"
+
+int set_pvars (char const * spec);
+int pvars_enabled (void);
+void pvars_init (MPI_Comm comm);
+
+void pvars_begin (void);
+void pvars_end (MPI_Comm comm);
+
+int pvars_count (void);
+char const * pvars_name (int i);
+double pvars_value (int i);
+
+void pvars_print_labels (FILE * stream);
+void pvars_print_values (FILE * stream);
+
+#endif /* OSU_PVARS_H */
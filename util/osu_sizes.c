@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#include "osu_sizes.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_SIZES       65536
+#define MAX_LINE_LEN    1024
+
+struct size {
+    size_t size;
+    double weight;
+};
+
+static struct size * sizes = NULL;
+static int num_sizes = 0;
+static int max_sizes = 0;
+
+static int
+add_size (size_t size, double weight)
+{
+    struct size * list = sizes;
+
+    if (num_sizes == MAX_SIZES) {
+        return 1;
+    }
+
+    if (num_sizes == max_sizes) {
+        max_sizes = max_sizes ? 2 * max_sizes : 64;
+        list = (struct size *)realloc(sizes, max_sizes * sizeof(struct size));
+
+        if (NULL == list) {
+            return 1;
+        }
+
+        sizes = list;
+    }
+
+    sizes[num_sizes].size = size;
+    sizes[num_sizes++].weight = weight;
+
+    return 0;
+}
+
+/*
+ * Parses a size with an optional k, m or g suffix and stores the position
+ * after it in end.  Returns 0 on success.
+ */
+static int
+parse_size (char const * str, char const ** end, size_t * size)
+{
+    unsigned long long value, scale = 1;
+    char * p;
+
+    if (!isdigit((unsigned char)str[0])) {
+        return 1;
+    }
+
+    errno = 0;
+    value = strtoull(str, &p, 10);
+
+    switch (tolower((unsigned char)*p)) {
+        case 'g':
+            scale <<= 10;
+            /* fall through */
+        case 'm':
+            scale <<= 10;
+            /* fall through */
+        case 'k':
+            scale <<= 10;
+            p++;
+            break;
+    }
+
+    if (errno || value > INT_MAX / scale) {
+        return 1;
+    }
+
+    *size = value * scale;
+    *end = p;
+
+    return 0;
+}
+
+/*
+ * Parses a single size with an optional k, m or g suffix and nothing after
+ * it, for options that take sizes.  Returns 0 on success.
+ */
+int
+sizes_parse (char const * str, size_t * size)
+{
+    char const * end;
+
+    return parse_size(str, &end, size) || '\0' != *end;
+}
+
+static int
+compare_sizes (void const * a, void const * b)
+{
+    struct size const * x = (struct size const *)a;
+    struct size const * y = (struct size const *)b;
+
+    return (x->size > y->size) - (x->size < y->size);
+}
+
+static int
+compare_weights (void const * a, void const * b)
+{
+    struct size const * x = (struct size const *)a;
+    struct size const * y = (struct size const *)b;
+
+    return (x->weight < y->weight) - (x->weight > y->weight);
+}
+
+/*
+ * Sorts the sizes from first on and adds up the weights of equal ones.
+ */
+static void
+merge_sizes (int first)
+{
+    int i, j = first;
+
+    qsort(sizes + first, num_sizes - first, sizeof(struct size),
+            compare_sizes);
+
+    for (i = first + 1; i < num_sizes; i++) {
+        if (sizes[i].size == sizes[j].size) {
+            sizes[j].weight += sizes[i].weight;
+        }
+
+        else {
+            sizes[++j] = sizes[i];
+        }
+    }
+
+    if (num_sizes > first) {
+        num_sizes = j + 1;
+    }
+}
+
+/*
+ * Reads the sizes and optional weights in the first two columns of a file,
+ * skipping empty lines and `#' comments, and keeps the keep sizes with the
+ * largest weight if keep is positive.
+ */
+static int
+read_sizes (char const * filename, int keep)
+{
+    char line[MAX_LINE_LEN], * p;
+    char const * end;
+    int first = num_sizes;
+    double weight;
+    size_t size;
+    FILE * file;
+
+    if (NULL == (file = fopen(filename, "r"))) {
+        fprintf(stderr, "Could not open size file `%s'\n", filename);
+        return 1;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        for (p = line; isspace((unsigned char)*p); p++);
+
+        if ('\0' == *p || '#' == *p) {
+            continue;
+        }
+
+        if (parse_size(p, &end, &size) || (*end
+                    && !isspace((unsigned char)*end))) {
+            fprintf(stderr, "Invalid size in `%s': %s", filename, line);
+            fclose(file);
+            return 1;
+        }
+
+        weight = strtod(end, &p);
+
+        if (add_size(size, p == end ? 1.0 : weight)) {
+            fclose(file);
+            return 1;
+        }
+    }
+
+    fclose(file);
+    merge_sizes(first);
+
+    if (keep > 0 && num_sizes - first > keep) {
+        qsort(sizes + first, num_sizes - first, sizeof(struct size),
+                compare_weights);
+        num_sizes = first + keep;
+    }
+
+    return 0;
+}
+
+/*
+ * Adds the sizes of a range A:B, A:B:xF or A:B:+S.
+ */
+static int
+add_range (size_t from, size_t to, char type, double step)
+{
+    size_t size = from, next;
+
+    while (size <= to) {
+        if (add_size(size, 1.0)) {
+            return 1;
+        }
+
+        if ('+' == type) {
+            next = size + (size_t)step;
+        }
+
+        else {
+            next = size ? (size_t)(size * step + 0.5) : 1;
+        }
+
+        /* small sizes might not grow by rounding alone */
+        size = next > size ? next : size + 1;
+    }
+
+    return 0;
+}
+
+static int
+parse_item (char * item)
+{
+    char const * p = item;
+    size_t from, to, step = 0;
+    double factor = 2.0;
+    char * end, * rest;
+    long keep = 0;
+
+    /* a trailing :N keeps the N heaviest sizes of the file */
+    if ('@' == item[0]) {
+        if ((end = strrchr(item, ':')) && end[1]) {
+            keep = strtol(end + 1, &rest, 10);
+
+            if ('\0' == *rest && keep > 0) {
+                *end = '\0';
+            }
+
+            else {
+                keep = 0;
+            }
+        }
+
+        return '\0' == item[1] || read_sizes(item + 1, keep);
+    }
+
+    if (parse_size(p, &p, &from)) {
+        return 1;
+    }
+
+    if ('\0' == *p) {
+        return add_size(from, 1.0);
+    }
+
+    if (':' != *p++ || parse_size(p, &p, &to) || to < from) {
+        return 1;
+    }
+
+    if ('\0' == *p) {
+        return add_range(from, to, 'x', factor);
+    }
+
+    if (':' != *p++) {
+        return 1;
+    }
+
+    if ('x' == *p) {
+        factor = strtod(p + 1, &end);
+
+        if (end == p + 1 || '\0' != *end || !(factor > 1.0)) {
+            return 1;
+        }
+
+        return add_range(from, to, 'x', factor);
+    }
+
+    if ('+' == *p) {
+        if (parse_size(p + 1, &p, &step) || '\0' != *p || 0 == step) {
+            return 1;
+        }
+
+        return add_range(from, to, '+', step);
+    }
+
+    return 1;
+}
+
+/*
+ * Parses the comma separated size specification.  Returns 0 on success.
+ */
+int
+set_sizes (char const * spec)
+{
+    char * copy = (char *)malloc(strlen(spec) + 1), * item, * next;
+    int retval = 0;
+
+    if (NULL == copy) {
+        return 1;
+    }
+
+    strcpy(copy, spec);
+    num_sizes = 0;
+
+    for (item = copy; item && 0 == retval; item = next) {
+        if ((next = strchr(item, ','))) {
+            *next++ = '\0';
+        }
+
+        retval = parse_item(item);
+    }
+
+    free(copy);
+
+    if (retval || 0 == num_sizes) {
+        num_sizes = 0;
+        return 1;
+    }
+
+    merge_sizes(0);
+
+    return 0;
+}
+
+int
+sizes_enabled (void)
+{
+    return num_sizes > 0;
+}
+
+/*
+ * Returns the largest listed size, or max without a list.
+ */
+size_t
+sizes_max (size_t max)
+{
+    return num_sizes ? sizes[num_sizes - 1].size : max;
+}
+
+/*
+ * Returns the number of listed sizes above max.
+ */
+int
+sizes_skipped (size_t max)
+{
+    int i, skipped = 0;
+
+    for (i = 0; i < num_sizes; i++) {
+        skipped += sizes[i].size > max;
+    }
+
+    return skipped;
+}
+
+size_t
+first_size (size_t min, size_t max)
+{
+    int i;
+
+    if (!num_sizes) {
+        return min;
+    }
+
+    for (i = 0; i < num_sizes && sizes[i].size < min; i++);
+
+    return i < num_sizes && sizes[i].size <= max ? sizes[i].size : max + 1;
+}
+
+size_t
+next_size (size_t size, size_t max)
+{
+    int i;
+
+    if (!num_sizes) {
+        return size ? size * 2 : 1;
+    }
+
+    for (i = 0; i < num_sizes && sizes[i].size <= size; i++);
+
+    return i < num_sizes && sizes[i].size <= max ? sizes[i].size : max + 1;
+}
+
+/* vi: set sw=4 sts=4 tw=80: */
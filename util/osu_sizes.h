@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2002-2016 the Network-Based Computing Laboratory
+ * (NBCL), The Ohio State University.
+ *
+ * Contact: Dr. D. K. Panda (panda@cse.ohio-state.edu)
+ *
+ * For detailed copyright and licensing information, please refer to the
+ * copyright file COPYRIGHT in the top level OMB directory.
+ */
+#ifndef OSU_SIZES_H
+#define OSU_SIZES_H 1
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Message sizes to run.
+ *
+ * The benchmarks step through their message sizes with
+ *
+ *   for (size = first_size(MIN, MAX); size <= MAX;
+ *           size = next_size(size, MAX))
+ *
+ * which doubles the size from MIN (0 is followed by 1) unless set_sizes()
+ * was given a list of sizes.  Then the loop runs the listed sizes from MIN
+ * up to MAX, in increasing order and each size once; sizes above the
+ * largest buffer of the benchmark are skipped, see sizes_skipped().  Tests
+ * that count elements instead of bytes use first_count() and next_count(),
+ * which round the sizes up to whole elements.
+ */
+#define SIZES_HELP_STRING \
+    "  -S SIZES      run the message sizes in SIZES instead of the powers of two,\n" \
+    "                a comma separated list of\n" \
+    "                  N          the size N\n" \
+    "                  A:B        the powers of two times A from A to B\n" \
+    "                  A:B:xF     from A to B, growing by the factor F, e.g. x1.25\n" \
+    "                  A:B:+S     from A to B in steps of S\n" \
+    "                  @FILE[:N]  the sizes in the first column of FILE, or the N\n" \
+    "                             with the largest weights in the second column\n" \
+    "                sizes take the suffixes k, m and g, e.g. 0,1k:64k:x1.5,1m\n"
+
+int set_sizes (char const * spec);
+int sizes_parse (char const * str, size_t * size);
+int sizes_enabled (void);
+size_t sizes_max (size_t max);
+int sizes_skipped (size_t max);
+
+size_t first_size (size_t min, size_t max);
+size_t next_size (size_t size, size_t max);
+
+#define first_count(min, max, unit) \
+    ((first_size((min) * (unit), (max)) + (unit) - 1) / (unit))
+#define next_count(count, max, unit) \
+    ((next_size((count) * (unit), (max)) + (unit) - 1) / (unit))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSU_SIZES_H */